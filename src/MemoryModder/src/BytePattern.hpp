@@ -0,0 +1,269 @@
+#pragma once
+
+#include <bit>
+#include <cstring>
+#include <vector>
+
+#include "Types.hpp"
+#include "Platform.hpp"
+#include "Compare.hpp"
+#include "CompareKernels.hpp"
+
+/// <summary>
+/// <para>Writes one bit per position to masks, bit i of masks[i / 64] is set if data[i + firstOffset] is first and data[i + secondOffset] is second.</para>
+/// <para>data holds count + max(firstOffset, secondOffset) bytes.</para>
+/// </summary>
+using AnchorKernel = void (*)(UInt8 const* data, SizeT count, UInt8 first, SizeT firstOffset, UInt8 second, SizeT secondOffset, UInt64* masks);
+
+inline void FindAnchorsScalar(UInt8 const* data, SizeT const count, UInt8 const first, SizeT const firstOffset, UInt8 const second, SizeT const secondOffset, UInt64* masks) {
+    memset(masks, 0, ((count + 63) / 64) * sizeof(UInt64));
+    for(SizeT i = 0; i < count; ++i) {
+        if((data[i + firstOffset] == first) && (data[i + secondOffset] == second)) {
+            masks[i / 64] |= static_cast<UInt64>(1) << (i % 64);
+        }
+    }
+}
+
+#if defined(MEMORYMODDER_X86)
+
+/// <summary>Anchor kernels built on the instruction set structs of the compare kernels.</summary>
+#define MEMORYMODDER_DEFINE_ANCHOR_KERNELS(Isa, features)                                                                    \
+MEMORYMODDER_TARGET(features) inline void FindAnchors##Isa(UInt8 const* data, SizeT const count, UInt8 const first, SizeT const firstOffset, UInt8 const second, SizeT const secondOffset, UInt64* masks) { \
+    constexpr SizeT width = Isa::Width;                                                                                    \
+    typename Isa::Vector const firstVector = Isa::template Broadcast<UInt8>(first);                                        \
+    typename Isa::Vector const secondVector = Isa::template Broadcast<UInt8>(second);                                      \
+    memset(masks, 0, ((count + 63) / 64) * sizeof(UInt64));                                                                \
+    SizeT i = 0;                                                                                                           \
+    for(; (i + width) <= count; i += width) {                                                                              \
+        UInt64 mask = Isa::template CompareLanes<UInt8, MemoryComparison::Equals>(data + i + firstOffset, firstVector);     \
+        if(mask != 0) {                                                                                                    \
+            mask &= Isa::template CompareLanes<UInt8, MemoryComparison::Equals>(data + i + secondOffset, secondVector);    \
+        }                                                                                                                  \
+        masks[i / 64] |= mask << (i % 64);                                                                                 \
+    }                                                                                                                      \
+    for(; i < count; ++i) {                                                                                                \
+        if((data[i + firstOffset] == first) && (data[i + secondOffset] == second)) {                                       \
+            masks[i / 64] |= static_cast<UInt64>(1) << (i % 64);                                                          \
+        }                                                                                                                  \
+    }                                                                                                                      \
+}
+
+MEMORYMODDER_DEFINE_ANCHOR_KERNELS(Sse2, "sse2")
+MEMORYMODDER_DEFINE_ANCHOR_KERNELS(Avx2, "avx2")
+MEMORYMODDER_DEFINE_ANCHOR_KERNELS(Avx512, "avx512f,avx512bw,bmi2")
+
+#endif
+
+/// <returns>The anchor kernel for the best instruction set of this CPU, or null if there is no vector kernel.</returns>
+inline AnchorKernel GetAnchorKernel(InstructionSet const instructionSet = GetInstructionSet()) {
+#if defined(MEMORYMODDER_X86)
+    switch(instructionSet) {
+    case InstructionSet::Avx512: return &FindAnchorsAvx512;
+    case InstructionSet::Avx2: return &FindAnchorsAvx2;
+    case InstructionSet::Sse2: return &FindAnchorsSse2;
+    default: break;
+    }
+#endif
+
+    return nullptr;
+}
+
+/// <summary>
+/// <para>An array of bytes to search for, e.g. "48 8B ?? ?? 00 00 89". Every nibble can be a wildcard, e.g. "4? ?B".</para>
+/// <para>Patterns with two known bytes are found with a vector prefilter on the two rarest known bytes, other patterns with Boyer-Moore-Horspool.</para>
+/// </summary>
+struct BytePattern {
+public:
+    /// <summary>
+    /// <para>Parses a pattern of hexadecimal bytes separated by spaces, ? is a wildcard nibble and a single ? a wildcard byte.</para>
+    /// <para>Possible exceptions:</para>
+    /// <para>(Int8)1: The pattern is invalid or has no known nibble.</para>
+    /// </summary>
+    BytePattern(String const& pattern) {
+        String token = String();
+        for(SizeT i = 0, s = pattern.length(); i <= s; ++i) {
+            char const c = (i < s) ? pattern[i] : ' ';
+            if((c != ' ') && (c != '\t')) {
+                token += c;
+                continue;
+            }
+            if(token.empty()) {
+                continue;
+            }
+
+            if(token == "?") {
+                token = "??";
+            }
+            if(token.length() != 2) {
+                throw (Int8)1;
+            }
+
+            UInt8 byte = 0;
+            UInt8 mask = 0;
+            for(char const nibble : token) {
+                byte <<= 4;
+                mask <<= 4;
+                if(nibble != '?') {
+                    byte |= ParseNibble(nibble);
+                    mask |= 0xF;
+                }
+            }
+
+            _bytes.push_back(byte);
+            _masks.push_back(mask);
+            token.clear();
+        }
+
+        Boolean known = false;
+        for(UInt8 const mask : _masks) {
+            known = known || (mask != 0);
+        }
+        if(!known) {
+            throw (Int8)1;
+        }
+
+        // Leading and trailing wildcard bytes never reject a match but cost a longer tail, so only the bytes between are searched
+        while(_masks.back() == 0) {
+            _masks.pop_back();
+            _bytes.pop_back();
+        }
+        while(_masks[_offset] == 0) {
+            ++_offset;
+        }
+        _bytes.erase(_bytes.begin(), _bytes.begin() + _offset);
+        _masks.erase(_masks.begin(), _masks.begin() + _offset);
+
+        ChooseAnchors();
+        BuildSkipTable();
+    }
+
+    /// <returns>The number of bytes in the pattern that are compared, without leading and trailing wildcards.</returns>
+    inline SizeT GetSize() const noexcept {
+        return _bytes.size();
+    }
+
+    /// <returns>The number of leading wildcard bytes, matches are reported this many bytes before the first compared byte.</returns>
+    inline SizeT GetOffset() const noexcept {
+        return _offset;
+    }
+
+    /// <returns>True if the pattern matches the GetSize bytes at data.</returns>
+    inline Boolean Matches(UInt8 const* data) const noexcept {
+        for(SizeT i = 0, s = _bytes.size(); i < s; ++i) {
+            if((data[i] & _masks[i]) != _bytes[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// <summary>
+    /// <para>Calls match(position) for every position below count where the pattern matches, in ascending order.</para>
+    /// <para>data holds count + GetSize() - 1 bytes, so matches near the end are whole. Positions count from the first compared byte, see GetOffset.</para>
+    /// </summary>
+    template<typename Match>
+    void Find(UInt8 const* data, SizeT const count, Match&& match) const {
+        static AnchorKernel const kernel = GetAnchorKernel();
+
+        if((kernel == nullptr) || !_hasAnchors) {
+            FindHorspool(data, count, match);
+            return;
+        }
+
+        // Small batches keep the masks on the stack and the candidates in cache for verifying
+        constexpr SizeT batchSize = 4096;
+        UInt64 masks[batchSize / 64];
+
+        for(SizeT batch = 0; batch < count; batch += batchSize) {
+            SizeT const batchCount = min(batchSize, count - batch);
+            kernel(data + batch, batchCount, _bytes[_firstAnchor], _firstAnchor, _bytes[_secondAnchor], _secondAnchor, masks);
+
+            for(SizeT word = 0, words = (batchCount + 63) / 64; word < words; ++word) {
+                for(UInt64 mask = masks[word]; mask != 0; mask &= (mask - 1)) {
+                    SizeT const position = batch + (word * 64) + static_cast<SizeT>(std::countr_zero(mask));
+                    if(Matches(data + position)) {
+                        match(position);
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    static inline UInt8 ParseNibble(char const nibble) {
+        if((nibble >= '0') && (nibble <= '9')) { return static_cast<UInt8>(nibble - '0'); }
+        if((nibble >= 'a') && (nibble <= 'f')) { return static_cast<UInt8>(nibble - 'a' + 10); }
+        if((nibble >= 'A') && (nibble <= 'F')) { return static_cast<UInt8>(nibble - 'A' + 10); }
+        throw (Int8)1;
+    }
+
+    /// <returns>How often a byte shows up in code and data compared with others, lower is rarer.</returns>
+    static inline SizeT GetByteRank(UInt8 const byte) {
+        switch(byte) {
+        case 0x00: return 4;
+        case 0xFF: case 0xCC: return 3;
+        case 0x48: case 0x8B: case 0x89: case 0x90: case 0x01: return 2;
+        case 0x0F: case 0x4C: case 0x8D: case 0xE8: case 0x24: case 0x83: case 0x44: return 1;
+        default: return 0;
+        }
+    }
+
+    void ChooseAnchors() {
+        SizeT first = _bytes.size();
+        SizeT second = _bytes.size();
+
+        for(SizeT i = 0; i < _bytes.size(); ++i) {
+            if(_masks[i] != 0xFF) {
+                continue;
+            }
+
+            if((first == _bytes.size()) || (GetByteRank(_bytes[i]) < GetByteRank(_bytes[first]))) {
+                second = first;
+                first = i;
+            }
+            else if((second == _bytes.size()) || (GetByteRank(_bytes[i]) < GetByteRank(_bytes[second]))) {
+                second = i;
+            }
+        }
+
+        // A single known byte is used as both anchors
+        _hasAnchors = first != _bytes.size();
+        _firstAnchor = first;
+        _secondAnchor = (second != _bytes.size()) ? second : first;
+    }
+
+    void BuildSkipTable() {
+        SizeT const size = _bytes.size();
+        for(SizeT byte = 0; byte < 0x100; ++byte) {
+            _skips[byte] = size;
+        }
+
+        // Shift so the last position that can match a byte lines up with it, wildcards can match every byte
+        for(SizeT i = 0; (i + 1) < size; ++i) {
+            for(SizeT byte = 0; byte < 0x100; ++byte) {
+                if((static_cast<UInt8>(byte) & _masks[i]) == _bytes[i]) {
+                    _skips[byte] = size - 1 - i;
+                }
+            }
+        }
+    }
+
+    template<typename Match>
+    void FindHorspool(UInt8 const* data, SizeT const count, Match& match) const {
+        SizeT const last = _bytes.size() - 1;
+        for(SizeT position = 0; position < count; position += _skips[data[position + last]]) {
+            if(Matches(data + position)) {
+                match(position);
+            }
+        }
+    }
+
+    std::vector<UInt8> _bytes = std::vector<UInt8>();
+    std::vector<UInt8> _masks = std::vector<UInt8>();
+    SizeT _offset = 0;
+
+    Boolean _hasAnchors = false;
+    SizeT _firstAnchor = 0;
+    SizeT _secondAnchor = 0;
+    SizeT _skips[0x100];
+};
@@ -0,0 +1,286 @@
+#pragma once
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#include "Types.hpp"
+
+enum struct MemoryComparison : Int8 {
+    Equals = 0,
+    NotEquals = 1,
+    LessThan = 2,
+    GreaterThan = 3,
+    LessThanEquals = 4,
+    GreaterThanEquals = 5
+};
+
+// Floats are equal within 0.001 of each other, the other comparisons only hold outside of that, so exactly one of less, equal and greater holds
+template<typename T>
+inline Boolean Equals(T const a, T const b) {
+    return (a == b);
+}
+
+template<>
+inline Boolean Equals<Float32>(Float32 const a, Float32 const b) {
+    return ((a >= (b - 0.001F)) && (a <= (b + 0.001F)));
+}
+
+template<>
+inline Boolean Equals<Float64>(Float64 const a, Float64 const b) {
+    return ((a >= (b - 0.001)) && (a <= (b + 0.001)));
+}
+
+template<typename T>
+inline Boolean NotEquals(T const a, T const b) {
+    return (a != b);
+}
+
+template<>
+inline Boolean NotEquals<Float32>(Float32 const a, Float32 const b) {
+    return ((a < (b - 0.001F)) || (a > (b + 0.001F)));
+}
+
+template<>
+inline Boolean NotEquals<Float64>(Float64 const a, Float64 const b) {
+    return ((a < (b - 0.001)) || (a > (b + 0.001)));
+}
+
+template<typename T>
+inline Boolean LessThan(T const a, T const b) {
+    return (a < b);
+}
+
+template<>
+inline Boolean LessThan<Float32>(Float32 const a, Float32 const b) {
+    return (a < (b - 0.001F));
+}
+
+template<>
+inline Boolean LessThan<Float64>(Float64 const a, Float64 const b) {
+    return (a < (b - 0.001));
+}
+
+template<typename T>
+inline Boolean GreaterThan(T const a, T const b) {
+    return (a > b);
+}
+
+template<>
+inline Boolean GreaterThan<Float32>(Float32 const a, Float32 const b) {
+    return (a > (b + 0.001F));
+}
+
+template<>
+inline Boolean GreaterThan<Float64>(Float64 const a, Float64 const b) {
+    return (a > (b + 0.001));
+}
+
+template<typename T>
+inline Boolean LessThanEquals(T const a, T const b) {
+    return (a <= b);
+}
+
+template<>
+inline Boolean LessThanEquals<Float32>(Float32 const a, Float32 const b) {
+    return (a <= (b + 0.001F));
+}
+
+template<>
+inline Boolean LessThanEquals<Float64>(Float64 const a, Float64 const b) {
+    return (a <= (b + 0.001));
+}
+
+template<typename T>
+inline Boolean GreaterThanEquals(T const a, T const b) {
+    return (a >= b);
+}
+
+template<>
+inline Boolean GreaterThanEquals<Float32>(Float32 const a, Float32 const b) {
+    return (a >= (b - 0.001F));
+}
+
+template<>
+inline Boolean GreaterThanEquals<Float64>(Float64 const a, Float64 const b) {
+    return (a >= (b - 0.001));
+}
+
+// Newer non-switch template specialized comparison method
+template<typename T, MemoryComparison comparison>
+inline Boolean Compare(T const a, T const b) {
+    if constexpr(comparison == MemoryComparison::Equals) { return Equals<T>(a, b); }
+    else if constexpr(comparison == MemoryComparison::NotEquals) { return NotEquals<T>(a, b); }
+    else if constexpr(comparison == MemoryComparison::LessThan) { return LessThan<T>(a, b); }
+    else if constexpr(comparison == MemoryComparison::GreaterThan) { return GreaterThan<T>(a, b); }
+    else if constexpr(comparison == MemoryComparison::LessThanEquals) { return LessThanEquals<T>(a, b); }
+    else if constexpr(comparison == MemoryComparison::GreaterThanEquals) { return GreaterThanEquals<T>(a, b); }
+    return false;
+}
+
+// Traditional method
+template<typename T>
+inline Boolean Compare(T const a, T const b, MemoryComparison const comparison) {
+    switch(comparison) {
+    case MemoryComparison::Equals: return Compare<T, MemoryComparison::Equals>(a, b);
+    case MemoryComparison::NotEquals: return Compare<T, MemoryComparison::NotEquals>(a, b);
+    case MemoryComparison::LessThan: return Compare<T, MemoryComparison::LessThan>(a, b);
+    case MemoryComparison::GreaterThan: return Compare<T, MemoryComparison::GreaterThan>(a, b);
+    case MemoryComparison::LessThanEquals: return Compare<T, MemoryComparison::LessThanEquals>(a, b);
+    case MemoryComparison::GreaterThanEquals: return Compare<T, MemoryComparison::GreaterThanEquals>(a, b);
+    default: return false;
+    }
+}
+
+/// <returns>A rank for the order comparisons are tested in, lower first. Equality rejects the most values and inequality the fewest.</returns>
+inline SizeT GetSelectivityRank(MemoryComparison const comparison) {
+    switch(comparison) {
+    case MemoryComparison::Equals: return 0;
+    case MemoryComparison::NotEquals: return 2;
+    default: return 1;
+    }
+}
+
+/// <summary>Compares a with a range of values that are all equal to each other, e.g. the floats within a tolerance of a filter, see FloatTolerance.</summary>
+template<typename T, MemoryComparison comparison>
+inline Boolean CompareRange(T const a, T const low, T const high) {
+    if constexpr(comparison == MemoryComparison::Equals) { return (a >= low) && (a <= high); }
+    else if constexpr(comparison == MemoryComparison::NotEquals) { return (a < low) || (a > high); }
+    else if constexpr(comparison == MemoryComparison::LessThan) { return (a < low); }
+    else if constexpr(comparison == MemoryComparison::GreaterThan) { return (a > high); }
+    else if constexpr(comparison == MemoryComparison::LessThanEquals) { return (a <= high); }
+    else if constexpr(comparison == MemoryComparison::GreaterThanEquals) { return (a >= low); }
+    return false;
+}
+
+/// <summary>How close a float has to be to a filter to be equal to it.</summary>
+enum struct FloatMode : Int8 {
+    // Within an absolute difference, e.g. 0.001
+    Absolute = 0,
+    // Within a difference relative to the filter, e.g. 0.0001 for 0.01%
+    Relative = 1,
+    // Within a number of representable floats, e.g. 4, so large values like world coordinates work as well as tiny ones
+    Ulps = 2,
+    // Equal after rounding to a number of decimals, e.g. 2 so 12.345 equals 12.35
+    Rounded = 3,
+    // Equal after cutting off everything past a number of decimals, e.g. 0 so 12.9 equals 12
+    Truncated = 4
+};
+
+/// <summary>
+/// <para>A float mode with its parameter, chosen per scan.</para>
+/// <para>Every mode turns a filter into the range of floats equal to it, so scans only compare with two bounds no matter which mode is used, see CompareRange.</para>
+/// </summary>
+struct FloatTolerance {
+public:
+    /// <param name="parameter">The difference, the relative difference, the number of floats or the number of decimals, depending on the mode.</param>
+    FloatTolerance(FloatMode const mode = FloatMode::Absolute, Float64 const parameter = 0.001) {
+        _mode = mode;
+        _parameter = parameter;
+    }
+
+    inline FloatMode GetMode() const noexcept {
+        return _mode;
+    }
+
+    inline Float64 GetParameter() const noexcept {
+        return _parameter;
+    }
+
+    /// <summary>Sets low and high to the smallest and the largest float equal to the filter, both are NaN if the filter is.</summary>
+    template<typename T>
+    void GetRange(T const filter, T& low, T& high) const {
+        static_assert(std::is_floating_point_v<T>, "Only floats have a tolerance");
+
+        if(std::isnan(filter)) {
+            low = filter;
+            high = filter;
+            return;
+        }
+
+        Float64 const value = static_cast<Float64>(filter);
+        // Scale of the last decimal kept by Rounded and Truncated
+        Float64 const scale = std::pow(10.0, std::floor((_parameter > 0.0) ? _parameter : 0.0));
+
+        switch(_mode) {
+        case FloatMode::Relative: {
+            Float64 const difference = std::fabs(value) * std::fabs(_parameter);
+            low = GetBound<T>(value - difference, false, true);
+            high = GetBound<T>(value + difference, true, true);
+            break;
+        }
+        case FloatMode::Ulps: {
+            UInt64 const steps = static_cast<UInt64>(std::fabs(_parameter));
+            low = StepFloat<T>(filter, steps, false);
+            high = StepFloat<T>(filter, steps, true);
+            break;
+        }
+        case FloatMode::Rounded: {
+            // Halves round away from zero, so the bound away from zero belongs to the next value
+            Float64 const rounded = std::round(value * scale);
+            low = GetBound<T>((rounded - 0.5) / scale, false, rounded > 0.0);
+            high = GetBound<T>((rounded + 0.5) / scale, true, rounded < 0.0);
+            break;
+        }
+        case FloatMode::Truncated: {
+            // Cutting off moves towards zero, so the range reaches one step away from zero
+            Float64 const truncated = std::trunc(value * scale);
+            low = GetBound<T>(((truncated > 0.0) ? truncated : (truncated - 1.0)) / scale, false, truncated > 0.0);
+            high = GetBound<T>(((truncated < 0.0) ? truncated : (truncated + 1.0)) / scale, true, truncated < 0.0);
+            break;
+        }
+        default: {
+            Float64 const difference = std::fabs(_parameter);
+            low = GetBound<T>(value - difference, false, true);
+            high = GetBound<T>(value + difference, true, true);
+            break;
+        }
+        }
+    }
+
+private:
+    /// <returns>The float closest to bound on the inside of a range, which includes bound itself only if inclusive.</returns>
+    template<typename T>
+    static inline T GetBound(Float64 const bound, Boolean const upper, Boolean const inclusive) {
+        T result = static_cast<T>(bound);
+        T const inside = upper ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::infinity();
+
+        Float64 const resultValue = static_cast<Float64>(result);
+        if((upper ? (resultValue > bound) : (resultValue < bound)) || (!inclusive && (resultValue == bound))) {
+            result = std::nextafter(result, inside);
+        }
+        return result;
+    }
+
+    /// <returns>The float steps representable floats above or below value, stopping at infinity.</returns>
+    template<typename T>
+    static inline T StepFloat(T const value, UInt64 const steps, Boolean const up) {
+        using Bits = std::conditional_t<sizeof(T) == 4, UInt32, UInt64>;
+        constexpr Bits sign = static_cast<Bits>(1) << ((sizeof(T) * 8) - 1);
+
+        // Maps floats to unsigned keys in the same order, so neighbouring floats have neighbouring keys and both zeros are one key
+        auto const toKey = [](T const x) {
+            Bits bits;
+            memcpy(&bits, &x, sizeof(bits));
+            return ((bits & sign) != 0) ? static_cast<Bits>(sign - (bits & ~sign)) : static_cast<Bits>(sign + bits);
+        };
+        auto const fromKey = [](Bits const key) {
+            Bits const bits = (key >= sign) ? static_cast<Bits>(key - sign) : static_cast<Bits>((sign - key) | sign);
+            T x;
+            memcpy(&x, &bits, sizeof(x));
+            return x;
+        };
+
+        Bits const key = toKey(value);
+        if(up) {
+            Bits const limit = toKey(std::numeric_limits<T>::infinity());
+            return fromKey(((limit - key) <= steps) ? limit : static_cast<Bits>(key + steps));
+        }
+        Bits const limit = toKey(-std::numeric_limits<T>::infinity());
+        return fromKey(((key - limit) <= steps) ? limit : static_cast<Bits>(key - steps));
+    }
+
+    FloatMode _mode;
+    Float64 _parameter;
+};
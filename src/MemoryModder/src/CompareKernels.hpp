@@ -0,0 +1,868 @@
+#pragma once
+
+#include <bit>
+#include <cstring>
+#include <type_traits>
+
+#include "Types.hpp"
+#include "Platform.hpp"
+#include "Compare.hpp"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define MEMORYMODDER_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// MSVC compiles any intrinsic anywhere, GCC and Clang only inside functions that are marked for the instruction set
+#if defined(MEMORYMODDER_X86) && !defined(_MSC_VER)
+#define MEMORYMODDER_TARGET(features) __attribute__((target(features)))
+#else
+#define MEMORYMODDER_TARGET(features)
+#endif
+
+enum struct InstructionSet : UInt8 {
+    Scalar = 0,
+    Sse2 = 1,
+    Avx2 = 2,
+    Avx512 = 3
+};
+
+inline InstructionSet DetectInstructionSet() {
+#if defined(MEMORYMODDER_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    int const maxLeaf = info[0];
+
+    __cpuid(info, 1);
+    Boolean const sse2 = (info[3] & (1 << 26)) != 0;
+    Boolean const osxsave = (info[2] & (1 << 27)) != 0;
+
+    // The OS has to save the larger registers too, not only the CPU support them
+    UInt64 const xcr0 = osxsave ? _xgetbv(0) : 0;
+    Boolean const avxState = (xcr0 & 0x6) == 0x6;
+    Boolean const avx512State = (xcr0 & 0xE6) == 0xE6;
+
+    Boolean avx2 = false;
+    Boolean avx512 = false;
+    if(maxLeaf >= 7) {
+        __cpuidex(info, 7, 0);
+        Boolean const bmi2 = (info[1] & (1 << 8)) != 0;
+        avx2 = avxState && ((info[1] & (1 << 5)) != 0);
+        avx512 = avx512State && bmi2 && ((info[1] & (1 << 16)) != 0) && ((info[1] & (1 << 30)) != 0);
+    }
+
+    if(avx512) return InstructionSet::Avx512;
+    if(avx2) return InstructionSet::Avx2;
+    if(sse2) return InstructionSet::Sse2;
+    return InstructionSet::Scalar;
+#elif defined(MEMORYMODDER_X86)
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("bmi2")) return InstructionSet::Avx512;
+    if(__builtin_cpu_supports("avx2")) return InstructionSet::Avx2;
+    if(__builtin_cpu_supports("sse2")) return InstructionSet::Sse2;
+    return InstructionSet::Scalar;
+#else
+    return InstructionSet::Scalar;
+#endif
+}
+
+/// <returns>The best instruction set of this CPU, detected once.</returns>
+inline InstructionSet GetInstructionSet() {
+    static InstructionSet const instructionSet = DetectInstructionSet();
+    return instructionSet;
+}
+
+constexpr char const* GetInstructionSetName(InstructionSet const instructionSet) {
+    switch(instructionSet) {
+    case InstructionSet::Sse2: return "SSE2";
+    case InstructionSet::Avx2: return "AVX2";
+    case InstructionSet::Avx512: return "AVX-512";
+    default: return "Scalar";
+    }
+}
+
+template<typename T>
+inline T LoadValue(UInt8 const* data) {
+    T value;
+    memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+/// <returns>A mask with the lowest bit of every group of size bits set, e.g. 0x1111... for 4.</returns>
+constexpr UInt64 GetFirstBytePattern(SizeT const size) {
+    UInt64 pattern = 0;
+    for(SizeT i = 0; i < 64; i += size) {
+        pattern |= (static_cast<UInt64>(1) << i);
+    }
+    return pattern;
+}
+
+/// <summary>
+/// <para>Writes one bit per value to masks, bit i of masks[i / 64] is set if value i compares true with the filter.</para>
+/// <para>Aligned: value i is at data + i * sizeof(T), data holds count * sizeof(T) bytes.</para>
+/// <para>Unaligned: value i is at data + i, data holds count + sizeof(T) - 1 bytes.</para>
+/// </summary>
+template<typename T>
+using CompareKernel = void (*)(UInt8 const* data, SizeT count, T filter, UInt64* masks);
+
+/// <summary>Writes one bit per value to masks like CompareKernel, comparing with a range of equal values, see CompareRange.</summary>
+template<typename T>
+using CompareRangeKernel = void (*)(UInt8 const* data, SizeT count, T low, T high, UInt64* masks);
+
+template<typename T, MemoryComparison comparison, Boolean aligned>
+void CompareScalar(UInt8 const* data, SizeT const count, T const filter, UInt64* masks) {
+    constexpr SizeT stride = aligned ? sizeof(T) : 1;
+
+    memset(masks, 0, ((count + 63) / 64) * sizeof(UInt64));
+    for(SizeT i = 0; i < count; ++i) {
+        if(Compare<T, comparison>(LoadValue<T>(data + (i * stride)), filter)) {
+            masks[i / 64] |= static_cast<UInt64>(1) << (i % 64);
+        }
+    }
+}
+
+template<typename T, MemoryComparison comparison, Boolean aligned>
+void CompareRangeScalar(UInt8 const* data, SizeT const count, T const low, T const high, UInt64* masks) {
+    constexpr SizeT stride = aligned ? sizeof(T) : 1;
+
+    memset(masks, 0, ((count + 63) / 64) * sizeof(UInt64));
+    for(SizeT i = 0; i < count; ++i) {
+        if(CompareRange<T, comparison>(LoadValue<T>(data + (i * stride)), low, high)) {
+            masks[i / 64] |= static_cast<UInt64>(1) << (i % 64);
+        }
+    }
+}
+
+#if defined(MEMORYMODDER_X86)
+
+/// <summary>
+/// <para>Vector kernels built on an instruction set struct providing:</para>
+/// <para>Vector Broadcast&lt;T&gt;(T), UInt64 CompareLanes&lt;T, comparison&gt;(UInt8 const*, Vector) with one bit per lane,</para>
+/// <para>UInt64 CompareFirstBytes&lt;T, comparison&gt;(UInt8 const*, Vector) with the bit of the first byte of every lane, and Width in bytes.</para>
+/// <para>CompareRangeLanes and CompareRangeFirstBytes do the same with a low and a high Vector.</para>
+/// </summary>
+#define MEMORYMODDER_DEFINE_KERNELS(Isa, features)                                                                         \
+template<typename T, MemoryComparison comparison>                                                                          \
+MEMORYMODDER_TARGET(features) void CompareAligned##Isa(UInt8 const* data, SizeT const count, T const filter, UInt64* masks) { \
+    constexpr SizeT lanes = Isa::Width / sizeof(T);                                                                        \
+    typename Isa::Vector const filterVector = Isa::template Broadcast<T>(filter);                                          \
+    memset(masks, 0, ((count + 63) / 64) * sizeof(UInt64));                                                                \
+    SizeT i = 0;                                                                                                           \
+    for(; (i + lanes) <= count; i += lanes) {                                                                              \
+        masks[i / 64] |= Isa::template CompareLanes<T, comparison>(data + (i * sizeof(T)), filterVector) << (i % 64);     \
+    }                                                                                                                      \
+    for(; i < count; ++i) {                                                                                                \
+        if(Compare<T, comparison>(LoadValue<T>(data + (i * sizeof(T))), filter)) {                                         \
+            masks[i / 64] |= static_cast<UInt64>(1) << (i % 64);                                                          \
+        }                                                                                                                  \
+    }                                                                                                                      \
+}                                                                                                                          \
+                                                                                                                           \
+/* Every shift compares the values starting at one byte of each lane, together they cover every address */                 \
+template<typename T, MemoryComparison comparison>                                                                          \
+MEMORYMODDER_TARGET(features) void CompareUnaligned##Isa(UInt8 const* data, SizeT const count, T const filter, UInt64* masks) { \
+    constexpr SizeT width = Isa::Width;                                                                                    \
+    typename Isa::Vector const filterVector = Isa::template Broadcast<T>(filter);                                          \
+    memset(masks, 0, ((count + 63) / 64) * sizeof(UInt64));                                                                \
+    SizeT i = 0;                                                                                                           \
+    for(; (i + width) <= count; i += width) {                                                                              \
+        UInt64 mask = 0;                                                                                                   \
+        for(SizeT shift = 0; shift < sizeof(T); ++shift) {                                                                 \
+            mask |= Isa::template CompareFirstBytes<T, comparison>(data + i + shift, filterVector) << shift;               \
+        }                                                                                                                  \
+        masks[i / 64] |= mask << (i % 64);                                                                                 \
+    }                                                                                                                      \
+    for(; i < count; ++i) {                                                                                                \
+        if(Compare<T, comparison>(LoadValue<T>(data + i), filter)) {                                                       \
+            masks[i / 64] |= static_cast<UInt64>(1) << (i % 64);                                                           \
+        }                                                                                                                  \
+    }                                                                                                                      \
+}                                                                                                                          \
+                                                                                                                           \
+template<typename T, MemoryComparison comparison>                                                                          \
+MEMORYMODDER_TARGET(features) void CompareRangeAligned##Isa(UInt8 const* data, SizeT const count, T const low, T const high, UInt64* masks) { \
+    constexpr SizeT lanes = Isa::Width / sizeof(T);                                                                        \
+    typename Isa::Vector const lowVector = Isa::template Broadcast<T>(low);                                                \
+    typename Isa::Vector const highVector = Isa::template Broadcast<T>(high);                                              \
+    memset(masks, 0, ((count + 63) / 64) * sizeof(UInt64));                                                                \
+    SizeT i = 0;                                                                                                           \
+    for(; (i + lanes) <= count; i += lanes) {                                                                              \
+        masks[i / 64] |= Isa::template CompareRangeLanes<T, comparison>(data + (i * sizeof(T)), lowVector, highVector) << (i % 64); \
+    }                                                                                                                      \
+    for(; i < count; ++i) {                                                                                                \
+        if(CompareRange<T, comparison>(LoadValue<T>(data + (i * sizeof(T))), low, high)) {                                 \
+            masks[i / 64] |= static_cast<UInt64>(1) << (i % 64);                                                           \
+        }                                                                                                                  \
+    }                                                                                                                      \
+}                                                                                                                          \
+                                                                                                                           \
+template<typename T, MemoryComparison comparison>                                                                          \
+MEMORYMODDER_TARGET(features) void CompareRangeUnaligned##Isa(UInt8 const* data, SizeT const count, T const low, T const high, UInt64* masks) { \
+    constexpr SizeT width = Isa::Width;                                                                                    \
+    typename Isa::Vector const lowVector = Isa::template Broadcast<T>(low);                                                \
+    typename Isa::Vector const highVector = Isa::template Broadcast<T>(high);                                              \
+    memset(masks, 0, ((count + 63) / 64) * sizeof(UInt64));                                                                \
+    SizeT i = 0;                                                                                                           \
+    for(; (i + width) <= count; i += width) {                                                                              \
+        UInt64 mask = 0;                                                                                                   \
+        for(SizeT shift = 0; shift < sizeof(T); ++shift) {                                                                 \
+            mask |= Isa::template CompareRangeFirstBytes<T, comparison>(data + i + shift, lowVector, highVector) << shift; \
+        }                                                                                                                  \
+        masks[i / 64] |= mask << (i % 64);                                                                                 \
+    }                                                                                                                      \
+    for(; i < count; ++i) {                                                                                                \
+        if(CompareRange<T, comparison>(LoadValue<T>(data + i), low, high)) {                                               \
+            masks[i / 64] |= static_cast<UInt64>(1) << (i % 64);                                                           \
+        }                                                                                                                  \
+    }                                                                                                                      \
+}
+
+template<typename T>
+constexpr Boolean IsUnsigned() {
+    return std::is_unsigned_v<T>;
+}
+
+struct Sse2 {
+public:
+    using Vector = __m128i;
+    static constexpr SizeT Width = 16;
+
+    template<typename T>
+    MEMORYMODDER_TARGET("sse2") static inline __m128i Broadcast(T const value) {
+        if constexpr(std::is_same_v<T, Float32>) { return _mm_castps_si128(_mm_set1_ps(value)); }
+        else if constexpr(std::is_same_v<T, Float64>) { return _mm_castpd_si128(_mm_set1_pd(value)); }
+        else if constexpr(sizeof(T) == 1) { return _mm_set1_epi8(static_cast<char>(value)); }
+        else if constexpr(sizeof(T) == 2) { return _mm_set1_epi16(static_cast<short>(value)); }
+        else if constexpr(sizeof(T) == 4) { return _mm_set1_epi32(static_cast<int>(value)); }
+        else { return _mm_set_epi32(static_cast<int>(static_cast<UInt64>(value) >> 32), static_cast<int>(value), static_cast<int>(static_cast<UInt64>(value) >> 32), static_cast<int>(value)); }
+    }
+
+    template<typename T, MemoryComparison comparison>
+    MEMORYMODDER_TARGET("sse2") static inline UInt64 CompareLanes(UInt8 const* data, __m128i const filter) {
+        return GetLaneMask<T>(CompareVector<T, comparison>(_mm_loadu_si128(reinterpret_cast<__m128i const*>(data)), filter));
+    }
+
+    template<typename T, MemoryComparison comparison>
+    MEMORYMODDER_TARGET("sse2") static inline UInt64 CompareFirstBytes(UInt8 const* data, __m128i const filter) {
+        return GetFirstByteMask<T>(CompareVector<T, comparison>(_mm_loadu_si128(reinterpret_cast<__m128i const*>(data)), filter));
+    }
+
+    template<typename T, MemoryComparison comparison>
+    MEMORYMODDER_TARGET("sse2") static inline UInt64 CompareRangeLanes(UInt8 const* data, __m128i const low, __m128i const high) {
+        return GetLaneMask<T>(CompareRangeVector<T, comparison>(_mm_loadu_si128(reinterpret_cast<__m128i const*>(data)), low, high));
+    }
+
+    template<typename T, MemoryComparison comparison>
+    MEMORYMODDER_TARGET("sse2") static inline UInt64 CompareRangeFirstBytes(UInt8 const* data, __m128i const low, __m128i const high) {
+        return GetFirstByteMask<T>(CompareRangeVector<T, comparison>(_mm_loadu_si128(reinterpret_cast<__m128i const*>(data)), low, high));
+    }
+
+private:
+    template<typename T>
+    MEMORYMODDER_TARGET("sse2") static inline UInt64 GetLaneMask(__m128i const result) {
+        if constexpr(sizeof(T) == 1) { return static_cast<UInt32>(_mm_movemask_epi8(result)); }
+        else if constexpr(sizeof(T) == 2) { return static_cast<UInt32>(_mm_movemask_epi8(_mm_packs_epi16(result, _mm_setzero_si128()))); }
+        else if constexpr(sizeof(T) == 4) { return static_cast<UInt32>(_mm_movemask_ps(_mm_castsi128_ps(result))); }
+        else { return static_cast<UInt32>(_mm_movemask_pd(_mm_castsi128_pd(result))); }
+    }
+
+    template<typename T>
+    MEMORYMODDER_TARGET("sse2") static inline UInt64 GetFirstByteMask(__m128i const result) {
+        return static_cast<UInt32>(_mm_movemask_epi8(result)) & (GetFirstBytePattern(sizeof(T)) & 0xFFFF);
+    }
+
+    template<SizeT size>
+    MEMORYMODDER_TARGET("sse2") static inline __m128i EqualsInteger(__m128i const a, __m128i const b) {
+        if constexpr(size == 1) { return _mm_cmpeq_epi8(a, b); }
+        else if constexpr(size == 2) { return _mm_cmpeq_epi16(a, b); }
+        else if constexpr(size == 4) { return _mm_cmpeq_epi32(a, b); }
+        else {
+            // Both halves have to be equal
+            __m128i const equals = _mm_cmpeq_epi32(a, b);
+            return _mm_and_si128(equals, _mm_shuffle_epi32(equals, _MM_SHUFFLE(2, 3, 0, 1)));
+        }
+    }
+
+    template<SizeT size>
+    MEMORYMODDER_TARGET("sse2") static inline __m128i GreaterThanSigned(__m128i const a, __m128i const b) {
+        if constexpr(size == 1) { return _mm_cmpgt_epi8(a, b); }
+        else if constexpr(size == 2) { return _mm_cmpgt_epi16(a, b); }
+        else if constexpr(size == 4) { return _mm_cmpgt_epi32(a, b); }
+        else {
+            // Greater high half, or equal high half and a borrow from the low half of b - a
+            __m128i result = _mm_and_si128(_mm_cmpeq_epi32(a, b), _mm_sub_epi64(b, a));
+            result = _mm_or_si128(result, _mm_cmpgt_epi32(a, b));
+            return _mm_shuffle_epi32(result, _MM_SHUFFLE(3, 3, 1, 1));
+        }
+    }
+
+    template<typename T>
+    MEMORYMODDER_TARGET("sse2") static inline __m128i GreaterThanInteger(__m128i const a, __m128i const b) {
+        if constexpr(IsUnsigned<T>()) {
+            // Flipping the sign bit turns an unsigned comparison into a signed one
+            __m128i const sign = Broadcast<T>(static_cast<T>(static_cast<T>(1) << ((sizeof(T) * 8) - 1)));
+            return GreaterThanSigned<sizeof(T)>(_mm_xor_si128(a, sign), _mm_xor_si128(b, sign));
+        }
+        else {
+            return GreaterThanSigned<sizeof(T)>(a, b);
+        }
+    }
+
+    template<typename T, MemoryComparison comparison>
+    MEMORYMODDER_TARGET("sse2") static inline __m128i CompareVector(__m128i const a, __m128i const b) {
+        // Floats are equal within 0.001 of the filter, see Compare
+        if constexpr(std::is_same_v<T, Float32>) {
+            __m128 const y = _mm_castsi128_ps(b);
+            __m128 const epsilon = _mm_set1_ps(0.001F);
+            return CompareRangeVector<T, comparison>(a, _mm_castps_si128(_mm_sub_ps(y, epsilon)), _mm_castps_si128(_mm_add_ps(y, epsilon)));
+        }
+        else if constexpr(std::is_same_v<T, Float64>) {
+            __m128d const y = _mm_castsi128_pd(b);
+            __m128d const epsilon = _mm_set1_pd(0.001);
+            return CompareRangeVector<T, comparison>(a, _mm_castpd_si128(_mm_sub_pd(y, epsilon)), _mm_castpd_si128(_mm_add_pd(y, epsilon)));
+        }
+        else {
+            __m128i const ones = _mm_set1_epi32(-1);
+
+            if constexpr(comparison == MemoryComparison::Equals) { return EqualsInteger<sizeof(T)>(a, b); }
+            else if constexpr(comparison == MemoryComparison::NotEquals) { return _mm_xor_si128(EqualsInteger<sizeof(T)>(a, b), ones); }
+            else if constexpr(comparison == MemoryComparison::LessThan) { return GreaterThanInteger<T>(b, a); }
+            else if constexpr(comparison == MemoryComparison::GreaterThan) { return GreaterThanInteger<T>(a, b); }
+            else if constexpr(comparison == MemoryComparison::LessThanEquals) { return _mm_xor_si128(GreaterThanInteger<T>(a, b), ones); }
+            else { return _mm_xor_si128(GreaterThanInteger<T>(b, a), ones); }
+        }
+    }
+
+    template<typename T, MemoryComparison comparison>
+    MEMORYMODDER_TARGET("sse2") static inline __m128i CompareRangeVector(__m128i const a, __m128i const low, __m128i const high) {
+        if constexpr(std::is_same_v<T, Float32>) {
+            __m128 const x = _mm_castsi128_ps(a);
+            __m128 const l = _mm_castsi128_ps(low);
+            __m128 const h = _mm_castsi128_ps(high);
+
+            if constexpr(comparison == MemoryComparison::Equals) { return _mm_castps_si128(_mm_and_ps(_mm_cmpge_ps(x, l), _mm_cmple_ps(x, h))); }
+            else if constexpr(comparison == MemoryComparison::NotEquals) { return _mm_castps_si128(_mm_or_ps(_mm_cmplt_ps(x, l), _mm_cmpgt_ps(x, h))); }
+            else if constexpr(comparison == MemoryComparison::LessThan) { return _mm_castps_si128(_mm_cmplt_ps(x, l)); }
+            else if constexpr(comparison == MemoryComparison::GreaterThan) { return _mm_castps_si128(_mm_cmpgt_ps(x, h)); }
+            else if constexpr(comparison == MemoryComparison::LessThanEquals) { return _mm_castps_si128(_mm_cmple_ps(x, h)); }
+            else { return _mm_castps_si128(_mm_cmpge_ps(x, l)); }
+        }
+        else if constexpr(std::is_same_v<T, Float64>) {
+            __m128d const x = _mm_castsi128_pd(a);
+            __m128d const l = _mm_castsi128_pd(low);
+            __m128d const h = _mm_castsi128_pd(high);
+
+            if constexpr(comparison == MemoryComparison::Equals) { return _mm_castpd_si128(_mm_and_pd(_mm_cmpge_pd(x, l), _mm_cmple_pd(x, h))); }
+            else if constexpr(comparison == MemoryComparison::NotEquals) { return _mm_castpd_si128(_mm_or_pd(_mm_cmplt_pd(x, l), _mm_cmpgt_pd(x, h))); }
+            else if constexpr(comparison == MemoryComparison::LessThan) { return _mm_castpd_si128(_mm_cmplt_pd(x, l)); }
+            else if constexpr(comparison == MemoryComparison::GreaterThan) { return _mm_castpd_si128(_mm_cmpgt_pd(x, h)); }
+            else if constexpr(comparison == MemoryComparison::LessThanEquals) { return _mm_castpd_si128(_mm_cmple_pd(x, h)); }
+            else { return _mm_castpd_si128(_mm_cmpge_pd(x, l)); }
+        }
+        else {
+            __m128i const ones = _mm_set1_epi32(-1);
+            __m128i const below = GreaterThanInteger<T>(low, a);
+            __m128i const above = GreaterThanInteger<T>(a, high);
+
+            if constexpr(comparison == MemoryComparison::Equals) { return _mm_xor_si128(_mm_or_si128(below, above), ones); }
+            else if constexpr(comparison == MemoryComparison::NotEquals) { return _mm_or_si128(below, above); }
+            else if constexpr(comparison == MemoryComparison::LessThan) { return below; }
+            else if constexpr(comparison == MemoryComparison::GreaterThan) { return above; }
+            else if constexpr(comparison == MemoryComparison::LessThanEquals) { return _mm_xor_si128(above, ones); }
+            else { return _mm_xor_si128(below, ones); }
+        }
+    }
+};
+
+struct Avx2 {
+public:
+    using Vector = __m256i;
+    static constexpr SizeT Width = 32;
+
+    template<typename T>
+    MEMORYMODDER_TARGET("avx2") static inline __m256i Broadcast(T const value) {
+        if constexpr(std::is_same_v<T, Float32>) { return _mm256_castps_si256(_mm256_set1_ps(value)); }
+        else if constexpr(std::is_same_v<T, Float64>) { return _mm256_castpd_si256(_mm256_set1_pd(value)); }
+        else if constexpr(sizeof(T) == 1) { return _mm256_set1_epi8(static_cast<char>(value)); }
+        else if constexpr(sizeof(T) == 2) { return _mm256_set1_epi16(static_cast<short>(value)); }
+        else if constexpr(sizeof(T) == 4) { return _mm256_set1_epi32(static_cast<int>(value)); }
+        else { return _mm256_set1_epi64x(static_cast<long long>(value)); }
+    }
+
+    template<typename T, MemoryComparison comparison>
+    MEMORYMODDER_TARGET("avx2") static inline UInt64 CompareLanes(UInt8 const* data, __m256i const filter) {
+        return GetLaneMask<T>(CompareVector<T, comparison>(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(data)), filter));
+    }
+
+    template<typename T, MemoryComparison comparison>
+    MEMORYMODDER_TARGET("avx2") static inline UInt64 CompareFirstBytes(UInt8 const* data, __m256i const filter) {
+        return GetFirstByteMask<T>(CompareVector<T, comparison>(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(data)), filter));
+    }
+
+    template<typename T, MemoryComparison comparison>
+    MEMORYMODDER_TARGET("avx2") static inline UInt64 CompareRangeLanes(UInt8 const* data, __m256i const low, __m256i const high) {
+        return GetLaneMask<T>(CompareRangeVector<T, comparison>(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(data)), low, high));
+    }
+
+    template<typename T, MemoryComparison comparison>
+    MEMORYMODDER_TARGET("avx2") static inline UInt64 CompareRangeFirstBytes(UInt8 const* data, __m256i const low, __m256i const high) {
+        return GetFirstByteMask<T>(CompareRangeVector<T, comparison>(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(data)), low, high));
+    }
+
+private:
+    template<typename T>
+    MEMORYMODDER_TARGET("avx2") static inline UInt64 GetLaneMask(__m256i const result) {
+        if constexpr(sizeof(T) == 1) { return static_cast<UInt32>(_mm256_movemask_epi8(result)); }
+        else if constexpr(sizeof(T) == 2) {
+            // Packing works within each 128 bit half, the permute moves both packed halves to the low 128 bits
+            __m256i const packed = _mm256_permute4x64_epi64(_mm256_packs_epi16(result, _mm256_setzero_si256()), _MM_SHUFFLE(3, 1, 2, 0));
+            return static_cast<UInt32>(_mm256_movemask_epi8(packed)) & 0xFFFF;
+        }
+        else if constexpr(sizeof(T) == 4) { return static_cast<UInt32>(_mm256_movemask_ps(_mm256_castsi256_ps(result))); }
+        else { return static_cast<UInt32>(_mm256_movemask_pd(_mm256_castsi256_pd(result))); }
+    }
+
+    template<typename T>
+    MEMORYMODDER_TARGET("avx2") static inline UInt64 GetFirstByteMask(__m256i const result) {
+        return static_cast<UInt32>(_mm256_movemask_epi8(result)) & (GetFirstBytePattern(sizeof(T)) & 0xFFFFFFFF);
+    }
+
+    template<SizeT size>
+    MEMORYMODDER_TARGET("avx2") static inline __m256i EqualsInteger(__m256i const a, __m256i const b) {
+        if constexpr(size == 1) { return _mm256_cmpeq_epi8(a, b); }
+        else if constexpr(size == 2) { return _mm256_cmpeq_epi16(a, b); }
+        else if constexpr(size == 4) { return _mm256_cmpeq_epi32(a, b); }
+        else { return _mm256_cmpeq_epi64(a, b); }
+    }
+
+    template<SizeT size>
+    MEMORYMODDER_TARGET("avx2") static inline __m256i GreaterThanSigned(__m256i const a, __m256i const b) {
+        if constexpr(size == 1) { return _mm256_cmpgt_epi8(a, b); }
+        else if constexpr(size == 2) { return _mm256_cmpgt_epi16(a, b); }
+        else if constexpr(size == 4) { return _mm256_cmpgt_epi32(a, b); }
+        else { return _mm256_cmpgt_epi64(a, b); }
+    }
+
+    template<typename T>
+    MEMORYMODDER_TARGET("avx2") static inline __m256i GreaterThanInteger(__m256i const a, __m256i const b) {
+        if constexpr(IsUnsigned<T>()) {
+            // Flipping the sign bit turns an unsigned comparison into a signed one
+            __m256i const sign = Broadcast<T>(static_cast<T>(static_cast<T>(1) << ((sizeof(T) * 8) - 1)));
+            return GreaterThanSigned<sizeof(T)>(_mm256_xor_si256(a, sign), _mm256_xor_si256(b, sign));
+        }
+        else {
+            return GreaterThanSigned<sizeof(T)>(a, b);
+        }
+    }
+
+    template<typename T, MemoryComparison comparison>
+    MEMORYMODDER_TARGET("avx2") static inline __m256i CompareVector(__m256i const a, __m256i const b) {
+        // Floats are equal within 0.001 of the filter, see Compare
+        if constexpr(std::is_same_v<T, Float32>) {
+            __m256 const y = _mm256_castsi256_ps(b);
+            __m256 const epsilon = _mm256_set1_ps(0.001F);
+            return CompareRangeVector<T, comparison>(a, _mm256_castps_si256(_mm256_sub_ps(y, epsilon)), _mm256_castps_si256(_mm256_add_ps(y, epsilon)));
+        }
+        else if constexpr(std::is_same_v<T, Float64>) {
+            __m256d const y = _mm256_castsi256_pd(b);
+            __m256d const epsilon = _mm256_set1_pd(0.001);
+            return CompareRangeVector<T, comparison>(a, _mm256_castpd_si256(_mm256_sub_pd(y, epsilon)), _mm256_castpd_si256(_mm256_add_pd(y, epsilon)));
+        }
+        else {
+            __m256i const ones = _mm256_set1_epi32(-1);
+
+            if constexpr(comparison == MemoryComparison::Equals) { return EqualsInteger<sizeof(T)>(a, b); }
+            else if constexpr(comparison == MemoryComparison::NotEquals) { return _mm256_xor_si256(EqualsInteger<sizeof(T)>(a, b), ones); }
+            else if constexpr(comparison == MemoryComparison::LessThan) { return GreaterThanInteger<T>(b, a); }
+            else if constexpr(comparison == MemoryComparison::GreaterThan) { return GreaterThanInteger<T>(a, b); }
+            else if constexpr(comparison == MemoryComparison::LessThanEquals) { return _mm256_xor_si256(GreaterThanInteger<T>(a, b), ones); }
+            else { return _mm256_xor_si256(GreaterThanInteger<T>(b, a), ones); }
+        }
+    }
+
+    template<typename T, MemoryComparison comparison>
+    MEMORYMODDER_TARGET("avx2") static inline __m256i CompareRangeVector(__m256i const a, __m256i const low, __m256i const high) {
+        if constexpr(std::is_same_v<T, Float32>) {
+            __m256 const x = _mm256_castsi256_ps(a);
+            __m256 const l = _mm256_castsi256_ps(low);
+            __m256 const h = _mm256_castsi256_ps(high);
+
+            if constexpr(comparison == MemoryComparison::Equals) { return _mm256_castps_si256(_mm256_and_ps(_mm256_cmp_ps(x, l, _CMP_GE_OQ), _mm256_cmp_ps(x, h, _CMP_LE_OQ))); }
+            else if constexpr(comparison == MemoryComparison::NotEquals) { return _mm256_castps_si256(_mm256_or_ps(_mm256_cmp_ps(x, l, _CMP_LT_OQ), _mm256_cmp_ps(x, h, _CMP_GT_OQ))); }
+            else if constexpr(comparison == MemoryComparison::LessThan) { return _mm256_castps_si256(_mm256_cmp_ps(x, l, _CMP_LT_OQ)); }
+            else if constexpr(comparison == MemoryComparison::GreaterThan) { return _mm256_castps_si256(_mm256_cmp_ps(x, h, _CMP_GT_OQ)); }
+            else if constexpr(comparison == MemoryComparison::LessThanEquals) { return _mm256_castps_si256(_mm256_cmp_ps(x, h, _CMP_LE_OQ)); }
+            else { return _mm256_castps_si256(_mm256_cmp_ps(x, l, _CMP_GE_OQ)); }
+        }
+        else if constexpr(std::is_same_v<T, Float64>) {
+            __m256d const x = _mm256_castsi256_pd(a);
+            __m256d const l = _mm256_castsi256_pd(low);
+            __m256d const h = _mm256_castsi256_pd(high);
+
+            if constexpr(comparison == MemoryComparison::Equals) { return _mm256_castpd_si256(_mm256_and_pd(_mm256_cmp_pd(x, l, _CMP_GE_OQ), _mm256_cmp_pd(x, h, _CMP_LE_OQ))); }
+            else if constexpr(comparison == MemoryComparison::NotEquals) { return _mm256_castpd_si256(_mm256_or_pd(_mm256_cmp_pd(x, l, _CMP_LT_OQ), _mm256_cmp_pd(x, h, _CMP_GT_OQ))); }
+            else if constexpr(comparison == MemoryComparison::LessThan) { return _mm256_castpd_si256(_mm256_cmp_pd(x, l, _CMP_LT_OQ)); }
+            else if constexpr(comparison == MemoryComparison::GreaterThan) { return _mm256_castpd_si256(_mm256_cmp_pd(x, h, _CMP_GT_OQ)); }
+            else if constexpr(comparison == MemoryComparison::LessThanEquals) { return _mm256_castpd_si256(_mm256_cmp_pd(x, h, _CMP_LE_OQ)); }
+            else { return _mm256_castpd_si256(_mm256_cmp_pd(x, l, _CMP_GE_OQ)); }
+        }
+        else {
+            __m256i const ones = _mm256_set1_epi32(-1);
+            __m256i const below = GreaterThanInteger<T>(low, a);
+            __m256i const above = GreaterThanInteger<T>(a, high);
+
+            if constexpr(comparison == MemoryComparison::Equals) { return _mm256_xor_si256(_mm256_or_si256(below, above), ones); }
+            else if constexpr(comparison == MemoryComparison::NotEquals) { return _mm256_or_si256(below, above); }
+            else if constexpr(comparison == MemoryComparison::LessThan) { return below; }
+            else if constexpr(comparison == MemoryComparison::GreaterThan) { return above; }
+            else if constexpr(comparison == MemoryComparison::LessThanEquals) { return _mm256_xor_si256(above, ones); }
+            else { return _mm256_xor_si256(below, ones); }
+        }
+    }
+};
+
+struct Avx512 {
+public:
+    using Vector = __m512i;
+    static constexpr SizeT Width = 64;
+
+    template<typename T>
+    MEMORYMODDER_TARGET("avx512f,avx512bw,bmi2") static inline __m512i Broadcast(T const value) {
+        if constexpr(std::is_same_v<T, Float32>) { return _mm512_castps_si512(_mm512_set1_ps(value)); }
+        else if constexpr(std::is_same_v<T, Float64>) { return _mm512_castpd_si512(_mm512_set1_pd(value)); }
+        else if constexpr(sizeof(T) == 1) { return _mm512_set1_epi8(static_cast<char>(value)); }
+        else if constexpr(sizeof(T) == 2) { return _mm512_set1_epi16(static_cast<short>(value)); }
+        else if constexpr(sizeof(T) == 4) { return _mm512_set1_epi32(static_cast<int>(value)); }
+        else { return _mm512_set1_epi64(static_cast<long long>(value)); }
+    }
+
+    template<typename T, MemoryComparison comparison>
+    MEMORYMODDER_TARGET("avx512f,avx512bw,bmi2") static inline UInt64 CompareLanes(UInt8 const* data, __m512i const filter) {
+        return CompareMask<T, comparison>(_mm512_loadu_si512(data), filter);
+    }
+
+    template<typename T, MemoryComparison comparison>
+    MEMORYMODDER_TARGET("avx512f,avx512bw,bmi2") static inline UInt64 CompareFirstBytes(UInt8 const* data, __m512i const filter) {
+        return GetFirstByteMask<T>(CompareMask<T, comparison>(_mm512_loadu_si512(data), filter));
+    }
+
+    template<typename T, MemoryComparison comparison>
+    MEMORYMODDER_TARGET("avx512f,avx512bw,bmi2") static inline UInt64 CompareRangeLanes(UInt8 const* data, __m512i const low, __m512i const high) {
+        return CompareRangeMask<T, comparison>(_mm512_loadu_si512(data), low, high);
+    }
+
+    template<typename T, MemoryComparison comparison>
+    MEMORYMODDER_TARGET("avx512f,avx512bw,bmi2") static inline UInt64 CompareRangeFirstBytes(UInt8 const* data, __m512i const low, __m512i const high) {
+        return GetFirstByteMask<T>(CompareRangeMask<T, comparison>(_mm512_loadu_si512(data), low, high));
+    }
+
+private:
+    /// <summary>Spreads the lane bits out to the first byte of every lane.</summary>
+    template<typename T>
+    MEMORYMODDER_TARGET("avx512f,avx512bw,bmi2") static inline UInt64 GetFirstByteMask(UInt64 const mask) {
+        constexpr UInt64 pattern = GetFirstBytePattern(sizeof(T));
+#if defined(_M_X64) || defined(__x86_64__)
+        return _pdep_u64(mask, pattern);
+#else
+        constexpr UInt32 lowPattern = static_cast<UInt32>(pattern);
+        constexpr Int32 lowLanes = std::popcount(lowPattern);
+        return static_cast<UInt64>(_pdep_u32(static_cast<UInt32>(mask), lowPattern)) | (static_cast<UInt64>(_pdep_u32(static_cast<UInt32>(mask >> lowLanes), lowPattern)) << 32);
+#endif
+    }
+
+    static constexpr int GetIntegerPredicate(MemoryComparison const comparison) {
+        switch(comparison) {
+        case MemoryComparison::Equals: return _MM_CMPINT_EQ;
+        case MemoryComparison::NotEquals: return _MM_CMPINT_NE;
+        case MemoryComparison::LessThan: return _MM_CMPINT_LT;
+        case MemoryComparison::GreaterThan: return _MM_CMPINT_NLE;
+        case MemoryComparison::LessThanEquals: return _MM_CMPINT_LE;
+        default: return _MM_CMPINT_NLT;
+        }
+    }
+
+    template<typename T, MemoryComparison comparison>
+    MEMORYMODDER_TARGET("avx512f,avx512bw,bmi2") static inline UInt64 CompareMask(__m512i const a, __m512i const b) {
+        // Floats are equal within 0.001 of the filter, see Compare
+        if constexpr(std::is_same_v<T, Float32>) {
+            __m512 const y = _mm512_castsi512_ps(b);
+            __m512 const epsilon = _mm512_set1_ps(0.001F);
+            return CompareRangeMask<T, comparison>(a, _mm512_castps_si512(_mm512_sub_ps(y, epsilon)), _mm512_castps_si512(_mm512_add_ps(y, epsilon)));
+        }
+        else if constexpr(std::is_same_v<T, Float64>) {
+            __m512d const y = _mm512_castsi512_pd(b);
+            __m512d const epsilon = _mm512_set1_pd(0.001);
+            return CompareRangeMask<T, comparison>(a, _mm512_castpd_si512(_mm512_sub_pd(y, epsilon)), _mm512_castpd_si512(_mm512_add_pd(y, epsilon)));
+        }
+        else {
+            constexpr int predicate = GetIntegerPredicate(comparison);
+
+            if constexpr(IsUnsigned<T>()) {
+                if constexpr(sizeof(T) == 1) { return _mm512_cmp_epu8_mask(a, b, predicate); }
+                else if constexpr(sizeof(T) == 2) { return _mm512_cmp_epu16_mask(a, b, predicate); }
+                else if constexpr(sizeof(T) == 4) { return _mm512_cmp_epu32_mask(a, b, predicate); }
+                else { return _mm512_cmp_epu64_mask(a, b, predicate); }
+            }
+            else {
+                if constexpr(sizeof(T) == 1) { return _mm512_cmp_epi8_mask(a, b, predicate); }
+                else if constexpr(sizeof(T) == 2) { return _mm512_cmp_epi16_mask(a, b, predicate); }
+                else if constexpr(sizeof(T) == 4) { return _mm512_cmp_epi32_mask(a, b, predicate); }
+                else { return _mm512_cmp_epi64_mask(a, b, predicate); }
+            }
+        }
+    }
+
+    template<typename T, MemoryComparison comparison>
+    MEMORYMODDER_TARGET("avx512f,avx512bw,bmi2") static inline UInt64 CompareRangeMask(__m512i const a, __m512i const low, __m512i const high) {
+        // A value below low or above high is found with the single comparisons, the others combine both
+        if constexpr(comparison == MemoryComparison::Equals) { return CompareRangeMask<T, MemoryComparison::GreaterThanEquals>(a, low, high) & CompareRangeMask<T, MemoryComparison::LessThanEquals>(a, low, high); }
+        else if constexpr(comparison == MemoryComparison::NotEquals) { return CompareRangeMask<T, MemoryComparison::LessThan>(a, low, high) | CompareRangeMask<T, MemoryComparison::GreaterThan>(a, low, high); }
+        else if constexpr(std::is_same_v<T, Float32>) {
+            __m512 const x = _mm512_castsi512_ps(a);
+            if constexpr(comparison == MemoryComparison::LessThan) { return _mm512_cmp_ps_mask(x, _mm512_castsi512_ps(low), _CMP_LT_OQ); }
+            else if constexpr(comparison == MemoryComparison::GreaterThan) { return _mm512_cmp_ps_mask(x, _mm512_castsi512_ps(high), _CMP_GT_OQ); }
+            else if constexpr(comparison == MemoryComparison::LessThanEquals) { return _mm512_cmp_ps_mask(x, _mm512_castsi512_ps(high), _CMP_LE_OQ); }
+            else { return _mm512_cmp_ps_mask(x, _mm512_castsi512_ps(low), _CMP_GE_OQ); }
+        }
+        else if constexpr(std::is_same_v<T, Float64>) {
+            __m512d const x = _mm512_castsi512_pd(a);
+            if constexpr(comparison == MemoryComparison::LessThan) { return _mm512_cmp_pd_mask(x, _mm512_castsi512_pd(low), _CMP_LT_OQ); }
+            else if constexpr(comparison == MemoryComparison::GreaterThan) { return _mm512_cmp_pd_mask(x, _mm512_castsi512_pd(high), _CMP_GT_OQ); }
+            else if constexpr(comparison == MemoryComparison::LessThanEquals) { return _mm512_cmp_pd_mask(x, _mm512_castsi512_pd(high), _CMP_LE_OQ); }
+            else { return _mm512_cmp_pd_mask(x, _mm512_castsi512_pd(low), _CMP_GE_OQ); }
+        }
+        else {
+            // Integers compare exactly, so the bound on the side of the comparison is enough
+            constexpr Boolean lowSide = (comparison == MemoryComparison::LessThan) || (comparison == MemoryComparison::GreaterThanEquals);
+            return CompareMask<T, comparison>(a, lowSide ? low : high);
+        }
+    }
+};
+
+MEMORYMODDER_DEFINE_KERNELS(Sse2, "sse2")
+MEMORYMODDER_DEFINE_KERNELS(Avx2, "avx2")
+MEMORYMODDER_DEFINE_KERNELS(Avx512, "avx512f,avx512bw,bmi2")
+
+#endif
+
+/// <returns>The kernel for the best instruction set of this CPU.</returns>
+/// <param name="aligned">If true, values are <code>sizeof(T)</code> bytes apart. Otherwise values start at every byte.</param>
+template<typename T, MemoryComparison comparison>
+CompareKernel<T> GetCompareKernel(Boolean const aligned, InstructionSet const instructionSet = GetInstructionSet()) {
+    // A stride of 1 byte is always aligned for single byte values
+    Boolean const isAligned = aligned || (sizeof(T) == 1);
+
+#if defined(MEMORYMODDER_X86)
+    switch(instructionSet) {
+    case InstructionSet::Avx512: return isAligned ? &CompareAlignedAvx512<T, comparison> : &CompareUnalignedAvx512<T, comparison>;
+    case InstructionSet::Avx2: return isAligned ? &CompareAlignedAvx2<T, comparison> : &CompareUnalignedAvx2<T, comparison>;
+    case InstructionSet::Sse2: return isAligned ? &CompareAlignedSse2<T, comparison> : &CompareUnalignedSse2<T, comparison>;
+    default: break;
+    }
+#endif
+
+    return isAligned ? &CompareScalar<T, comparison, true> : &CompareScalar<T, comparison, false>;
+}
+
+/// <returns>The range kernel for the best instruction set of this CPU, see GetCompareKernel.</returns>
+template<typename T, MemoryComparison comparison>
+CompareRangeKernel<T> GetCompareRangeKernel(Boolean const aligned, InstructionSet const instructionSet = GetInstructionSet()) {
+    Boolean const isAligned = aligned || (sizeof(T) == 1);
+
+#if defined(MEMORYMODDER_X86)
+    switch(instructionSet) {
+    case InstructionSet::Avx512: return isAligned ? &CompareRangeAlignedAvx512<T, comparison> : &CompareRangeUnalignedAvx512<T, comparison>;
+    case InstructionSet::Avx2: return isAligned ? &CompareRangeAlignedAvx2<T, comparison> : &CompareRangeUnalignedAvx2<T, comparison>;
+    case InstructionSet::Sse2: return isAligned ? &CompareRangeAlignedSse2<T, comparison> : &CompareRangeUnalignedSse2<T, comparison>;
+    default: break;
+    }
+#endif
+
+    return isAligned ? &CompareRangeScalar<T, comparison, true> : &CompareRangeScalar<T, comparison, false>;
+}
+
+/// <summary>
+/// <para>Compares count values with the filter and calls match(index) for every value that compares true, in ascending order.</para>
+/// <para>With a stride of <code>sizeof(T)</code> value i is at data + i * sizeof(T), with a stride of 1 value i is at data + i.</para>
+/// </summary>
+template<typename T, MemoryComparison comparison, typename Match>
+inline void CompareValues(UInt8 const* data, SizeT const count, SizeT const stride, T const filter, Match&& match) {
+    if((stride != sizeof(T)) && (stride != 1)) {
+        for(SizeT i = 0; i < count; ++i) {
+            if(Compare<T, comparison>(LoadValue<T>(data + (i * stride)), filter)) {
+                match(i);
+            }
+        }
+        return;
+    }
+
+    static CompareKernel<T> const alignedKernel = GetCompareKernel<T, comparison>(true);
+    static CompareKernel<T> const unalignedKernel = GetCompareKernel<T, comparison>(false);
+    CompareKernel<T> const kernel = (stride == sizeof(T)) ? alignedKernel : unalignedKernel;
+
+    // Small batches keep the masks on the stack and the values in cache
+    constexpr SizeT batchSize = 4096;
+    UInt64 masks[batchSize / 64];
+
+    for(SizeT batch = 0; batch < count; batch += batchSize) {
+        SizeT const batchCount = min(batchSize, count - batch);
+        kernel(data + (batch * stride), batchCount, filter, masks);
+
+        for(SizeT word = 0, words = (batchCount + 63) / 64; word < words; ++word) {
+            for(UInt64 mask = masks[word]; mask != 0; mask &= (mask - 1)) {
+                match(batch + (word * 64) + static_cast<SizeT>(std::countr_zero(mask)));
+            }
+        }
+    }
+}
+
+/// <summary>Writes one bit per byte to masks, bit i of masks[i / 64] is set if byte i of a and b differ, a and b hold count bytes.</summary>
+using DiffKernel = void (*)(UInt8 const* a, UInt8 const* b, SizeT count, UInt64* masks);
+
+inline void DiffScalar(UInt8 const* a, UInt8 const* b, SizeT const count, UInt64* masks) {
+    memset(masks, 0, ((count + 63) / 64) * sizeof(UInt64));
+    for(SizeT i = 0; i < count; i += 64) {
+        SizeT const blockSize = min(static_cast<SizeT>(64), count - i);
+        if(memcmp(a + i, b + i, blockSize) == 0) {
+            continue;
+        }
+
+        for(SizeT j = 0; j < blockSize; ++j) {
+            if(a[i + j] != b[i + j]) {
+                masks[i / 64] |= static_cast<UInt64>(1) << j;
+            }
+        }
+    }
+}
+
+#if defined(MEMORYMODDER_X86)
+
+/// <summary>Compares the bytes from start on, after the last whole block of 64 bytes.</summary>
+inline void DiffTail(UInt8 const* a, UInt8 const* b, SizeT const start, SizeT const count, UInt64* masks) {
+    if(start < count) {
+        DiffScalar(a + start, b + start, count - start, masks + (start / 64));
+    }
+}
+
+MEMORYMODDER_TARGET("sse2") inline void DiffSse2(UInt8 const* a, UInt8 const* b, SizeT const count, UInt64* masks) {
+    SizeT i = 0;
+    for(; (i + 64) <= count; i += 64) {
+        UInt64 mask = 0;
+        for(SizeT j = 0; j < 64; j += 16) {
+            __m128i const equal = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const*>(a + i + j)), _mm_loadu_si128(reinterpret_cast<__m128i const*>(b + i + j)));
+            mask |= static_cast<UInt64>(static_cast<UInt32>(_mm_movemask_epi8(equal)) ^ 0xFFFF) << j;
+        }
+        masks[i / 64] = mask;
+    }
+    DiffTail(a, b, i, count, masks);
+}
+
+MEMORYMODDER_TARGET("avx2") inline void DiffAvx2(UInt8 const* a, UInt8 const* b, SizeT const count, UInt64* masks) {
+    SizeT i = 0;
+    for(; (i + 64) <= count; i += 64) {
+        __m256i const low = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + i)), _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b + i)));
+        __m256i const high = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + i + 32)), _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b + i + 32)));
+        UInt64 const equal = static_cast<UInt64>(static_cast<UInt32>(_mm256_movemask_epi8(low))) | (static_cast<UInt64>(static_cast<UInt32>(_mm256_movemask_epi8(high))) << 32);
+        masks[i / 64] = ~equal;
+    }
+    DiffTail(a, b, i, count, masks);
+}
+
+MEMORYMODDER_TARGET("avx512f,avx512bw,bmi2") inline void DiffAvx512(UInt8 const* a, UInt8 const* b, SizeT const count, UInt64* masks) {
+    SizeT i = 0;
+    for(; (i + 64) <= count; i += 64) {
+        masks[i / 64] = static_cast<UInt64>(_mm512_cmpneq_epi8_mask(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i)));
+    }
+    DiffTail(a, b, i, count, masks);
+}
+
+#endif
+
+/// <returns>The diff kernel for the best instruction set of this CPU.</returns>
+inline DiffKernel GetDiffKernel(InstructionSet const instructionSet = GetInstructionSet()) {
+#if defined(MEMORYMODDER_X86)
+    switch(instructionSet) {
+    case InstructionSet::Avx512: return &DiffAvx512;
+    case InstructionSet::Avx2: return &DiffAvx2;
+    case InstructionSet::Sse2: return &DiffSse2;
+    default: break;
+    }
+#endif
+
+    return &DiffScalar;
+}
+
+/// <summary>Compares count bytes of a and b and calls run(SizeT start, SizeT end) for every run of bytes that differ, in ascending order. Blocks of equal bytes cost a single compare.</summary>
+template<typename Run>
+inline void DiffBytes(UInt8 const* a, UInt8 const* b, SizeT const count, Run&& run) {
+    static DiffKernel const kernel = GetDiffKernel();
+
+    constexpr SizeT batchSize = 4096;
+    UInt64 masks[batchSize / 64];
+
+    SizeT runStart = 0;
+    Boolean inRun = false;
+    for(SizeT batch = 0; batch < count; batch += batchSize) {
+        SizeT const batchCount = min(batchSize, count - batch);
+        kernel(a + batch, b + batch, batchCount, masks);
+
+        for(SizeT word = 0, words = (batchCount + 63) / 64; word < words; ++word) {
+            UInt64 const mask = masks[word];
+            SizeT const base = batch + (word * 64);
+            SizeT const bits = min(static_cast<SizeT>(64), batchCount - (word * 64));
+
+            // Jump from one end of a run to the next, a word without a change inside is done in one step
+            for(SizeT bit = 0; bit < bits;) {
+                UInt64 const rest = (inRun ? ~mask : mask) >> bit;
+                bit += min(static_cast<SizeT>(std::countr_zero(rest)), bits - bit);
+                if(bit < bits) {
+                    if(inRun) {
+                        run(runStart, base + bit);
+                    }
+                    else {
+                        runStart = base + bit;
+                    }
+                    inRun = !inRun;
+                }
+            }
+        }
+    }
+
+    if(inRun) {
+        run(runStart, count);
+    }
+}
+
+/// <summary>Compares count values with a range of equal values like CompareValues, see CompareRange.</summary>
+template<typename T, MemoryComparison comparison, typename Match>
+inline void CompareRangeValues(UInt8 const* data, SizeT const count, SizeT const stride, T const low, T const high, Match&& match) {
+    if((stride != sizeof(T)) && (stride != 1)) {
+        for(SizeT i = 0; i < count; ++i) {
+            if(CompareRange<T, comparison>(LoadValue<T>(data + (i * stride)), low, high)) {
+                match(i);
+            }
+        }
+        return;
+    }
+
+    static CompareRangeKernel<T> const alignedKernel = GetCompareRangeKernel<T, comparison>(true);
+    static CompareRangeKernel<T> const unalignedKernel = GetCompareRangeKernel<T, comparison>(false);
+    CompareRangeKernel<T> const kernel = (stride == sizeof(T)) ? alignedKernel : unalignedKernel;
+
+    constexpr SizeT batchSize = 4096;
+    UInt64 masks[batchSize / 64];
+
+    for(SizeT batch = 0; batch < count; batch += batchSize) {
+        SizeT const batchCount = min(batchSize, count - batch);
+        kernel(data + (batch * stride), batchCount, low, high, masks);
+
+        for(SizeT word = 0, words = (batchCount + 63) / 64; word < words; ++word) {
+            for(UInt64 mask = masks[word]; mask != 0; mask &= (mask - 1)) {
+                match(batch + (word * 64) + static_cast<SizeT>(std::countr_zero(mask)));
+            }
+        }
+    }
+}
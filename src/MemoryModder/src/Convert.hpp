@@ -7,7 +7,7 @@
 template<typename T>
 constexpr String ToString(T value, int modifiers = 0) {
     std::stringstream stream = std::stringstream();
-    stream.flags(modifiers);
+    stream.flags(static_cast<std::ios_base::fmtflags>(modifiers));
     stream << value;
     String string;
     stream >> string;
@@ -33,7 +33,7 @@ constexpr T FromString(String string, int modifiers = 0) {
     std::stringstream stream = std::stringstream();
     stream << string;
     T value;
-    stream.flags(modifiers);
+    stream.flags(static_cast<std::ios_base::fmtflags>(modifiers));
     stream >> value;
 
     if(stream.bad() || stream.fail()) {
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "Types.hpp"
+#include "Platform.hpp"
+
+/// <summary>
+/// <para>The pages of a process that were written since they were last cleared, as ascending ranges that do not touch.</para>
+/// <para>Values on clean pages are still what they were when the pages were cleared, so they do not have to be read again.</para>
+/// </summary>
+struct DirtyPages {
+private:
+    struct DirtyRange {
+    public:
+        DirtyRange(SizeT const _start, SizeT const _end) {
+            start = _start;
+            end = _end;
+        }
+
+        SizeT start;
+        SizeT end;
+    };
+
+public:
+    inline void Clear() noexcept {
+        _ranges.clear();
+    }
+
+    /// <summary>Marks the pages from start to end as dirty, ranges MUST be added in ascending order.</summary>
+    inline void AddRange(SizeT const start, SizeT const end) {
+        if(!_ranges.empty() && (_ranges.back().end >= start)) {
+            _ranges.back().end = max(_ranges.back().end, end);
+            return;
+        }
+        _ranges.push_back(DirtyRange(start, end));
+    }
+
+    /// <returns>The number of dirty bytes.</returns>
+    SizeT GetSize() const noexcept {
+        SizeT size = 0;
+        for(DirtyRange const& range : _ranges) {
+            size += range.end - range.start;
+        }
+        return size;
+    }
+
+    /// <summary>Calls visitor(SizeT start, SizeT end) for every dirty range overlapping start to end, cut to it, ascending.</summary>
+    template<typename Visitor>
+    void ForEachRange(SizeT const start, SizeT const end, Visitor&& visitor) const {
+        typename std::vector<DirtyRange>::const_iterator it = std::upper_bound(_ranges.begin(), _ranges.end(), start, [](SizeT const address, DirtyRange const& range) {
+            return address < range.end;
+        });
+
+        for(; (it != _ranges.end()) && (it->start < end); ++it) {
+            visitor(max(it->start, start), min(it->end, end));
+        }
+    }
+
+private:
+    std::vector<DirtyRange> _ranges = std::vector<DirtyRange>();
+};
@@ -0,0 +1,546 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Types.hpp"
+#include "Platform.hpp"
+#include "DirtyPages.hpp"
+#include "MemoryList.hpp"
+#include "Module.hpp"
+#include "Process.hpp"
+#include "PageCodec.hpp"
+#include "ReadRequest.hpp"
+#include "RegionMap.hpp"
+
+/// <summary>
+/// <para>The memory of a process as it was when Save wrote it to a dump file, read-only, so searches can run later or on another machine.</para>
+/// <para>A dump holds a header, the modules, a region table and the pages of every region. Pages filled with one repeated 4 byte value, like zero pages, take no space.</para>
+/// <para>The other pages of a region are compressed on their own with PageCodec, so any page is read without the rest of its region. Pages that do not get smaller, or every page of an uncompressed dump, are stored as they are and read in place.</para>
+/// <para>The file is mapped as a whole, so reads from any number of threads are plain copies.</para>
+/// </summary>
+struct DumpMemory {
+private:
+    /// <summary>An entry of the region table, written to the file as it is.</summary>
+    struct DumpRegion {
+    public:
+        DumpRegion(UInt64 const _start, UInt64 const _size, UInt32 const _protection, UInt32 const _type, UInt32 const _module) {
+            start = _start;
+            size = _size;
+            protection = _protection;
+            type = _type;
+            module = _module;
+        }
+
+        inline UInt64 GetEnd() const noexcept {
+            return start + size;
+        }
+
+        UInt64 start;
+        UInt64 size;
+        // PAGE_ flags
+        UInt32 protection;
+        // MEM_PRIVATE, MEM_MAPPED or MEM_IMAGE
+        UInt32 type;
+        // Index of the module holding the region, or NoModule
+        UInt32 module;
+        UInt32 reserved = 0;
+        // File offset of the page table, one entry for every page of the region
+        UInt64 pages = 0;
+        // File offset of the stored pages, page table entries count from here
+        UInt64 data = 0;
+    };
+
+public:
+    /// <summary>
+    /// <para>Opens the dump at path.</para>
+    /// <para>Possible exceptions:</para>
+    /// <para>(Int8)1: The file cannot be read or is not a dump of this pointer size.</para>
+    /// </summary>
+    DumpMemory(String const& path) {
+#if defined(_WIN32)
+        _file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        LARGE_INTEGER size;
+        if((_file == INVALID_HANDLE_VALUE) || (GetFileSizeEx(_file, &size) == FALSE) || (size.QuadPart == 0)) {
+            Close();
+            SetLastError(NULL);
+            throw (Int8)1;
+        }
+        _size = static_cast<SizeT>(size.QuadPart);
+
+        _mapping = CreateFileMappingA(_file, NULL, PAGE_READONLY, 0, 0, NULL);
+        _view = (_mapping != NULL) ? static_cast<UInt8 const*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+        SetLastError(NULL);
+#else
+        _file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat status;
+        if((_file < 0) || (fstat(_file, &status) != 0) || (status.st_size == 0)) {
+            Close();
+            throw (Int8)1;
+        }
+        _size = static_cast<SizeT>(status.st_size);
+
+        void* view = mmap(nullptr, _size, PROT_READ, MAP_SHARED, _file, 0);
+        _view = (view != MAP_FAILED) ? static_cast<UInt8 const*>(view) : nullptr;
+#endif
+
+        if(_view == nullptr) {
+            Close();
+            throw (Int8)1;
+        }
+
+        try {
+            Parse();
+        }
+        catch(Int8) {
+            Close();
+            throw;
+        }
+    }
+
+    DumpMemory(DumpMemory const&) = delete;
+    DumpMemory& operator=(DumpMemory const&) = delete;
+
+    ~DumpMemory() {
+        Close();
+    }
+
+    /// <summary>
+    /// <para>Writes every readable region of memory to a dump at path, pages that cannot be read are left out.</para>
+    /// <para>The process keeps running while it is written, so values of different regions may be from slightly different times.</para>
+    /// <para>Possible exceptions:</para>
+    /// <para>(Int8)1: The file cannot be written.</para>
+    /// </summary>
+    /// <param name="compress">If true, pages are compressed, otherwise every page is stored as it is on a page boundary, which writes faster and reads with a single copy.</param>
+    template<typename Memory>
+    static void Save(Memory const& memory, String const& path, Boolean const compress = true) {
+        std::ofstream file = std::ofstream(path, std::ios_base::binary | std::ios_base::trunc);
+
+        std::vector<Module> const modules = memory.GetModules();
+        std::vector<DumpRegion> regions = std::vector<DumpRegion>();
+
+        RegionPolicy const policy = RegionPolicy::Readable(MEM_PRIVATE | MEM_MAPPED | MEM_IMAGE);
+        memory.ForEachRegion([&policy, &modules, &regions](RegionInfo const& region) {
+            if(!policy.Allows(region)) {
+                return;
+            }
+
+            UInt32 module = NoModule;
+            for(SizeT i = 0; i < modules.size(); ++i) {
+                if(modules[i].IsInside(region.start)) {
+                    module = static_cast<UInt32>(i);
+                    break;
+                }
+            }
+
+            regions.push_back(DumpRegion(region.start, region.size, region.protection, region.type, module));
+        });
+
+        WriteValue<UInt32>(file, FileMagic);
+        WriteValue<UInt32>(file, FileVersion);
+        WriteValue<UInt32>(file, static_cast<UInt32>(sizeof(SizeT)));
+        WriteValue<UInt32>(file, static_cast<UInt32>(PageSize));
+        WriteValue<UInt64>(file, memory.GetProcessId());
+        WriteValue<UInt64>(file, memory.GetBaseAddress());
+        WriteString(file, memory.GetProcessName());
+
+        WriteValue<UInt64>(file, modules.size());
+        for(Module const& module : modules) {
+            WriteString(file, module.GetName());
+            WriteValue<UInt64>(file, module.GetBase());
+            WriteValue<UInt64>(file, module.GetSize());
+        }
+
+        // The table is written again once the offsets of the pages are known
+        WriteValue<UInt64>(file, regions.size());
+        std::streamoff const tableOffset = static_cast<std::streamoff>(file.tellp());
+        WriteRegions(file, regions);
+
+        std::vector<UInt64> pages = std::vector<UInt64>();
+        std::vector<UInt8> buffer = std::vector<UInt8>(ChunkSize);
+        std::vector<UInt8> block = std::vector<UInt8>(PageSize);
+
+        for(DumpRegion& region : regions) {
+            // Uncompressed pages start on a page boundary, so they stay aligned in the mapped file
+            if(!compress) {
+                Pad(file, PageSize);
+            }
+            region.data = static_cast<UInt64>(file.tellp());
+            region.pages = pages.size();
+
+            UInt64 storedSize = 0;
+            for(SizeT chunk = static_cast<SizeT>(region.start), end = static_cast<SizeT>(region.GetEnd()); (chunk < end) && file; chunk += ChunkSize) {
+                SizeT const chunkSize = min(ChunkSize, end - chunk);
+                SizeT const sizeRead = memory.Read(chunk, chunkSize, buffer.data());
+
+                for(SizeT offset = 0; offset < chunkSize; offset += PageSize) {
+                    SizeT const pageSize = min(PageSize, chunkSize - offset);
+                    UInt8* page = buffer.data() + offset;
+
+                    // A chunk cut short is read again page by page from where it stopped
+                    if(((offset + pageSize) > sizeRead) && (memory.Read(chunk + offset, pageSize, page) != pageSize)) {
+                        pages.push_back(MissingPage);
+                        continue;
+                    }
+
+                    // The page repeats its first 4 bytes if it equals itself shifted by 4 bytes
+                    if(((pageSize % sizeof(UInt32)) == 0) && (memcmp(page, page + sizeof(UInt32), pageSize - sizeof(UInt32)) == 0)) {
+                        UInt32 fill;
+                        memcpy(&fill, page, sizeof(UInt32));
+                        pages.push_back(FilledPage | fill);
+                        continue;
+                    }
+
+                    memset(page + pageSize, 0, PageSize - pageSize);
+
+                    // A compressed page is its size and the block, and only kept if that is smaller than the page
+                    SizeT const blockSize = compress ? PageCodec::Compress(page, PageSize, block.data(), PageSize - sizeof(UInt16)) : 0;
+                    if(blockSize != 0) {
+                        WriteValue<UInt16>(file, static_cast<UInt16>(blockSize));
+                        file.write(reinterpret_cast<char const*>(block.data()), static_cast<std::streamsize>(blockSize));
+                        pages.push_back(CompressedPage | storedSize);
+                        storedSize += sizeof(UInt16) + blockSize;
+                        continue;
+                    }
+
+                    file.write(reinterpret_cast<char const*>(page), static_cast<std::streamsize>(PageSize));
+                    pages.push_back(StoredPage | storedSize);
+                    storedSize += PageSize;
+                }
+            }
+        }
+
+        Pad(file, sizeof(UInt64));
+        UInt64 const pagesOffset = static_cast<UInt64>(file.tellp());
+        file.write(reinterpret_cast<char const*>(pages.data()), static_cast<std::streamsize>(pages.size() * sizeof(UInt64)));
+
+        for(DumpRegion& region : regions) {
+            region.pages = pagesOffset + (region.pages * sizeof(UInt64));
+        }
+        file.seekp(tableOffset);
+        WriteRegions(file, regions);
+
+        if(!file) {
+            throw (Int8)1;
+        }
+    }
+
+    /// <summary>A dump is not a running process.</summary>
+    /// <returns>Always empty.</returns>
+    static std::vector<Process> GetProcesses() {
+        return std::vector<Process>();
+    }
+
+    /// <returns>The id the process had when it was dumped.</returns>
+    SizeT GetProcessId() const {
+        return _processId;
+    }
+
+    String GetProcessName() const {
+        return _processName;
+    }
+
+    SizeT GetBaseAddress() const {
+        return _processBaseAddress;
+    }
+
+    /// <returns>Every module loaded into the process when it was dumped, the executable first.</returns>
+    std::vector<Module> GetModules() const {
+        return _modules;
+    }
+
+    /// <summary>Calls visitor(RegionInfo const& region) for every region in the dump, ascending.</summary>
+    template<typename Visitor>
+    void ForEachRegion(Visitor&& visitor) const {
+        for(DumpRegion const& region : _regions) {
+            visitor(RegionInfo(static_cast<SizeT>(region.start), static_cast<SizeT>(region.size), region.protection, region.type));
+        }
+    }
+
+    /// <returns>The module holding the region starting at start, or nullptr if there is none.</returns>
+    Module const* GetRegionModule(SizeT const start) const {
+        std::vector<DumpRegion>::const_iterator const region = FindRegion(start);
+        if((region == _regions.end()) || (region->start != start) || (region->module == NoModule)) {
+            return nullptr;
+        }
+        return &_modules[region->module];
+    }
+
+    /// <returns>The number of bytes read from address on, fewer than size if the range runs into memory that is not in the dump, or 0 if the read failed.</returns>
+    inline SizeT Read(SizeT const address, SizeT const size, UInt8* data) const {
+        std::vector<DumpRegion>::const_iterator region = FindRegion(address);
+
+        SizeT sizeRead = 0;
+        while(sizeRead < size) {
+            SizeT const current = address + sizeRead;
+            if((region == _regions.end()) || (current < region->start)) {
+                break;
+            }
+            if(current >= region->GetEnd()) {
+                // Regions next to each other are read as one range
+                ++region;
+                continue;
+            }
+
+            SizeT const offset = current - static_cast<SizeT>(region->start);
+            SizeT const pageOffset = offset % PageSize;
+            SizeT const length = min(min(PageSize - pageOffset, size - sizeRead), static_cast<SizeT>(region->GetEnd()) - current);
+            UInt64 const entry = reinterpret_cast<UInt64 const*>(_view + region->pages)[offset / PageSize];
+
+            if((entry & PageKindMask) == MissingPage) {
+                break;
+            }
+            else if((entry & PageKindMask) == FilledPage) {
+                UInt32 const fill = static_cast<UInt32>(entry);
+                if(fill == 0) {
+                    memset(data + sizeRead, 0, length);
+                }
+                else {
+                    UInt8 const* fillBytes = reinterpret_cast<UInt8 const*>(&fill);
+                    for(SizeT i = 0; i < length; ++i) {
+                        data[sizeRead + i] = fillBytes[(pageOffset + i) % sizeof(UInt32)];
+                    }
+                }
+            }
+            else if((entry & PageKindMask) == CompressedPage) {
+                UInt8 const* stored = _view + region->data + (entry & ~PageKindMask);
+                UInt16 blockSize;
+                memcpy(&blockSize, stored, sizeof(UInt16));
+
+                // Pages read as a whole skip the copy
+                UInt8 page[PageSize];
+                UInt8* target = (length == PageSize) ? (data + sizeRead) : page;
+                if(!PageCodec::Decompress(stored + sizeof(UInt16), blockSize, target, PageSize)) {
+                    break;
+                }
+                if(target == page) {
+                    memcpy(data + sizeRead, page + pageOffset, length);
+                }
+            }
+            else {
+                memcpy(data + sizeRead, _view + region->data + (entry & ~PageKindMask) + pageOffset, length);
+            }
+
+            sizeRead += length;
+        }
+
+        return sizeRead;
+    }
+
+    inline void ReadBatch(ReadRequest* requests, SizeT const count) const {
+        for(SizeT i = 0; i < count; ++i) {
+            requests[i].sizeRead = Read(requests[i].address, requests[i].size, requests[i].data);
+        }
+    }
+
+    /// <summary>A dump is read-only.</summary>
+    /// <returns>Always 0.</returns>
+    inline SizeT Write(SizeT const, SizeT const, UInt8 const*) const {
+        return 0;
+    }
+
+    /// <summary>A dump never changes, but there is no previous read to compare with either.</summary>
+    /// <returns>Always false.</returns>
+    inline Boolean ClearDirtyPages() const noexcept {
+        return false;
+    }
+
+    /// <returns>Always false, see ClearDirtyPages.</returns>
+    template<typename T>
+    inline Boolean ReadDirtyPages(MemoryList<T> const&, SizeT const, DirtyPages& dirtyPages) const {
+        dirtyPages.Clear();
+        return false;
+    }
+
+private:
+    static constexpr UInt32 FileMagic = 0x444D4D4D;
+    static constexpr UInt32 FileVersion = 2;
+
+    static constexpr SizeT PageSize = 0x1000;
+    // Bytes read from the process with one call while saving
+    static constexpr SizeT ChunkSize = 0x100000;
+    static constexpr UInt32 NoModule = ~static_cast<UInt32>(0);
+
+    // Page table entries, the kind is in the top 2 bits
+    // The offset of the page from the stored pages of its region
+    static constexpr UInt64 StoredPage = 0;
+    // The low 4 bytes repeated over the whole page
+    static constexpr UInt64 FilledPage = static_cast<UInt64>(1) << 62;
+    // The page could not be read when the dump was written
+    static constexpr UInt64 MissingPage = static_cast<UInt64>(2) << 62;
+    // The offset of the UInt16 size and the PageCodec block of the page from the stored pages of its region
+    static constexpr UInt64 CompressedPage = static_cast<UInt64>(3) << 62;
+    static constexpr UInt64 PageKindMask = static_cast<UInt64>(3) << 62;
+
+    /// <returns>The last region starting at or before address, or the end if there is none.</returns>
+    inline std::vector<DumpRegion>::const_iterator FindRegion(SizeT const address) const {
+        std::vector<DumpRegion>::const_iterator region = std::upper_bound(_regions.begin(), _regions.end(), address, [](SizeT const value, DumpRegion const& other) {
+            return value < other.start;
+        });
+        return (region == _regions.begin()) ? _regions.end() : (region - 1);
+    }
+
+    /// <summary>Reads the header and tables, and checks that every page they point to is inside the file.</summary>
+    void Parse() {
+        SizeT offset = 0;
+
+        UInt32 const magic = TakeValue<UInt32>(offset);
+        UInt32 const version = TakeValue<UInt32>(offset);
+        UInt32 const pointerSize = TakeValue<UInt32>(offset);
+        UInt32 const pageSize = TakeValue<UInt32>(offset);
+        if((magic != FileMagic) || (version != FileVersion) || (pointerSize != sizeof(SizeT)) || (pageSize != PageSize)) {
+            throw (Int8)1;
+        }
+
+        _processId = static_cast<SizeT>(TakeValue<UInt64>(offset));
+        _processBaseAddress = static_cast<SizeT>(TakeValue<UInt64>(offset));
+        _processName = TakeString(offset);
+
+        UInt64 const moduleCount = TakeValue<UInt64>(offset);
+        for(UInt64 i = 0; i < moduleCount; ++i) {
+            String const name = TakeString(offset);
+            SizeT const base = static_cast<SizeT>(TakeValue<UInt64>(offset));
+            SizeT const size = static_cast<SizeT>(TakeValue<UInt64>(offset));
+            _modules.push_back(Module(name, base, size));
+        }
+
+        UInt64 const regionCount = TakeValue<UInt64>(offset);
+        if(regionCount > ((_size - offset) / sizeof(DumpRegion))) {
+            throw (Int8)1;
+        }
+        DumpRegion const* regions = reinterpret_cast<DumpRegion const*>(Take(offset, static_cast<SizeT>(regionCount) * sizeof(DumpRegion)));
+        // The table may not be aligned, so it is copied out of the file
+        std::vector<UInt8> table = std::vector<UInt8>(reinterpret_cast<UInt8 const*>(regions), reinterpret_cast<UInt8 const*>(regions + regionCount));
+        _regions.assign(reinterpret_cast<DumpRegion const*>(table.data()), reinterpret_cast<DumpRegion const*>(table.data()) + regionCount);
+
+        UInt64 previousEnd = 0;
+        for(DumpRegion const& region : _regions) {
+            UInt64 const pageCount = (region.size + PageSize - 1) / PageSize;
+            if((region.start < previousEnd) || (region.GetEnd() < region.start) || ((region.module != NoModule) && (region.module >= _modules.size()))
+                || ((region.pages % sizeof(UInt64)) != 0) || (region.pages > _size) || (pageCount > ((_size - region.pages) / sizeof(UInt64)))
+                || (region.data > _size)) {
+                throw (Int8)1;
+            }
+            previousEnd = region.GetEnd();
+
+            UInt64 const storedSize = _size - region.data;
+            UInt64 const* pages = reinterpret_cast<UInt64 const*>(_view + region.pages);
+            for(UInt64 i = 0; i < pageCount; ++i) {
+                UInt64 const kind = pages[i] & PageKindMask;
+                UInt64 const stored = pages[i] & ~PageKindMask;
+                if((kind == StoredPage) && ((stored > storedSize) || (PageSize > (storedSize - stored)))) {
+                    throw (Int8)1;
+                }
+                if(kind == CompressedPage) {
+                    UInt16 blockSize = 0;
+                    if((stored > storedSize) || (sizeof(UInt16) > (storedSize - stored))) {
+                        throw (Int8)1;
+                    }
+                    memcpy(&blockSize, _view + region.data + stored, sizeof(UInt16));
+                    if((sizeof(UInt16) + blockSize) > (storedSize - stored)) {
+                        throw (Int8)1;
+                    }
+                }
+            }
+        }
+    }
+
+    /// <returns>The size bytes at offset, which is moved past them.</returns>
+    inline UInt8 const* Take(SizeT& offset, SizeT const size) const {
+        if((offset > _size) || (size > (_size - offset))) {
+            throw (Int8)1;
+        }
+        UInt8 const* data = _view + offset;
+        offset += size;
+        return data;
+    }
+
+    template<typename V>
+    inline V TakeValue(SizeT& offset) const {
+        V value;
+        memcpy(&value, Take(offset, sizeof(V)), sizeof(V));
+        return value;
+    }
+
+    inline String TakeString(SizeT& offset) const {
+        UInt64 const length = TakeValue<UInt64>(offset);
+        if(length > (_size - offset)) {
+            throw (Int8)1;
+        }
+        return String(reinterpret_cast<char const*>(Take(offset, static_cast<SizeT>(length))), static_cast<SizeT>(length));
+    }
+
+    template<typename V>
+    static inline void WriteValue(std::ofstream& file, V const value) {
+        file.write(reinterpret_cast<char const*>(&value), sizeof(V));
+    }
+
+    static inline void WriteString(std::ofstream& file, String const& string) {
+        WriteValue<UInt64>(file, string.length());
+        file.write(string.data(), static_cast<std::streamsize>(string.length()));
+    }
+
+    static inline void WriteRegions(std::ofstream& file, std::vector<DumpRegion> const& regions) {
+        file.write(reinterpret_cast<char const*>(regions.data()), static_cast<std::streamsize>(regions.size() * sizeof(DumpRegion)));
+    }
+
+    /// <summary>Writes zeros up to the next multiple of alignment.</summary>
+    static void Pad(std::ofstream& file, SizeT const alignment) {
+        SizeT const position = static_cast<SizeT>(file.tellp());
+        SizeT const padding = (alignment - (position % alignment)) % alignment;
+        for(SizeT i = 0; i < padding; ++i) {
+            file.put('\0');
+        }
+    }
+
+    void Close() {
+#if defined(_WIN32)
+        if(_view != nullptr) {
+            UnmapViewOfFile(_view);
+        }
+        if(_mapping != NULL) {
+            CloseHandle(_mapping);
+        }
+        if(_file != INVALID_HANDLE_VALUE) {
+            CloseHandle(_file);
+        }
+        _mapping = NULL;
+        _file = INVALID_HANDLE_VALUE;
+#else
+        if(_view != nullptr) {
+            munmap(const_cast<UInt8*>(_view), _size);
+        }
+        if(_file >= 0) {
+            close(_file);
+        }
+        _file = -1;
+#endif
+        _view = nullptr;
+    }
+
+#if defined(_WIN32)
+    HANDLE _file = INVALID_HANDLE_VALUE;
+    HANDLE _mapping = NULL;
+#else
+    int _file = -1;
+#endif
+    UInt8 const* _view = nullptr;
+    SizeT _size = 0;
+
+    SizeT _processId = 0;
+    String _processName = String();
+    SizeT _processBaseAddress = 0;
+    std::vector<Module> _modules = std::vector<Module>();
+    std::vector<DumpRegion> _regions = std::vector<DumpRegion>();
+};
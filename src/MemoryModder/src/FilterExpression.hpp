@@ -0,0 +1,385 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include "Types.hpp"
+#include "Platform.hpp"
+#include "Compare.hpp"
+#include "CompareKernels.hpp"
+#include "Convert.hpp"
+#include "StringUtils.hpp"
+
+/// <summary>What the current value of an address is compared with.</summary>
+enum struct FilterOperand : Int8 {
+    // A value typed in
+    Value = 0,
+    // The previous value of the address plus a difference
+    Previous = 1
+};
+
+/// <summary>
+/// <para>Filters made of several comparisons, e.g. "between 90 and 110", "== 100 or == 250" or "&gt; 0 and != previous".</para>
+/// <para>An expression is a list of clauses joined by or, every clause is a list of predicates joined by and.</para>
+/// <para>Every predicate is compiled into a kernel of the Compare family, and all of them run on the same batch of values, so every value is read only once no matter how many predicates there are.</para>
+/// <para>Floats compared with a value use the range of floats equal to it under the tolerance of the expression, see FloatTolerance.</para>
+/// </summary>
+template<typename T>
+struct FilterExpression {
+private:
+    /// <summary>Writes one bit per value to masks like CompareKernel, for any stride. Compares with previousValues plus value unless previousValues is null.</summary>
+    using ScalarKernel = void (*)(UInt8 const* data, SizeT count, SizeT stride, T const* previousValues, T value, UInt64* masks);
+    /// <summary>Writes one bit per value to masks like CompareRangeKernel, for any stride.</summary>
+    using ScalarRangeKernel = void (*)(UInt8 const* data, SizeT count, SizeT stride, T low, T high, UInt64* masks);
+
+    struct FilterPredicate {
+    public:
+        FilterPredicate(MemoryComparison const _comparison, FilterOperand const _operand, T const _value, CompareKernel<T> const _alignedKernel, CompareKernel<T> const _unalignedKernel, ScalarKernel const _scalarKernel) {
+            comparison = _comparison;
+            operand = _operand;
+            value = _value;
+            alignedKernel = _alignedKernel;
+            unalignedKernel = _unalignedKernel;
+            scalarKernel = _scalarKernel;
+        }
+
+        /// <summary>A predicate comparing with a range of equal values instead of a single value.</summary>
+        FilterPredicate(MemoryComparison const _comparison, T const _value, T const _low, T const _high, CompareRangeKernel<T> const _alignedRangeKernel, CompareRangeKernel<T> const _unalignedRangeKernel, ScalarRangeKernel const _scalarRangeKernel) {
+            comparison = _comparison;
+            operand = FilterOperand::Value;
+            value = _value;
+            ranged = true;
+            low = _low;
+            high = _high;
+            alignedRangeKernel = _alignedRangeKernel;
+            unalignedRangeKernel = _unalignedRangeKernel;
+            scalarRangeKernel = _scalarRangeKernel;
+        }
+
+        MemoryComparison comparison;
+        FilterOperand operand;
+        // The value to compare with, or the difference to the previous value
+        T value;
+        CompareKernel<T> alignedKernel = nullptr;
+        CompareKernel<T> unalignedKernel = nullptr;
+        ScalarKernel scalarKernel = nullptr;
+
+        Boolean ranged = false;
+        T low = T();
+        T high = T();
+        CompareRangeKernel<T> alignedRangeKernel = nullptr;
+        CompareRangeKernel<T> unalignedRangeKernel = nullptr;
+        ScalarRangeKernel scalarRangeKernel = nullptr;
+    };
+
+public:
+    /// <param name="tolerance">The tolerance of floats compared with a value, ignored for integers.</param>
+    FilterExpression(FloatTolerance const& tolerance = FloatTolerance()) : _tolerance(tolerance) {
+    }
+
+    /// <summary>
+    /// <para>Parses an expression, keywords are not case sensitive and tokens are separated by spaces:</para>
+    /// <para>expression: clause [or clause]...</para>
+    /// <para>clause: predicate [and predicate]...</para>
+    /// <para>predicate: [==,!=,&lt;,&gt;,&lt;=,&gt;=] operand | operand | between operand and operand | changed | unchanged | increased [by value] | decreased [by value]</para>
+    /// <para>operand: value | previous [+,- value]</para>
+    /// <para>Possible exceptions:</para>
+    /// <para>(Int8)1: The expression is invalid.</para>
+    /// </summary>
+    static FilterExpression<T> Parse(String const& expression, FloatTolerance const& tolerance = FloatTolerance()) {
+        std::vector<String> const tokens = Tokenize(expression);
+        SizeT position = 0;
+
+        FilterExpression<T> filterExpression = FilterExpression<T>(tolerance);
+        filterExpression.AddClause();
+
+        while(true) {
+            ParsePredicate(tokens, position, filterExpression);
+
+            if(position == tokens.size()) {
+                break;
+            }
+
+            String const& token = tokens[position++];
+            if(token == "or") {
+                filterExpression.AddClause();
+            }
+            else if(token != "and") {
+                throw (Int8)1;
+            }
+        }
+
+        return filterExpression;
+    }
+
+    /// <summary>Starts a new clause, the predicates added after it are joined by and, the clauses by or.</summary>
+    inline void AddClause() {
+        _clauses.push_back(std::vector<FilterPredicate>());
+    }
+
+    /// <summary>Adds a predicate to the last clause.</summary>
+    /// <param name="value">The value to compare with, or the difference to the previous value.</param>
+    void AddPredicate(MemoryComparison const comparison, FilterOperand const operand, T const value = T()) {
+        if(_clauses.empty()) {
+            AddClause();
+        }
+
+        std::vector<FilterPredicate>& clause = _clauses.back();
+        switch(comparison) {
+        case MemoryComparison::Equals: clause.push_back(CreatePredicate<MemoryComparison::Equals>(operand, value)); break;
+        case MemoryComparison::NotEquals: clause.push_back(CreatePredicate<MemoryComparison::NotEquals>(operand, value)); break;
+        case MemoryComparison::LessThan: clause.push_back(CreatePredicate<MemoryComparison::LessThan>(operand, value)); break;
+        case MemoryComparison::GreaterThan: clause.push_back(CreatePredicate<MemoryComparison::GreaterThan>(operand, value)); break;
+        case MemoryComparison::LessThanEquals: clause.push_back(CreatePredicate<MemoryComparison::LessThanEquals>(operand, value)); break;
+        case MemoryComparison::GreaterThanEquals: clause.push_back(CreatePredicate<MemoryComparison::GreaterThanEquals>(operand, value)); break;
+        default: clause.push_back(CreatePredicate<MemoryComparison::Equals>(operand, value)); break;
+        }
+
+        // Predicates that keep the fewest values run first, so the rest of the clause is skipped sooner
+        std::stable_sort(clause.begin(), clause.end(), [](FilterPredicate const& a, FilterPredicate const& b) {
+            return GetSelectivityRank(a.comparison) < GetSelectivityRank(b.comparison);
+        });
+    }
+
+    /// <returns>True if any predicate compares with the previous value.</returns>
+    Boolean UsesPrevious() const noexcept {
+        for(std::vector<FilterPredicate> const& clause : _clauses) {
+            for(FilterPredicate const& predicate : clause) {
+                if(predicate.operand == FilterOperand::Previous) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    /// <summary>
+    /// <para>Tests count values against every clause and calls match(index) for every value that passes, in ascending order.</para>
+    /// <para>With a stride of <code>sizeof(T)</code> value i is at data + i * sizeof(T), with a stride of 1 value i is at data + i.</para>
+    /// </summary>
+    /// <param name="previousValues">The previous value of every value, only read if UsesPrevious.</param>
+    template<typename Match>
+    void Evaluate(UInt8 const* data, SizeT const count, SizeT const stride, T const* previousValues, Match&& match) const {
+        Boolean const vectorized = (stride == sizeof(T)) || (stride == 1);
+
+        // Small batches keep the masks on the stack and the values in cache for every predicate
+        constexpr SizeT batchSize = 4096;
+        constexpr SizeT batchWords = batchSize / 64;
+        UInt64 result[batchWords];
+        UInt64 clauseMasks[batchWords];
+        UInt64 masks[batchWords];
+
+        for(SizeT batch = 0; batch < count; batch += batchSize) {
+            SizeT const batchCount = min(batchSize, count - batch);
+            SizeT const words = (batchCount + 63) / 64;
+            UInt8 const* batchData = data + (batch * stride);
+            T const* batchPreviousValues = (previousValues != nullptr) ? (previousValues + batch) : nullptr;
+
+            memset(result, 0, words * sizeof(UInt64));
+
+            for(std::vector<FilterPredicate> const& clause : _clauses) {
+                for(SizeT predicate = 0; predicate < clause.size(); ++predicate) {
+                    FilterPredicate const& filterPredicate = clause[predicate];
+                    UInt64* predicateMasks = (predicate == 0) ? clauseMasks : masks;
+
+                    if(filterPredicate.ranged) {
+                        if(vectorized) {
+                            CompareRangeKernel<T> const kernel = (stride == sizeof(T)) ? filterPredicate.alignedRangeKernel : filterPredicate.unalignedRangeKernel;
+                            kernel(batchData, batchCount, filterPredicate.low, filterPredicate.high, predicateMasks);
+                        }
+                        else {
+                            filterPredicate.scalarRangeKernel(batchData, batchCount, stride, filterPredicate.low, filterPredicate.high, predicateMasks);
+                        }
+                    }
+                    else if((filterPredicate.operand == FilterOperand::Value) && vectorized) {
+                        CompareKernel<T> const kernel = (stride == sizeof(T)) ? filterPredicate.alignedKernel : filterPredicate.unalignedKernel;
+                        kernel(batchData, batchCount, filterPredicate.value, predicateMasks);
+                    }
+                    else {
+                        T const* operandValues = (filterPredicate.operand == FilterOperand::Previous) ? batchPreviousValues : nullptr;
+                        filterPredicate.scalarKernel(batchData, batchCount, stride, operandValues, filterPredicate.value, predicateMasks);
+                    }
+
+                    if(predicate == 0) {
+                        continue;
+                    }
+
+                    UInt64 any = 0;
+                    for(SizeT word = 0; word < words; ++word) {
+                        clauseMasks[word] &= masks[word];
+                        any |= clauseMasks[word];
+                    }
+                    if(any == 0) {
+                        break;
+                    }
+                }
+
+                for(SizeT word = 0; (word < words) && !clause.empty(); ++word) {
+                    result[word] |= clauseMasks[word];
+                }
+            }
+
+            for(SizeT word = 0; word < words; ++word) {
+                for(UInt64 mask = result[word]; mask != 0; mask &= (mask - 1)) {
+                    match(batch + (word * 64) + static_cast<SizeT>(std::countr_zero(mask)));
+                }
+            }
+        }
+    }
+
+private:
+    template<MemoryComparison comparison>
+    static void CompareScalarMasks(UInt8 const* data, SizeT const count, SizeT const stride, T const* previousValues, T const value, UInt64* masks) {
+        memset(masks, 0, ((count + 63) / 64) * sizeof(UInt64));
+        for(SizeT i = 0; i < count; ++i) {
+            // Adding the difference to the previous value wraps like subtracting it from the current one
+            T const filter = (previousValues != nullptr) ? static_cast<T>(previousValues[i] + value) : value;
+            if(Compare<T, comparison>(LoadValue<T>(data + (i * stride)), filter)) {
+                masks[i / 64] |= static_cast<UInt64>(1) << (i % 64);
+            }
+        }
+    }
+
+    template<MemoryComparison comparison>
+    static void CompareRangeScalarMasks(UInt8 const* data, SizeT const count, SizeT const stride, T const low, T const high, UInt64* masks) {
+        memset(masks, 0, ((count + 63) / 64) * sizeof(UInt64));
+        for(SizeT i = 0; i < count; ++i) {
+            if(CompareRange<T, comparison>(LoadValue<T>(data + (i * stride)), low, high)) {
+                masks[i / 64] |= static_cast<UInt64>(1) << (i % 64);
+            }
+        }
+    }
+
+    template<MemoryComparison comparison>
+    inline FilterPredicate CreatePredicate(FilterOperand const operand, T const value) const {
+        if(operand == FilterOperand::Previous) {
+            return FilterPredicate(comparison, operand, value, nullptr, nullptr, &CompareScalarMasks<comparison>);
+        }
+
+        if constexpr(std::is_floating_point_v<T>) {
+            T low;
+            T high;
+            _tolerance.template GetRange<T>(value, low, high);
+
+            static CompareRangeKernel<T> const alignedRangeKernel = GetCompareRangeKernel<T, comparison>(true);
+            static CompareRangeKernel<T> const unalignedRangeKernel = GetCompareRangeKernel<T, comparison>(false);
+            return FilterPredicate(comparison, value, low, high, alignedRangeKernel, unalignedRangeKernel, &CompareRangeScalarMasks<comparison>);
+        }
+
+        static CompareKernel<T> const alignedKernel = GetCompareKernel<T, comparison>(true);
+        static CompareKernel<T> const unalignedKernel = GetCompareKernel<T, comparison>(false);
+        return FilterPredicate(comparison, operand, value, alignedKernel, unalignedKernel, &CompareScalarMasks<comparison>);
+    }
+
+    static std::vector<String> Tokenize(String const& expression) {
+        std::vector<String> tokens = std::vector<String>();
+        String token = String();
+
+        auto const isOperator = [](char const c) {
+            return (c == '=') || (c == '!') || (c == '<') || (c == '>');
+        };
+
+        for(SizeT i = 0, s = expression.length(); i <= s; ++i) {
+            char const c = (i < s) ? expression[i] : ' ';
+            Boolean const split = (c == ' ') || (c == '\t') || (!token.empty() && (isOperator(c) != isOperator(token.back())));
+            if(split && !token.empty()) {
+                tokens.push_back(ToLowerAscii(token));
+                token.clear();
+            }
+            if((c != ' ') && (c != '\t')) {
+                token += c;
+            }
+        }
+
+        return tokens;
+    }
+
+    static void ParsePredicate(std::vector<String> const& tokens, SizeT& position, FilterExpression<T>& filterExpression) {
+        if(position == tokens.size()) {
+            throw (Int8)1;
+        }
+
+        String const& token = tokens[position];
+
+        if(token == "between") {
+            ++position;
+            FilterOperand lowOperand = FilterOperand::Value;
+            T const low = ParseOperand(tokens, position, lowOperand);
+            if((position == tokens.size()) || (tokens[position] != "and")) {
+                throw (Int8)1;
+            }
+            ++position;
+            FilterOperand highOperand = FilterOperand::Value;
+            T const high = ParseOperand(tokens, position, highOperand);
+
+            filterExpression.AddPredicate(MemoryComparison::GreaterThanEquals, lowOperand, low);
+            filterExpression.AddPredicate(MemoryComparison::LessThanEquals, highOperand, high);
+            return;
+        }
+
+        if((token == "changed") || (token == "unchanged")) {
+            ++position;
+            filterExpression.AddPredicate((token == "changed") ? MemoryComparison::NotEquals : MemoryComparison::Equals, FilterOperand::Previous);
+            return;
+        }
+
+        if((token == "increased") || (token == "decreased")) {
+            Boolean const increased = token == "increased";
+            ++position;
+
+            if((position < tokens.size()) && (tokens[position] == "by")) {
+                ++position;
+                T const difference = ParseValue(tokens, position);
+                filterExpression.AddPredicate(MemoryComparison::Equals, FilterOperand::Previous, increased ? difference : static_cast<T>(T() - difference));
+            }
+            else {
+                filterExpression.AddPredicate(increased ? MemoryComparison::GreaterThan : MemoryComparison::LessThan, FilterOperand::Previous);
+            }
+            return;
+        }
+
+        MemoryComparison comparison = MemoryComparison::Equals;
+        if(token == "==") { comparison = MemoryComparison::Equals; ++position; }
+        else if(token == "!=") { comparison = MemoryComparison::NotEquals; ++position; }
+        else if(token == "<") { comparison = MemoryComparison::LessThan; ++position; }
+        else if(token == ">") { comparison = MemoryComparison::GreaterThan; ++position; }
+        else if(token == "<=") { comparison = MemoryComparison::LessThanEquals; ++position; }
+        else if(token == ">=") { comparison = MemoryComparison::GreaterThanEquals; ++position; }
+
+        FilterOperand operand = FilterOperand::Value;
+        T const value = ParseOperand(tokens, position, operand);
+        filterExpression.AddPredicate(comparison, operand, value);
+    }
+
+    static T ParseOperand(std::vector<String> const& tokens, SizeT& position, FilterOperand& operand) {
+        if((position == tokens.size()) || (tokens[position] != "previous")) {
+            operand = FilterOperand::Value;
+            return ParseValue(tokens, position);
+        }
+
+        operand = FilterOperand::Previous;
+        ++position;
+
+        if((position < tokens.size()) && ((tokens[position] == "+") || (tokens[position] == "-"))) {
+            Boolean const add = tokens[position] == "+";
+            ++position;
+            T const difference = ParseValue(tokens, position);
+            return add ? difference : static_cast<T>(T() - difference);
+        }
+        return T();
+    }
+
+    static T ParseValue(std::vector<String> const& tokens, SizeT& position) {
+        if(position == tokens.size()) {
+            throw (Int8)1;
+        }
+        // Throws (Int8)1 as well
+        return FromString<T>(tokens[position++]);
+    }
+
+    FloatTolerance _tolerance;
+    std::vector<std::vector<FilterPredicate>> _clauses = std::vector<std::vector<FilterPredicate>>();
+};
@@ -0,0 +1,307 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Types.hpp"
+#include "Platform.hpp"
+
+/// <summary>
+/// <para>Keeps addresses of a process locked to a value by writing them again on a background thread at a fixed rate.</para>
+/// <para>Locks next to each other are written with a single call, so the number of calls per tick follows the number of separate runs, not the number of locks.</para>
+/// </summary>
+struct FreezeEngine {
+public:
+    /// <summary>Returns the number of bytes read or written, or 0 if the call failed.</summary>
+    using Reader = std::function<SizeT(SizeT address, SizeT size, UInt8* data)>;
+    using Writer = std::function<SizeT(SizeT address, SizeT size, UInt8 const* data)>;
+
+private:
+    struct FreezeLock {
+    public:
+        FreezeLock(SizeT const _offset, SizeT const _size) {
+            offset = _offset;
+            size = _size;
+        }
+
+        // Offset from the start of the batch
+        SizeT offset;
+        SizeT size;
+    };
+
+    /// <summary>Locks written with one call, data holds the locked bytes from start with zeros in the gaps.</summary>
+    struct FreezeBatch {
+    public:
+        FreezeBatch(SizeT const _start) {
+            start = _start;
+        }
+
+        SizeT start;
+        std::vector<UInt8> data = std::vector<UInt8>();
+        std::vector<FreezeLock> locks = std::vector<FreezeLock>();
+        // False if there are gaps, which can only be written after reading them
+        Boolean contiguous = true;
+    };
+
+    using FreezePlan = std::vector<FreezeBatch>;
+
+public:
+    FreezeEngine(Reader const& reader, Writer const& writer) {
+        _reader = reader;
+        _writer = writer;
+    }
+
+    FreezeEngine(FreezeEngine const&) = delete;
+    FreezeEngine& operator=(FreezeEngine const&) = delete;
+
+    ~FreezeEngine() {
+        Stop();
+    }
+
+    /// <summary>Locks size bytes from address to data, replacing the lock at the same address. Where locks overlap, the lock at the higher address wins.</summary>
+    void Lock(SizeT const address, UInt8 const* data, SizeT const size) {
+        if(size == 0) {
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock = std::unique_lock<std::mutex>(_mutex);
+        _locks[address] = std::vector<UInt8>(data, data + size);
+        _plan = nullptr;
+    }
+
+    /// <returns>True if there was a lock at address.</returns>
+    Boolean Unlock(SizeT const address) {
+        std::unique_lock<std::mutex> lock = std::unique_lock<std::mutex>(_mutex);
+        Boolean const unlocked = _locks.erase(address) != 0;
+        _plan = nullptr;
+        return unlocked;
+    }
+
+    void UnlockAll() {
+        std::unique_lock<std::mutex> lock = std::unique_lock<std::mutex>(_mutex);
+        _locks.clear();
+        _plan = nullptr;
+    }
+
+    SizeT GetLockCount() {
+        std::unique_lock<std::mutex> lock = std::unique_lock<std::mutex>(_mutex);
+        return _locks.size();
+    }
+
+    /// <summary>Sets how many times per second the locks are written, 60 by default.</summary>
+    void SetTickRate(Float64 const ticksPerSecond) {
+        std::unique_lock<std::mutex> lock = std::unique_lock<std::mutex>(_mutex);
+        _interval = std::chrono::microseconds(static_cast<Int64>(1000000.0 / max(ticksPerSecond, 0.001)));
+    }
+
+    /// <summary>
+    /// <para>If true, the memory of the locks is read first and only written where it differs from the locks, off by default.</para>
+    /// <para>Reading allows locks up to maxGap bytes apart to share one read, and one write from the first to the last lock that differs, which writes the gap back as read.</para>
+    /// <para>A write by the process to such a gap in the moment between the read and the write is lost, so maxGap is best kept to gaps that the process never writes, e.g. between fields of one struct.</para>
+    /// </summary>
+    void SetWriteIfChanged(Boolean const writeIfChanged, SizeT const maxGap = 0) {
+        std::unique_lock<std::mutex> lock = std::unique_lock<std::mutex>(_mutex);
+        _writeIfChanged = writeIfChanged;
+        _maxGap = maxGap;
+        _plan = nullptr;
+    }
+
+    /// <summary>Starts writing the locks on a background thread, locks can still be changed while it runs.</summary>
+    void Start() {
+        std::unique_lock<std::mutex> lock = std::unique_lock<std::mutex>(_mutex);
+        if(_thread.joinable()) {
+            return;
+        }
+
+        _stop = false;
+        _thread = std::thread(&FreezeEngine::Run, this);
+    }
+
+    /// <summary>Stops the background thread, the locks are kept for the next Start.</summary>
+    void Stop() {
+        {
+            std::unique_lock<std::mutex> lock = std::unique_lock<std::mutex>(_mutex);
+            if(!_thread.joinable()) {
+                return;
+            }
+            _stop = true;
+        }
+        _wake.notify_all();
+
+        _thread.join();
+    }
+
+    Boolean IsRunning() {
+        std::unique_lock<std::mutex> lock = std::unique_lock<std::mutex>(_mutex);
+        return _thread.joinable();
+    }
+
+    /// <summary>Writes every lock once, on the calling thread. Locks that cannot be written are tried again on the next tick.</summary>
+    void Tick() {
+        std::shared_ptr<FreezePlan const> plan = nullptr;
+        Boolean writeIfChanged;
+        {
+            std::unique_lock<std::mutex> lock = std::unique_lock<std::mutex>(_mutex);
+            if(_plan == nullptr) {
+                _plan = CreatePlan();
+            }
+            plan = _plan;
+            writeIfChanged = _writeIfChanged;
+        }
+
+        // The plan is never changed once made, new locks make a new plan
+        std::vector<UInt8> buffer = std::vector<UInt8>();
+        for(FreezeBatch const& batch : *plan) {
+            if(writeIfChanged) {
+                WriteChanged(batch, buffer);
+            }
+            else {
+                WriteBatch(batch);
+            }
+        }
+
+        ++_ticks;
+    }
+
+    /// <returns>The number of ticks so far.</returns>
+    inline UInt64 GetTicks() const noexcept {
+        return _ticks.load();
+    }
+
+    /// <returns>The number of read and write calls so far.</returns>
+    inline UInt64 GetCallCount() const noexcept {
+        return _calls.load();
+    }
+
+private:
+    /// <summary>Joins the locks into batches, must be called with the mutex held.</summary>
+    std::shared_ptr<FreezePlan const> CreatePlan() const {
+        std::shared_ptr<FreezePlan> plan = std::make_shared<FreezePlan>();
+
+        // Without reading first the bytes in between are unknown, so only touching locks share a write
+        SizeT const maxGap = _writeIfChanged ? _maxGap : 0;
+
+        for(std::pair<SizeT const, std::vector<UInt8>> const& entry : _locks) {
+            SizeT const address = entry.first;
+            std::vector<UInt8> const& data = entry.second;
+
+            if(plan->empty() || (address > (plan->back().start + plan->back().data.size() + maxGap))) {
+                plan->push_back(FreezeBatch(address));
+            }
+
+            FreezeBatch& batch = plan->back();
+            SizeT const offset = address - batch.start;
+            if(offset > batch.data.size()) {
+                batch.contiguous = false;
+            }
+            batch.data.resize(max(batch.data.size(), offset + data.size()), 0);
+            memcpy(batch.data.data() + offset, data.data(), data.size());
+            batch.locks.push_back(FreezeLock(offset, data.size()));
+        }
+
+        return plan;
+    }
+
+    void WriteBatch(FreezeBatch const& batch) {
+        if(Write(batch.start, batch.data.size(), batch.data.data()) || (batch.locks.size() == 1)) {
+            return;
+        }
+
+        // One lock that cannot be written fails the whole batch, so the others are written on their own
+        for(FreezeLock const& lock : batch.locks) {
+            Write(batch.start + lock.offset, lock.size, batch.data.data() + lock.offset);
+        }
+    }
+
+    void WriteChanged(FreezeBatch const& batch, std::vector<UInt8>& buffer) {
+        buffer.resize(batch.data.size());
+        if(Read(batch.start, batch.data.size(), buffer.data())) {
+            // Only the run from the first to the last changed lock is written
+            SizeT first = batch.data.size();
+            SizeT last = 0;
+            for(FreezeLock const& lock : batch.locks) {
+                if(memcmp(buffer.data() + lock.offset, batch.data.data() + lock.offset, lock.size) != 0) {
+                    first = min(first, lock.offset);
+                    last = max(last, lock.offset + lock.size);
+                }
+            }
+
+            if(first >= last) {
+                return;
+            }
+
+            for(FreezeLock const& lock : batch.locks) {
+                memcpy(buffer.data() + lock.offset, batch.data.data() + lock.offset, lock.size);
+            }
+            if(Write(batch.start + first, last - first, buffer.data() + first)) {
+                return;
+            }
+        }
+        else if(batch.contiguous) {
+            // Unreadable but maybe writable, the gaps are unknown though
+            WriteBatch(batch);
+            return;
+        }
+
+        for(FreezeLock const& lock : batch.locks) {
+            Write(batch.start + lock.offset, lock.size, batch.data.data() + lock.offset);
+        }
+    }
+
+    inline Boolean Read(SizeT const address, SizeT const size, UInt8* data) {
+        ++_calls;
+        return _reader(address, size, data) == size;
+    }
+
+    inline Boolean Write(SizeT const address, SizeT const size, UInt8 const* data) {
+        ++_calls;
+        return _writer(address, size, data) == size;
+    }
+
+    void Run() {
+        std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+
+        while(true) {
+            Tick();
+
+            std::unique_lock<std::mutex> lock = std::unique_lock<std::mutex>(_mutex);
+            // Ticks keep to the rate even if a tick takes a while, but a late tick does not cause a burst of them
+            next = next + _interval;
+            std::chrono::steady_clock::time_point const now = std::chrono::steady_clock::now();
+            if(next < now) {
+                next = now;
+            }
+            if(_wake.wait_until(lock, next, [this]() { return _stop; })) {
+                return;
+            }
+        }
+    }
+
+    Reader _reader;
+    Writer _writer;
+
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::thread _thread = std::thread();
+    Boolean _stop = false;
+
+    // Address and bytes of every lock
+    std::map<SizeT, std::vector<UInt8>> _locks = std::map<SizeT, std::vector<UInt8>>();
+    // The batches of the locks, made again on the next tick after the locks change
+    std::shared_ptr<FreezePlan const> _plan = nullptr;
+
+    std::chrono::microseconds _interval = std::chrono::microseconds(1000000 / 60);
+    Boolean _writeIfChanged = false;
+    SizeT _maxGap = 0;
+
+    std::atomic<UInt64> _ticks = 0;
+    std::atomic<UInt64> _calls = 0;
+};
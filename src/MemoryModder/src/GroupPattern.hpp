@@ -0,0 +1,250 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "Types.hpp"
+#include "Platform.hpp"
+#include "Compare.hpp"
+#include "CompareKernels.hpp"
+#include "Convert.hpp"
+#include "StringUtils.hpp"
+
+/// <summary>
+/// <para>Typed fields at fixed offsets from a base address, e.g. the health, maximum health and position of a game entity.</para>
+/// <para>The most selective field is scanned first with the compare kernels, the others are only tested where it matched.</para>
+/// </summary>
+struct GroupPattern {
+private:
+    /// <summary>Appends the index of every value that compares true with value to matches, see CompareValues.</summary>
+    using ScanKernel = void (*)(UInt8 const* data, SizeT count, SizeT stride, UInt8 const* value, std::vector<UInt32>& matches);
+    using TestKernel = Boolean (*)(UInt8 const* data, UInt8 const* value);
+
+    struct GroupField {
+    public:
+        GroupField(SizeT const _offset, SizeT const _size, MemoryComparison const _comparison, UInt8 const* _value, ScanKernel const _scan, TestKernel const _test) {
+            offset = _offset;
+            size = _size;
+            comparison = _comparison;
+            memset(value, 0, sizeof(value));
+            memcpy(value, _value, _size);
+            scan = _scan;
+            test = _test;
+        }
+
+        SizeT offset;
+        SizeT size;
+        MemoryComparison comparison;
+        UInt8 value[8];
+        ScanKernel scan;
+        TestKernel test;
+    };
+
+public:
+    /// <summary>
+    /// <para>Parses fields separated by commas, keywords are not case sensitive and tokens are separated by spaces:</para>
+    /// <para>field: type [name] [==,!=,&lt;,&gt;,&lt;=,&gt;=] value @offset | type [name] between value and value @offset | type [name] @offset in range [value and value]</para>
+    /// <para>type: int8, int16, int32, int64, uint8, uint16, uint32, uint64, float32, float64. offset: decimal or 0x hexadecimal, may start with +.</para>
+    /// <para>The name is only for the reader. A range without values holds every value of the type, for floats every finite value.</para>
+    /// <para>e.g. int32 hp == 100 @0, int32 maxhp == 100 @+4, float32 x @+8 in range</para>
+    /// <para>Possible exceptions:</para>
+    /// <para>(Int8)1: The pattern is invalid.</para>
+    /// </summary>
+    static GroupPattern Parse(String const& pattern) {
+        GroupPattern groupPattern = GroupPattern();
+
+        SizeT start = 0;
+        while(start <= pattern.length()) {
+            SizeT end = pattern.find(',', start);
+            end = (end == String::npos) ? pattern.length() : end;
+            groupPattern.ParseField(pattern.substr(start, end - start));
+            start = end + 1;
+        }
+
+        return groupPattern;
+    }
+
+    /// <summary>Adds a field that compares true if the value at base + offset compares true with value.</summary>
+    template<typename T>
+    void AddField(SizeT const offset, MemoryComparison const comparison, T const value) {
+        switch(comparison) {
+        case MemoryComparison::Equals: AddField<T, MemoryComparison::Equals>(offset, value); break;
+        case MemoryComparison::NotEquals: AddField<T, MemoryComparison::NotEquals>(offset, value); break;
+        case MemoryComparison::LessThan: AddField<T, MemoryComparison::LessThan>(offset, value); break;
+        case MemoryComparison::GreaterThan: AddField<T, MemoryComparison::GreaterThan>(offset, value); break;
+        case MemoryComparison::LessThanEquals: AddField<T, MemoryComparison::LessThanEquals>(offset, value); break;
+        case MemoryComparison::GreaterThanEquals: AddField<T, MemoryComparison::GreaterThanEquals>(offset, value); break;
+        default: AddField<T, MemoryComparison::Equals>(offset, value); break;
+        }
+    }
+
+    template<typename T, MemoryComparison comparison>
+    void AddField(SizeT const offset, T const value) {
+        UInt8 bytes[sizeof(T)];
+        memcpy(bytes, &value, sizeof(T));
+        _fields.push_back(GroupField(offset, sizeof(T), comparison, bytes, &ScanField<T, comparison>, &TestField<T, comparison>));
+
+        // Equality of wide values rejects the most bases, so it goes first
+        std::stable_sort(_fields.begin(), _fields.end(), [](GroupField const& a, GroupField const& b) {
+            SizeT const rankA = GetSelectivityRank(a.comparison);
+            SizeT const rankB = GetSelectivityRank(b.comparison);
+            return (rankA < rankB) || ((rankA == rankB) && (a.size > b.size));
+        });
+    }
+
+    inline SizeT GetFieldCount() const noexcept {
+        return _fields.size();
+    }
+
+    /// <returns>The number of bytes from the base to the end of the last field.</returns>
+    SizeT GetSize() const noexcept {
+        SizeT size = 0;
+        for(GroupField const& field : _fields) {
+            size = max(size, field.offset + field.size);
+        }
+        return size;
+    }
+
+    /// <summary>
+    /// <para>Calls match(index) for every base below count where all fields compare true, in ascending order.</para>
+    /// <para>Base i is at data + i * stride, data holds (count - 1) * stride + GetSize() bytes.</para>
+    /// </summary>
+    /// <param name="matches">Reused buffer for the bases the first field matched.</param>
+    template<typename Match>
+    void Find(UInt8 const* data, SizeT const count, SizeT const stride, std::vector<UInt32>& matches, Match&& match) const {
+        if(_fields.empty()) {
+            return;
+        }
+
+        GroupField const& first = _fields.front();
+
+        // Batches keep the indices in 32 bits and the matched data in cache for the other fields
+        constexpr SizeT batchSize = 0x10000;
+        for(SizeT batch = 0; batch < count; batch += batchSize) {
+            SizeT const batchCount = min(batchSize, count - batch);
+            UInt8 const* batchData = data + (batch * stride);
+
+            matches.clear();
+            first.scan(batchData + first.offset, batchCount, stride, first.value, matches);
+
+            for(UInt32 const index : matches) {
+                UInt8 const* base = batchData + (static_cast<SizeT>(index) * stride);
+
+                Boolean matched = true;
+                for(SizeT field = 1, s = _fields.size(); (field < s) && matched; ++field) {
+                    matched = _fields[field].test(base + _fields[field].offset, _fields[field].value);
+                }
+
+                if(matched) {
+                    match(batch + index);
+                }
+            }
+        }
+    }
+
+private:
+    template<typename T, MemoryComparison comparison>
+    static void ScanField(UInt8 const* data, SizeT const count, SizeT const stride, UInt8 const* value, std::vector<UInt32>& matches) {
+        CompareValues<T, comparison>(data, count, stride, LoadValue<T>(value), [&matches](SizeT const index) {
+            matches.push_back(static_cast<UInt32>(index));
+        });
+    }
+
+    template<typename T, MemoryComparison comparison>
+    static Boolean TestField(UInt8 const* data, UInt8 const* value) {
+        return Compare<T, comparison>(LoadValue<T>(data), LoadValue<T>(value));
+    }
+
+    void ParseField(String const& field) {
+        std::vector<String> tokens = std::vector<String>();
+        String token = String();
+        for(SizeT i = 0, s = field.length(); i <= s; ++i) {
+            char const c = (i < s) ? field[i] : ' ';
+            if((c == ' ') || (c == '\t')) {
+                if(!token.empty()) {
+                    tokens.push_back(ToLowerAscii(token));
+                    token.clear();
+                }
+                continue;
+            }
+            token += c;
+        }
+
+        // A name after the type is anything that does not start the rest of a field
+        if((tokens.size() > 1) && !IsComparison(tokens[1]) && (tokens[1] != "between") && (tokens[1][0] != '@')) {
+            tokens.erase(tokens.begin() + 1);
+        }
+
+        // type, comparison, value and offset, or type, between, value, and, value and offset, or type, offset, in, range and maybe value, and, value
+        Boolean const inRange = (tokens.size() >= 4) && (tokens[2] == "in") && (tokens[3] == "range");
+        Boolean const rangeValues = inRange && (tokens.size() == 7) && (tokens[5] == "and");
+        Boolean const between = ((tokens.size() == 6) && (tokens[1] == "between") && (tokens[3] == "and")) || inRange;
+        if(!between && (tokens.size() != 4)) {
+            throw (Int8)1;
+        }
+        if(inRange && !rangeValues && (tokens.size() != 4)) {
+            throw (Int8)1;
+        }
+
+        String const& offsetString = inRange ? tokens[1] : tokens.back();
+        if((offsetString.length() < 2) || (offsetString[0] != '@')) {
+            throw (Int8)1;
+        }
+        String offsetDigits = offsetString.substr((offsetString[1] == '+') ? 2 : 1);
+        Boolean const hex = (offsetDigits.length() > 2) && (offsetDigits[0] == '0') && (offsetDigits[1] == 'x');
+        if(hex) {
+            offsetDigits = offsetDigits.substr(2);
+        }
+        if(offsetDigits.empty() || (offsetDigits[0] == '-')) {
+            throw (Int8)1;
+        }
+        SizeT const offset = FromString<SizeT>(offsetDigits, hex ? std::ios_base::hex : std::ios_base::dec);
+
+        String const type = tokens[0];
+        // Range values are moved to where between keeps them
+        if(inRange) {
+            tokens = rangeValues ? std::vector<String>({ tokens[0], "between", tokens[4], "and", tokens[6] }) : std::vector<String>({ tokens[0], "between" });
+        }
+
+        if(type == "int8") { ParseComparisons<Int8>(tokens, between, offset); }
+        else if(type == "int16") { ParseComparisons<Int16>(tokens, between, offset); }
+        else if(type == "int32") { ParseComparisons<Int32>(tokens, between, offset); }
+        else if(type == "int64") { ParseComparisons<Int64>(tokens, between, offset); }
+        else if(type == "uint8") { ParseComparisons<UInt8>(tokens, between, offset); }
+        else if(type == "uint16") { ParseComparisons<UInt16>(tokens, between, offset); }
+        else if(type == "uint32") { ParseComparisons<UInt32>(tokens, between, offset); }
+        else if(type == "uint64") { ParseComparisons<UInt64>(tokens, between, offset); }
+        else if(type == "float32") { ParseComparisons<Float32>(tokens, between, offset); }
+        else if(type == "float64") { ParseComparisons<Float64>(tokens, between, offset); }
+        else { throw (Int8)1; }
+    }
+
+    template<typename T>
+    void ParseComparisons(std::vector<String> const& tokens, Boolean const between, SizeT const offset) {
+        if(between) {
+            // A range without values holds every value, only NaN and infinity are outside of it
+            Boolean const values = tokens.size() > 2;
+            AddField<T>(offset, MemoryComparison::GreaterThanEquals, values ? FromString<T>(tokens[2]) : std::numeric_limits<T>::lowest());
+            AddField<T>(offset, MemoryComparison::LessThanEquals, values ? FromString<T>(tokens[4]) : (std::numeric_limits<T>::max)());
+            return;
+        }
+
+        String const& comparison = tokens[1];
+        T const value = FromString<T>(tokens[2]);
+        if(comparison == "==") { AddField<T>(offset, MemoryComparison::Equals, value); }
+        else if(comparison == "!=") { AddField<T>(offset, MemoryComparison::NotEquals, value); }
+        else if(comparison == "<") { AddField<T>(offset, MemoryComparison::LessThan, value); }
+        else if(comparison == ">") { AddField<T>(offset, MemoryComparison::GreaterThan, value); }
+        else if(comparison == "<=") { AddField<T>(offset, MemoryComparison::LessThanEquals, value); }
+        else if(comparison == ">=") { AddField<T>(offset, MemoryComparison::GreaterThanEquals, value); }
+        else { throw (Int8)1; }
+    }
+
+    static inline Boolean IsComparison(String const& token) {
+        return (token == "==") || (token == "!=") || (token == "<") || (token == ">") || (token == "<=") || (token == ">=");
+    }
+
+    std::vector<GroupField> _fields = std::vector<GroupField>();
+};
@@ -0,0 +1,376 @@
+#pragma once
+
+#if defined(__linux__)
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "Types.hpp"
+#include "Platform.hpp"
+#include "DirtyPages.hpp"
+#include "MemoryList.hpp"
+#include "Module.hpp"
+#include "Process.hpp"
+#include "ReadRequest.hpp"
+#include "RegionMap.hpp"
+#include "SoftDirtyTracker.hpp"
+
+/// <summary>
+/// <para>The memory of a Linux process, read and written with process_vm_readv and process_vm_writev, with the regions and modules of <code>/proc/&lt;pid&gt;/maps</code>.</para>
+/// <para>Needs the same access as attaching a debugger, e.g. being its parent, kernel.yama.ptrace_scope set to 0 or CAP_SYS_PTRACE.</para>
+/// </summary>
+struct LinuxProcessMemory {
+public:
+    /// <summary>
+    /// <para>Opens the process with this processId.</para>
+    /// <para>Possible exceptions:</para>
+    /// <para>(Int8)1: The process cannot be used.</para>
+    /// <para>(Int8)2: The process has stopped running.</para>
+    /// </summary>
+    LinuxProcessMemory(SizeT const processId) {
+        if(processId == static_cast<SizeT>(getpid())) {
+            // Prevent using own process because fetching all memory will allocate forever.
+            throw (Int8)1;
+        }
+
+        _processId = processId;
+
+        // "pid (name) state ...", the name may hold spaces and parentheses itself
+        String const stat = ReadFile(GetPath("stat"));
+        SizeT const nameStart = stat.find('(');
+        SizeT const nameEnd = stat.rfind(')');
+        if((nameStart == String::npos) || (nameEnd == String::npos) || ((nameEnd + 2) >= stat.size())) {
+            throw (Int8)1;
+        }
+
+        char const state = stat[nameEnd + 2];
+        if((state == 'Z') || (state == 'X')) {
+            throw (Int8)2;
+        }
+
+        // Opening the memory takes the same access check as process_vm_readv, and it writes pages that process_vm_writev cannot
+        _memoryFile = open(GetPath("mem").c_str(), O_RDWR | O_CLOEXEC);
+        if(_memoryFile < 0) {
+            throw (Int8)1;
+        }
+
+        _processName = stat.substr(nameStart + 1, nameEnd - nameStart - 1);
+
+        std::vector<Module> const modules = GetModules();
+        _processBaseAddress = modules.empty() ? 0 : modules.front().GetBase();
+    }
+
+    LinuxProcessMemory(LinuxProcessMemory const&) = delete;
+    LinuxProcessMemory& operator=(LinuxProcessMemory const&) = delete;
+
+    ~LinuxProcessMemory() {
+        if(_memoryFile >= 0) {
+            close(_memoryFile);
+        }
+    }
+
+    /// <returns>Every process in <code>/proc</code>.</returns>
+    static std::vector<Process> GetProcesses() {
+        std::vector<Process> processes = std::vector<Process>();
+
+        DIR* directory = opendir("/proc");
+        if(directory == nullptr) {
+            return processes;
+        }
+
+        for(dirent* entry = readdir(directory); entry != nullptr; entry = readdir(directory)) {
+            char* end = nullptr;
+            SizeT const processId = static_cast<SizeT>(strtoull(entry->d_name, &end, 10));
+            if((end == entry->d_name) || (*end != '\0')) {
+                continue;
+            }
+
+            // Processes that exit in the meantime have no name left
+            String name = ReadFile("/proc/" + std::to_string(processId) + "/comm");
+            if(!name.empty() && (name.back() == '\n')) {
+                name.pop_back();
+            }
+            if(!name.empty()) {
+                processes.push_back(Process(name, processId));
+            }
+        }
+
+        closedir(directory);
+
+        return processes;
+    }
+
+    SizeT GetProcessId() const {
+        return _processId;
+    }
+
+    String GetProcessName() const {
+        return _processName;
+    }
+
+    SizeT GetBaseAddress() const {
+        return _processBaseAddress;
+    }
+
+    /// <summary>Modules are the files with an executable mapping, from their first to their last mapping, including the anonymous mapping of their bss right after it like the image size on Windows.</summary>
+    /// <returns>Every module loaded into the process, the executable first.</returns>
+    std::vector<Module> GetModules() const {
+        std::vector<Module> modules = std::vector<Module>();
+        std::vector<String> const images = GetImages();
+
+        // The module of the mapping before, or modules.size() if it is none
+        SizeT previous = 0;
+        ForEachMapping([&modules, &images, &previous](SizeT const start, SizeT const end, char const*, String const& path) {
+            if(path.empty() && (previous < modules.size()) && (modules[previous].GetEnd() == start)) {
+                Module& module = modules[previous];
+                module = Module(module.GetName(), module.GetBase(), end - module.GetBase());
+                previous = modules.size();
+                return;
+            }
+
+            previous = modules.size();
+            if(!std::binary_search(images.begin(), images.end(), path)) {
+                return;
+            }
+
+            // Mappings of one file are next to each other, apart from files that are mapped twice
+            for(SizeT i = 0; i < modules.size(); ++i) {
+                Module& module = modules[i];
+                if(module.GetName() == path) {
+                    module = Module(path, module.GetBase(), max(module.GetEnd(), end) - module.GetBase());
+                    previous = i;
+                    return;
+                }
+            }
+            modules.push_back(Module(path, start, end - start));
+            previous = modules.size() - 1;
+        });
+
+        String const executable = ReadLink(GetPath("exe"));
+        std::stable_partition(modules.begin(), modules.end(), [&executable](Module const& module) {
+            return module.GetName() == executable;
+        });
+
+        // Modules are named by their file name like on Windows
+        for(Module& module : modules) {
+            String const& path = module.GetName();
+            module = Module(path.substr(path.rfind('/') + 1), module.GetBase(), module.GetSize());
+        }
+
+        return modules;
+    }
+
+    /// <summary>
+    /// <para>Calls visitor(RegionInfo const& region) for every mapping, ascending.</para>
+    /// <para>Anonymous mappings are MEM_PRIVATE, mappings of modules are MEM_IMAGE and the other files and shared memory are MEM_MAPPED.</para>
+    /// </summary>
+    template<typename Visitor>
+    void ForEachRegion(Visitor&& visitor) const {
+        std::vector<String> const images = GetImages();
+
+        ForEachMapping([&visitor, &images](SizeT const start, SizeT const end, char const* permissions, String const& path) {
+            UInt32 type = MEM_MAPPED;
+            if(permissions[3] != 's') {
+                if(path.empty() || (path[0] == '[')) {
+                    type = MEM_PRIVATE;
+                }
+                else if(std::binary_search(images.begin(), images.end(), path)) {
+                    type = MEM_IMAGE;
+                }
+            }
+
+            UInt32 protection = GetProtection(permissions);
+            if((path == "[vvar]") || (path == "[vvar_vclock]") || (path == "[vsyscall]")) {
+                // Pages of the kernel that process_vm_readv cannot read
+                protection = PAGE_NOACCESS;
+            }
+
+            visitor(RegionInfo(start, end - start, protection, type));
+        });
+    }
+
+    /// <returns>The number of bytes read from address on, fewer than size if the range runs into memory that cannot be read, or 0 if the read failed.</returns>
+    inline SizeT Read(SizeT const address, SizeT const size, UInt8* data) const {
+        iovec local = { data, size };
+        iovec remote = { reinterpret_cast<void*>(address), size };
+
+        ssize_t const sizeRead = process_vm_readv(static_cast<pid_t>(_processId), &local, 1, &remote, 1, 0);
+        return (sizeRead > 0) ? static_cast<SizeT>(sizeRead) : 0;
+    }
+
+    /// <summary>
+    /// <para>Reads every request with as few calls as possible, process_vm_readv takes up to 1024 ranges per call.</para>
+    /// <para>A call stops at the first range that faults, so only that range is cut short and the next call goes on with the range after it.</para>
+    /// </summary>
+    void ReadBatch(ReadRequest* requests, SizeT const count) const {
+        iovec local[maxBatchCount];
+        iovec remote[maxBatchCount];
+
+        for(SizeT first = 0; first < count;) {
+            SizeT const batchCount = min(count - first, maxBatchCount);
+            for(SizeT i = 0; i < batchCount; ++i) {
+                ReadRequest& request = requests[first + i];
+                local[i] = { request.data, request.size };
+                remote[i] = { reinterpret_cast<void*>(request.address), request.size };
+                request.sizeRead = 0;
+            }
+
+            ssize_t const sizeRead = process_vm_readv(static_cast<pid_t>(_processId), local, batchCount, remote, batchCount, 0);
+            if(sizeRead < 0) {
+                if(errno != EFAULT) {
+                    // The process is gone or cannot be read at all, so the other requests would fail the same way
+                    for(SizeT i = first + batchCount; i < count; ++i) {
+                        requests[i].sizeRead = 0;
+                    }
+                    return;
+                }
+
+                // Nothing was read, so the first range faulted
+                ++first;
+                continue;
+            }
+
+            // Ranges are read in order, whole up to the one that faulted
+            SizeT remaining = static_cast<SizeT>(sizeRead);
+            SizeT i = 0;
+            for(; (i < batchCount) && (remaining >= requests[first + i].size); ++i) {
+                requests[first + i].sizeRead = requests[first + i].size;
+                remaining -= requests[first + i].size;
+            }
+            if(i < batchCount) {
+                requests[first + i].sizeRead = remaining;
+                ++i;
+            }
+
+            first += i;
+        }
+    }
+
+    /// <returns>The number of bytes written, or 0 if the write failed.</returns>
+    inline SizeT Write(SizeT const address, SizeT const size, UInt8 const* data) const {
+        iovec local = { const_cast<UInt8*>(data), size };
+        iovec remote = { reinterpret_cast<void*>(address), size };
+
+        ssize_t sizeWritten = process_vm_writev(static_cast<pid_t>(_processId), &local, 1, &remote, 1, 0);
+        if(sizeWritten != static_cast<ssize_t>(size)) {
+            // Read-only pages, e.g. code, can only be written through the memory file, like WriteProcessMemory does on Windows
+            sizeWritten = pwrite(_memoryFile, data, size, static_cast<off_t>(address));
+        }
+        return (sizeWritten > 0) ? static_cast<SizeT>(sizeWritten) : 0;
+    }
+
+    /// <summary>Clears the soft-dirty bits of the process, see SoftDirtyTracker.</summary>
+    /// <returns>False if the kernel keeps no soft-dirty bits.</returns>
+    inline Boolean ClearDirtyPages() const {
+        return SoftDirtyTracker(_processId).Clear();
+    }
+
+    /// <summary>Fills dirtyPages with the pages of the list written since ClearDirtyPages, see SoftDirtyTracker::Read.</summary>
+    template<typename T>
+    inline Boolean ReadDirtyPages(MemoryList<T> const& memoryList, SizeT const tail, DirtyPages& dirtyPages) const {
+        return SoftDirtyTracker(_processId).Read(memoryList, tail, dirtyPages);
+    }
+
+private:
+    // IOV_MAX, the most ranges process_vm_readv takes
+    static constexpr SizeT maxBatchCount = 0x400;
+
+    static UInt32 GetProtection(char const* permissions) {
+        Boolean const readable = permissions[0] == 'r';
+        Boolean const writable = permissions[1] == 'w';
+        Boolean const executable = permissions[2] == 'x';
+
+        if(executable) {
+            return writable ? PAGE_EXECUTE_READWRITE : (readable ? PAGE_EXECUTE_READ : PAGE_EXECUTE);
+        }
+        if(writable) {
+            return PAGE_READWRITE;
+        }
+        return readable ? PAGE_READONLY : PAGE_NOACCESS;
+    }
+
+    /// <summary>Calls visitor(SizeT start, SizeT end, char const* permissions, String const& path) for every line of the maps, path is empty for anonymous memory.</summary>
+    template<typename Visitor>
+    void ForEachMapping(Visitor&& visitor) const {
+        String const maps = ReadFile(GetPath("maps"));
+
+        for(SizeT lineStart = 0; lineStart < maps.size();) {
+            SizeT lineEnd = maps.find('\n', lineStart);
+            if(lineEnd == String::npos) {
+                lineEnd = maps.size();
+            }
+
+            // "start-end perms offset dev inode path"
+            unsigned long long start = 0;
+            unsigned long long end = 0;
+            char permissions[5] = {};
+            int pathStart = 0;
+            String const line = maps.substr(lineStart, lineEnd - lineStart);
+            if(sscanf(line.c_str(), "%llx-%llx %4s %*s %*s %*s %n", &start, &end, permissions, &pathStart) >= 3) {
+                String const path = (pathStart > 0) ? line.substr(static_cast<SizeT>(pathStart)) : String();
+                visitor(static_cast<SizeT>(start), static_cast<SizeT>(end), static_cast<char const*>(permissions), path);
+            }
+
+            lineStart = lineEnd + 1;
+        }
+    }
+
+    /// <returns>The paths of the files with an executable mapping, sorted.</returns>
+    std::vector<String> GetImages() const {
+        std::vector<String> images = std::vector<String>();
+
+        ForEachMapping([&images](SizeT const, SizeT const, char const* permissions, String const& path) {
+            if((permissions[2] == 'x') && !path.empty() && (path[0] == '/')) {
+                images.push_back(path);
+            }
+        });
+
+        std::sort(images.begin(), images.end());
+        images.erase(std::unique(images.begin(), images.end()), images.end());
+        return images;
+    }
+
+    String GetPath(char const* file) const {
+        return "/proc/" + std::to_string(_processId) + "/" + file;
+    }
+
+    /// <returns>The whole file, files of /proc have no size to ask for up front.</returns>
+    static String ReadFile(String const& path) {
+        String content = String();
+
+        int const file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if(file < 0) {
+            return content;
+        }
+
+        char buffer[0x4000];
+        for(ssize_t sizeRead = read(file, buffer, sizeof(buffer)); sizeRead > 0; sizeRead = read(file, buffer, sizeof(buffer))) {
+            content.append(buffer, static_cast<SizeT>(sizeRead));
+        }
+
+        close(file);
+        return content;
+    }
+
+    static String ReadLink(String const& path) {
+        char buffer[0x1000];
+        ssize_t const size = readlink(path.c_str(), buffer, sizeof(buffer));
+        return (size > 0) ? String(buffer, static_cast<SizeT>(size)) : String();
+    }
+
+    SizeT _processId;
+    // /proc/<pid>/mem, for writes to read-only pages
+    int _memoryFile = -1;
+    String _processName;
+    SizeT _processBaseAddress;
+};
+
+#endif
@@ -0,0 +1,495 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+#include "Types.hpp"
+#include "Platform.hpp"
+
+template<typename T>
+struct MemoryRegion {
+public:
+    MemoryRegion(SizeT start, SizeT size) {
+        _start = start;
+        _size = size;
+    }
+
+    inline SizeT GetStart() const noexcept {
+        return _start;
+    }
+
+    inline void SetStart(SizeT start) noexcept {
+        _start = start;
+    }
+
+    inline SizeT GetSize() const noexcept {
+        return _size;
+    }
+
+    inline void SetSize(SizeT size) noexcept {
+        _size = size;
+    }
+
+    inline SizeT GetEnd() const noexcept {
+        return _start + _size;
+    }
+
+    inline void SetEnd(SizeT end) noexcept {
+        _size = end - _start;
+    }
+
+    inline Boolean IsInside(SizeT pos) const noexcept {
+        return ((pos >= _start) && (pos < (_start + _size)));
+    }
+
+private:
+    SizeT _start;
+    SizeT _size;
+};
+
+/// <summary>How the addresses of one block of a memory list are stored.</summary>
+enum struct MemoryBlockType : UInt8 {
+    // Start and size of every run of addresses, best for few long runs
+    Regions = 0,
+    // One bit per address, best for many addresses close together
+    Bitmap = 1,
+    // Sorted 16 bit address offsets, best for few addresses far apart
+    Offsets = 2
+};
+
+/// <summary>
+/// <para>A sorted list of addresses stored as runs of addresses with a stride.</para>
+/// <para>Addresses are kept in blocks of up to BlockSlots addresses. When a block is done it switches to whichever of regions, a bitmap or offsets takes the least memory.</para>
+/// <para>Iterating the list always gives the runs as memory regions, no matter how they are stored.</para>
+/// </summary>
+template<typename T>
+struct MemoryList {
+private:
+    struct MemoryBlock {
+    public:
+        MemoryBlock(SizeT const _start, SizeT const _first, MemoryBlockType const _type) {
+            start = _start;
+            first = _first;
+            last = _first;
+            type = _type;
+        }
+
+        // Address of the first slot
+        SizeT start;
+        // Range in the storage of the block type
+        SizeT first;
+        SizeT last;
+        MemoryBlockType type;
+    };
+
+public:
+    /// <summary>The number of stride slots in one block, so every offset fits in 16 bits.</summary>
+    static constexpr SizeT BlockSlots = 0x10000;
+
+    /// <summary>Visits the runs of addresses in ascending order, invalidated when the list changes.</summary>
+    struct Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = MemoryRegion<T>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = MemoryRegion<T> const*;
+        using reference = MemoryRegion<T> const&;
+
+        Iterator(MemoryList<T> const* memoryList, SizeT const block) : _memoryList(memoryList), _block(block) {
+            Load();
+        }
+
+        inline reference operator*() const noexcept {
+            return _region;
+        }
+
+        inline pointer operator->() const noexcept {
+            return &_region;
+        }
+
+        inline Iterator& operator++() {
+            _position = _next;
+            Load();
+            return *this;
+        }
+
+        inline Iterator operator++(int) {
+            Iterator it = *this;
+            ++(*this);
+            return it;
+        }
+
+        inline Boolean operator==(Iterator const& other) const noexcept {
+            return (_block == other._block) && (_position == other._position);
+        }
+
+        inline Boolean operator!=(Iterator const& other) const noexcept {
+            return !(*this == other);
+        }
+
+    private:
+        /// <summary>Finds the run at the current position, moving on to the next blocks if this block has no more runs.</summary>
+        void Load() {
+            std::vector<MemoryBlock> const& blocks = _memoryList->_blocks;
+
+            for(; _block < blocks.size(); ++_block, _position = 0) {
+                MemoryBlock const& block = blocks[_block];
+
+                if(block.type == MemoryBlockType::Regions) {
+                    if((block.first + _position) < block.last) {
+                        _region = _memoryList->_regions[block.first + _position];
+                        _next = _position + 1;
+                        return;
+                    }
+                }
+                else if(block.type == MemoryBlockType::Offsets) {
+                    std::vector<UInt16> const& offsets = _memoryList->_offsets;
+
+                    SizeT const i = block.first + _position;
+                    if(i < block.last) {
+                        SizeT j = i + 1;
+                        while((j < block.last) && (offsets[j] == (offsets[j - 1] + 1))) {
+                            ++j;
+                        }
+
+                        _region = MemoryRegion<T>(block.start + (offsets[i] * _memoryList->_stride), (j - i) * _memoryList->_stride);
+                        _next = j - block.first;
+                        return;
+                    }
+                }
+                else {
+                    SizeT const slots = (block.last - block.first) * 64;
+                    SizeT const start = FindBit(block, _position, true);
+                    if(start < slots) {
+                        SizeT const end = FindBit(block, start, false);
+
+                        _region = MemoryRegion<T>(block.start + (start * _memoryList->_stride), (end - start) * _memoryList->_stride);
+                        _next = end;
+                        return;
+                    }
+                }
+            }
+
+            _position = 0;
+        }
+
+        /// <returns>The first slot from slot on that is set (or clear), or the number of slots in the bitmap.</returns>
+        SizeT FindBit(MemoryBlock const& block, SizeT const slot, Boolean const set) const {
+            std::vector<UInt64> const& bits = _memoryList->_bits;
+
+            for(SizeT word = block.first + (slot / 64); word < block.last; ++word) {
+                UInt64 value = set ? bits[word] : ~bits[word];
+                if(word == (block.first + (slot / 64))) {
+                    value &= ~static_cast<UInt64>(0) << (slot % 64);
+                }
+
+                if(value != 0) {
+                    return ((word - block.first) * 64) + static_cast<SizeT>(std::countr_zero(value));
+                }
+            }
+
+            return (block.last - block.first) * 64;
+        }
+
+        MemoryList<T> const* _memoryList;
+        SizeT _block;
+        SizeT _position = 0;
+        SizeT _next = 0;
+        MemoryRegion<T> _region = MemoryRegion<T>(0, 0);
+    };
+
+    inline MemoryList(SizeT const stride) {
+        _stride = stride;
+    }
+
+    inline SizeT GetStride() const noexcept {
+        return _stride;
+    }
+
+    /// <returns>The total size of addresses listed.</returns>
+    inline SizeT GetSize() const noexcept {
+        return _size / _stride;
+    }
+
+    /// <returns>How much the data is fragmented in range from 0 to 1. The number of regions over the total size (GetSize)</returns>
+    inline Float32 GetFragmentation() const {
+        SizeT regionCount = 0;
+        for(Iterator it = begin(), e = end(); it != e; ++it) {
+            ++regionCount;
+        }
+        return static_cast<Float32>(regionCount) / static_cast<Float32>(max(GetSize(), static_cast<SizeT>(1)));
+    }
+
+    /// <returns>The number of bytes used to store the addresses.</returns>
+    inline SizeT GetMemoryUsage() const noexcept {
+        return (_blocks.capacity() * sizeof(MemoryBlock)) + (_regions.capacity() * sizeof(MemoryRegion<T>)) + (_bits.capacity() * sizeof(UInt64)) + (_offsets.capacity() * sizeof(UInt16));
+    }
+
+    /// <summary>If you need to get the first n of addresses then use GetFirstAddresses, GetFirstAddresses uses much less memory and processing power.</summary>
+    /// <returns>A vector with all addresses in a contiguous ascending manner.</returns>
+    inline std::vector<SizeT> const GetAllAddresses() const {
+        std::vector<SizeT> addresses = std::vector<SizeT>();
+        for(MemoryRegion<T> const& memoryRegion : *this) {
+            for(SizeT i = memoryRegion.GetStart(), e = memoryRegion.GetEnd(); i < e; i += _stride) {
+                addresses.push_back(i);
+            }
+        }
+        return addresses;
+    }
+
+    /// <returns>A vector with specified number of addresses from the first address in a contiguous ascending manner.</returns>
+    inline std::vector<SizeT> const GetFirstAddresses(SizeT count) const {
+        std::vector<SizeT> addresses = std::vector<SizeT>();
+        SizeT addressCount = 0;
+        for(MemoryRegion<T> const& memoryRegion : *this) {
+            for(SizeT i = memoryRegion.GetStart(), e = memoryRegion.GetEnd(); i < e; i += _stride) {
+                addresses.push_back(i);
+
+                ++addressCount;
+                if(addressCount >= count) {
+                    return addresses;
+                }
+            }
+        }
+        return addresses;
+    }
+
+    /// <summary>
+    /// <para>Adds a memory region to this list, a region that continues the last region extends it in place.</para>
+    /// <para>Regions MUST be added in ascending order.</para>
+    /// </summary>
+    inline void AddRegion(MemoryRegion<T> memoryRegion) {
+        _size += memoryRegion.GetSize();
+
+        if(!_blocks.empty() && (_blocks.back().type == MemoryBlockType::Regions) && (_regions.back().GetEnd() == memoryRegion.GetStart())) {
+            _regions.back().SetEnd(memoryRegion.GetEnd());
+            return;
+        }
+
+        if(_blocks.empty() || (_blocks.back().type != MemoryBlockType::Regions) || (memoryRegion.GetStart() >= (_blocks.back().start + (BlockSlots * _stride)))) {
+            SealBlock();
+            _blocks.push_back(MemoryBlock(memoryRegion.GetStart(), _regions.size(), MemoryBlockType::Regions));
+        }
+
+        _regions.push_back(memoryRegion);
+        ++_blocks.back().last;
+    }
+
+    /// <summary>
+    /// <para>Adds a memory address to this list. (Implicitly converted to a memory region.)</para>
+    /// <para>Addresses MUST be added in ascending order.</para>
+    /// </summary>
+    inline void AddAddress(SizeT address) {
+        AddRegion(MemoryRegion<T>(address, _stride));
+    }
+
+    /// <summary>
+    /// <para>Adds all memory regions of another list with the same stride to this list, without copying them region by region.</para>
+    /// <para>Lists may be appended in any order as long as they do not overlap, e.g. in the order parallel workers finish. Call Compact before adding or reading anything else.</para>
+    /// </summary>
+    inline void AppendList(MemoryList<T> const& memoryList) {
+        SealBlock();
+
+        for(MemoryBlock block : memoryList._blocks) {
+            SizeT const first = block.first;
+            SizeT const last = block.last;
+
+            if(block.type == MemoryBlockType::Regions) {
+                block.first = _regions.size();
+                _regions.insert(_regions.end(), memoryList._regions.begin() + first, memoryList._regions.begin() + last);
+            }
+            else if(block.type == MemoryBlockType::Bitmap) {
+                block.first = _bits.size();
+                _bits.insert(_bits.end(), memoryList._bits.begin() + first, memoryList._bits.begin() + last);
+            }
+            else {
+                block.first = _offsets.size();
+                _offsets.insert(_offsets.end(), memoryList._offsets.begin() + first, memoryList._offsets.begin() + last);
+            }
+
+            block.last = block.first + (last - first);
+            _blocks.push_back(block);
+        }
+
+        _size += memoryList._size;
+    }
+
+    /// <summary>Clears the memory regions in this list.</summary>
+    inline void ClearRegions() {
+        _blocks.clear();
+        _regions.clear();
+        _bits.clear();
+        _offsets.clear();
+        _size = 0;
+    }
+
+    /// <summary>
+    /// <para>Sorts appended lists into place, merges regions that continue each other across them and stores every block in its smallest form.</para>
+    /// <para>Takes linear time in the number of regions, plus sorting the blocks.</para>
+    /// </summary>
+    inline void Compact() {
+        SealBlock();
+
+        std::sort(_blocks.begin(), _blocks.end(), [](MemoryBlock const& a, MemoryBlock const& b) {
+            return a.start < b.start;
+        });
+
+        // Adding every region again in order merges the regions where two appended lists meet
+        MemoryList<T> memoryList = MemoryList<T>(_stride);
+        for(MemoryRegion<T> const& memoryRegion : *this) {
+            memoryList.AddRegion(memoryRegion);
+        }
+        memoryList.SealBlock();
+
+        // Building leaves room for a whole block of single addresses
+        memoryList._blocks.shrink_to_fit();
+        memoryList._regions.shrink_to_fit();
+        memoryList._bits.shrink_to_fit();
+        memoryList._offsets.shrink_to_fit();
+
+        *this = std::move(memoryList);
+    }
+
+    /// <summary>
+    /// <para>Calls visitor(MemoryBlockType type, SizeT start, void const* storage, SizeT count) for every block in ascending order, with the storage of the block as it is kept: count MemoryRegion, UInt64 bitmap words or UInt16 offsets.</para>
+    /// <para>Together with AddBlock this copies a list without visiting its addresses one by one, e.g. to write it to a file. Call Compact first if lists were appended.</para>
+    /// </summary>
+    template<typename Visitor>
+    void ForEachBlock(Visitor&& visitor) const {
+        for(MemoryBlock const& block : _blocks) {
+            if(block.type == MemoryBlockType::Regions) {
+                visitor(block.type, block.start, static_cast<void const*>(_regions.data() + block.first), block.last - block.first);
+            }
+            else if(block.type == MemoryBlockType::Bitmap) {
+                visitor(block.type, block.start, static_cast<void const*>(_bits.data() + block.first), block.last - block.first);
+            }
+            else {
+                visitor(block.type, block.start, static_cast<void const*>(_offsets.data() + block.first), block.last - block.first);
+            }
+        }
+    }
+
+    /// <summary>
+    /// <para>Adds a block given the way ForEachBlock visits it, moved to start. The regions of a Regions block are moved by the same distance, from storageStart to start.</para>
+    /// <para>Blocks MUST be added in ascending order and not overlap, like regions.</para>
+    /// </summary>
+    /// <param name="storageStart">The start of the block the regions were visited with, or 0 if their starts are offsets from the block.</param>
+    void AddBlock(MemoryBlockType const type, SizeT const start, void const* storage, SizeT const count, SizeT const storageStart) {
+        if(count == 0) {
+            return;
+        }
+
+        SealBlock();
+
+        if(type == MemoryBlockType::Regions) {
+            MemoryRegion<T> const* regions = static_cast<MemoryRegion<T> const*>(storage);
+
+            _blocks.push_back(MemoryBlock(start, _regions.size(), type));
+            for(SizeT i = 0; i < count; ++i) {
+                _regions.push_back(MemoryRegion<T>(regions[i].GetStart() - storageStart + start, regions[i].GetSize()));
+                _size += regions[i].GetSize();
+            }
+            _blocks.back().last = _regions.size();
+        }
+        else if(type == MemoryBlockType::Bitmap) {
+            UInt64 const* bits = static_cast<UInt64 const*>(storage);
+
+            _blocks.push_back(MemoryBlock(start, _bits.size(), type));
+            _bits.insert(_bits.end(), bits, bits + count);
+            for(SizeT i = 0; i < count; ++i) {
+                _size += static_cast<SizeT>(std::popcount(bits[i])) * _stride;
+            }
+            _blocks.back().last = _bits.size();
+        }
+        else {
+            UInt16 const* offsets = static_cast<UInt16 const*>(storage);
+
+            _blocks.push_back(MemoryBlock(start, _offsets.size(), type));
+            _offsets.insert(_offsets.end(), offsets, offsets + count);
+            _size += count * _stride;
+            _blocks.back().last = _offsets.size();
+        }
+    }
+
+    inline Iterator begin() const {
+        return Iterator(this, 0);
+    }
+
+    inline Iterator end() const {
+        return Iterator(this, _blocks.size());
+    }
+
+private:
+    /// <summary>Converts the last block to whichever form takes the least memory. Only the last block can still be regions that were not merged.</summary>
+    void SealBlock() {
+        if(_blocks.empty() || (_blocks.back().type != MemoryBlockType::Regions)) {
+            return;
+        }
+
+        MemoryBlock& block = _blocks.back();
+
+        // Regions are already merged as they are added, check if every region fits in the slots of the block
+        SizeT count = 0;
+        Boolean slotted = true;
+        for(SizeT i = block.first; i < block.last; ++i) {
+            MemoryRegion<T> const& memoryRegion = _regions[i];
+
+            count += memoryRegion.GetSize() / _stride;
+            slotted = slotted && (((memoryRegion.GetStart() - block.start) % _stride) == 0) && ((memoryRegion.GetSize() % _stride) == 0);
+        }
+
+        SizeT const slots = (_regions[block.last - 1].GetEnd() - block.start + _stride - 1) / _stride;
+        if(!slotted || (slots > BlockSlots)) {
+            return;
+        }
+
+        SizeT const regionsUsage = (block.last - block.first) * sizeof(MemoryRegion<T>);
+        SizeT const bitmapUsage = ((slots + 63) / 64) * sizeof(UInt64);
+        SizeT const offsetsUsage = count * sizeof(UInt16);
+
+        if((regionsUsage <= bitmapUsage) && (regionsUsage <= offsetsUsage)) {
+            return;
+        }
+
+        if(bitmapUsage <= offsetsUsage) {
+            SizeT const first = _bits.size();
+            _bits.resize(first + ((slots + 63) / 64), 0);
+
+            for(SizeT i = block.first; i < block.last; ++i) {
+                for(SizeT p = _regions[i].GetStart(), e = _regions[i].GetEnd(); p < e; p += _stride) {
+                    SizeT const slot = (p - block.start) / _stride;
+                    _bits[first + (slot / 64)] |= static_cast<UInt64>(1) << (slot % 64);
+                }
+            }
+
+            _regions.erase(_regions.begin() + block.first, _regions.end());
+            block = MemoryBlock(block.start, first, MemoryBlockType::Bitmap);
+            block.last = _bits.size();
+        }
+        else {
+            SizeT const first = _offsets.size();
+
+            for(SizeT i = block.first; i < block.last; ++i) {
+                for(SizeT p = _regions[i].GetStart(), e = _regions[i].GetEnd(); p < e; p += _stride) {
+                    _offsets.push_back(static_cast<UInt16>((p - block.start) / _stride));
+                }
+            }
+
+            _regions.erase(_regions.begin() + block.first, _regions.end());
+            block = MemoryBlock(block.start, first, MemoryBlockType::Offsets);
+            block.last = _offsets.size();
+        }
+    }
+
+    SizeT _stride;
+    // Sum of the region sizes
+    SizeT _size = 0;
+
+    std::vector<MemoryBlock> _blocks = std::vector<MemoryBlock>();
+    std::vector<MemoryRegion<T>> _regions = std::vector<MemoryRegion<T>>();
+    std::vector<UInt64> _bits = std::vector<UInt64>();
+    std::vector<UInt16> _offsets = std::vector<UInt16>();
+};
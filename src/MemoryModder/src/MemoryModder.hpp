@@ -3,259 +3,98 @@
 */
 
 // TODO: Research into DLL injection
-// TODO: Use base addresses???
-// TODO: Minimize ReadProcessMemory calls when filtering by getting all chunks and then only using the needed values to compare
-// ^ Performance test proved that ReadProcessMemory was taking up 99% and comparison was 1%
 
 #pragma once
 
+#include <chrono>
+#include <cstring>
 #include <vector>
 #include <algorithm>
-
-#include <Windows.h>
-#include <Psapi.h>
-#include <WtsApi32.h>
+#include <numeric>
+#include <span>
+#include <utility>
 
 #include "Types.hpp"
-
-struct Process {
-public:
-    Process(String const& name, DWORD const id) {
-        _name = name;
-        _id = id;
-    }
-
-    String GetName() const {
-        return _name;
-    }
-
-    DWORD GetId() const {
-        return _id;
-    }
-
-private:
-    String _name;
-    DWORD _id;
-};
-
-// TODO: Don't use WTS to get all processes.
-std::vector<Process> GetAllProcesses() {
-    std::vector<Process> processes = std::vector<Process>();
-
-    WTS_PROCESS_INFOA* pWPIs = NULL;
-    DWORD dwProcCount = 0;
-    if(WTSEnumerateProcessesA(WTS_CURRENT_SERVER_HANDLE, NULL, 1, &pWPIs, &dwProcCount)) {
-        // Go through all processes retrieved
-        for(DWORD i = 0; i < dwProcCount; ++i) {
-            WTS_PROCESS_INFOA& pWPI = pWPIs[i];
-
-            processes.push_back(Process(pWPI.pProcessName, pWPI.ProcessId));
-        }
-    }
-
-    // Free memory
-    if(pWPIs != NULL) {
-        WTSFreeMemory(pWPIs);
-        pWPIs = NULL;
-    }
-
-    return processes;
+#include "Platform.hpp"
+#include "BytePattern.hpp"
+#include "Compare.hpp"
+#include "CompareKernels.hpp"
+#include "DirtyPages.hpp"
+#include "DumpMemory.hpp"
+#include "FreezeEngine.hpp"
+#include "GroupPattern.hpp"
+#include "MemoryList.hpp"
+#include "Module.hpp"
+#include "PageCache.hpp"
+#include "PointerMap.hpp"
+#include "Process.hpp"
+#include "ProcessMemory.hpp"
+#include "ReadPlanner.hpp"
+#include "ReadRequest.hpp"
+#include "RegionMap.hpp"
+#include "SnapshotDiff.hpp"
+#include "ThreadPool.hpp"
+#include "ValueIndex.hpp"
+
+/// <returns>Every process running on this machine.</returns>
+inline std::vector<Process> GetAllProcesses() {
+    return ProcessMemory::GetProcesses();
 }
 
-DWORD_PTR GetProcessBaseAddress(HANDLE processHandle) {
-    DWORD_PTR baseAddress = 0;
-
-    HMODULE* moduleArray;
-    LPBYTE moduleArrayBytes;
-    DWORD bytesRequired;
-
-    if(EnumProcessModules(processHandle, NULL, 0, &bytesRequired)) {
-        if(bytesRequired) {
-            moduleArrayBytes = (LPBYTE)LocalAlloc(LPTR, bytesRequired);
-
-            if(moduleArrayBytes) {
-                unsigned int moduleCount;
-
-                moduleCount = bytesRequired / sizeof(HMODULE);
-                moduleArray = (HMODULE*)moduleArrayBytes;
-
-                if(EnumProcessModules(processHandle, moduleArray, bytesRequired, &bytesRequired)) {
-                    baseAddress = (DWORD_PTR)moduleArray[0];
-                }
-
-                LocalFree(moduleArrayBytes);
-            }
-        }
-    }
-
-    return baseAddress;
-}
-
-enum struct MemoryComparison : Int8 {
-    Equals = 0,
-    NotEquals = 1,
-    LessThan = 2,
-    GreaterThan = 3,
-    LessThanEquals = 4,
-    GreaterThanEquals = 5
+/// <summary>Whether one address of ReadMany was read.</summary>
+enum struct ReadStatus : UInt8 {
+    Success = 0,
+    Failed = 1
 };
 
+/// <summary>A piece of a memory list that is read by a single thread.</summary>
 template<typename T>
-struct MemoryRegion {
+struct ReadTask {
 public:
-    MemoryRegion(SizeT start, SizeT size) {
-        _start = start;
-        _size = size;
-    }
-
-    inline SizeT GetStart() const noexcept {
-        return _start;
-    }
-
-    inline void SetStart(SizeT start) noexcept {
-        _start = start;
-    }
-
-    inline SizeT GetSize() const noexcept {
-        return _size;
-    }
-
-    inline void SetSize(SizeT size) noexcept {
-        _size = size;
+    ReadTask(typename MemoryList<T>::Iterator const _region, SizeT const _start, SizeT const _index) : region(_region) {
+        start = _start;
+        index = _index;
     }
 
-    inline SizeT GetEnd() const noexcept {
-        return _start + _size;
-    }
-
-    inline void SetEnd(SizeT end) noexcept {
-        _size = end - _start;
-    }
+    /// <summary>The first region of the task.</summary>
+    typename MemoryList<T>::Iterator region;
 
-    inline Boolean IsInside(SizeT pos) const noexcept {
-        return ((pos >= _start) && (pos < (_start + _size)));
-    }
+    /// <summary>The task starts at this address, which may be inside its first region.</summary>
+    SizeT start;
 
-private:
-    SizeT _start;
-    SizeT _size;
+    /// <summary>Index of the address at start, counting from the first address of the list.</summary>
+    SizeT index;
 };
 
+/// <summary>
+/// <para>A memory list cut into pieces of work that can be read by separate threads.</para>
+/// <para>Tasks only point into the list, so the list MUST stay unchanged while they are used.</para>
+/// </summary>
 template<typename T>
-struct MemoryList {
+struct ReadTasks {
 public:
-    inline MemoryList(SizeT const stride) {
-        _stride = stride;
-    }
-
-    inline SizeT GetStride() const noexcept {
-        return _stride;
-    }
-
-    /// <returns>The total size of addresses listed.</returns>
-    inline SizeT GetSize() const {
-        SizeT size = 0;
-        for(MemoryRegion<T> const& memoryRegion : memoryRegions) {
-            size += memoryRegion.GetSize();
-        }
-        return size / _stride;
-    }
-
-    /// <returns>How much the data is fragmented in range from 0 to 1. The number of regions over the total size (GetSize)</returns>
-    inline Float32 GetFragmentation() const {
-        return static_cast<Float32>(memoryRegions.size()) / static_cast<Float32>(max(GetSize(), 1));
-    }
-    
-    /// <summary>If you need to get the first n of addresses then use GetFirstAddresses, GetFirstAddresses uses much less memory and processing power.</summary>
-    /// <returns>A vector with all addresses in a contiguous ascending manner.</returns>
-    inline std::vector<SizeT> const GetAllAddresses() const {
-        std::vector<SizeT> addresses = std::vector<SizeT>();
-        for(MemoryRegion<T> const& memoryRegion : memoryRegions) {
-            for(SizeT i = memoryRegion.GetStart(), e = memoryRegion.GetEnd(); i < e; i += _stride) {
-                addresses.push_back(i);
-            }
-        }
-        return addresses;
-    }
+    /// <summary>Every task ends where the next one starts.</summary>
+    std::vector<ReadTask<T>> tasks = std::vector<ReadTask<T>>();
 
-    /// <returns>A vector with specified number of addresses from the first address in a contiguous ascending manner.</returns>
-    inline std::vector<SizeT> const GetFirstAddresses(SizeT count) const {
-        std::vector<SizeT> addresses = std::vector<SizeT>();
-        SizeT addressCount = 0;
-        for(MemoryRegion<T> const& memoryRegion : memoryRegions) {
-            for(SizeT i = memoryRegion.GetStart(), e = memoryRegion.GetEnd(); i < e; i += _stride) {
-                addresses.push_back(i);
-
-                ++addressCount;
-                if(addressCount >= count) {
-                    return addresses;
-                }
-            }
-        }
-        return addresses;
-    }
+    /// <summary>The number of addresses in all tasks, the index after the last address.</summary>
+    SizeT addressCount = 0;
 
-    /// <summary>
-    /// <para>Adds a memory region to this list.</para>
-    /// <para>Regions MUST be added in ascending order.</para>
-    /// </summary>
-    inline void AddRegion(MemoryRegion<T> memoryRegion) {
-        memoryRegions.push_back(memoryRegion);
+    inline SizeT GetCount() const noexcept {
+        return tasks.size();
     }
 
-    /// <summary>
-    /// <para>Adds a memory address to this list. (Implicitly converted to a memory region.)</para>
-    /// <para>Addresses MUST be added in ascending order.</para>
-    /// </summary>
-    inline void AddAddress(SizeT address) {
-        memoryRegions.push_back(MemoryRegion<T>(address, _stride));
+    /// <returns>The address where this task ends.</returns>
+    inline SizeT GetEnd(SizeT const task) const noexcept {
+        return ((task + 1) < tasks.size()) ? tasks[task + 1].start : ~static_cast<SizeT>(0);
     }
-
-    /// <summary>Clears the memory regions in this list.</summary>
-    inline void ClearRegions() {
-        memoryRegions.clear();
-    }
-
-    /// <summary>
-    /// <para>Merges neighbouring regions if possible, and saves memory.</para>
-    /// <para>Unlikely to merge anything most of the time, regions are usually not neighbouring/conflicting.</para>
-    /// <para>Currently the FilterList method in MemoryModder makes use of this method. I'm currently too lazy to implement a performant solution at the moment.</para>
-    /// </summary>
-    inline void MergeRegions() {
-        for(SizeT i = 0; i < memoryRegions.size(); ++i) {
-            MemoryRegion<T>& memoryRegion = memoryRegions[i];
-
-            for(SizeT i2 = i; i2 < memoryRegions.size();) {
-                MemoryRegion<T>& memoryRegion2 = memoryRegions[i2];
-
-                if(memoryRegion.GetEnd() == memoryRegion2.GetStart()) {
-                    memoryRegion.SetEnd(memoryRegion2.GetEnd());
-
-                    typename std::vector<MemoryRegion<T>>::iterator it = memoryRegions.begin();
-                    std::advance(it, i2);
-                    memoryRegions.erase(it);
-                }
-                else {
-                    break;
-                }
-            }
-        }
-    }
-
-    inline std::vector<MemoryRegion<T>>::const_iterator begin() const {
-        return memoryRegions.begin();
-    }
-
-    inline std::vector<MemoryRegion<T>>::const_iterator end() const {
-        return memoryRegions.end();
-    }
-
-private:
-    SizeT _stride;
-    std::vector<MemoryRegion<T>> memoryRegions = std::vector<MemoryRegion<T>>();
 };
 
-struct MemoryModder {
+/// <summary>
+/// <para>Reads, writes and searches the memory of another process through a backend, see ProcessMemory.hpp.</para>
+/// <para>Use MemoryModder for the processes of this platform.</para>
+/// </summary>
+template<typename Memory>
+struct BasicMemoryModder {
 public:
     /// <summary>
     /// <para>Creates a new memory modder for this processId.</para>
@@ -263,62 +102,53 @@ public:
     /// <para>(Int8)1: The process cannot be used.</para>
     /// <para>(Int8)2: The process has stopped running.</para>
     /// </summary>
-    MemoryModder(DWORD processId) {
-        if(processId == GetCurrentProcessId()) {
-            // Prevent using own process because fetching all memory will allocate forever.
-            throw (Int8)1;
-        }
-
-        HANDLE processHandle = OpenProcess(PROCESS_ALL_ACCESS, TRUE, processId);
+    BasicMemoryModder(SizeT const processId) : _memory(processId) {
+        // Every worker reads into its own buffer
+        _readPlanners.resize(_threadPool.GetWorkerCount());
+    }
 
-        // Confirm that the process is still running
-        if(processHandle == NULL) {
-#pragma warning(suppress: 6387)
-            CloseHandle(processHandle);
-            SetLastError(NO_ERROR);
-            throw (Int8)1;
-        }
+    /// <summary>
+    /// <para>Creates a new memory modder for the file at path, for backends like DumpMemory that read a file instead of a process.</para>
+    /// <para>Possible exceptions:</para>
+    /// <para>(Int8)1: The file cannot be used.</para>
+    /// </summary>
+    BasicMemoryModder(String const& path) : _memory(path) {
+        _readPlanners.resize(_threadPool.GetWorkerCount());
+    }
 
-        DWORD exitCode = (DWORD)0;
-        if(GetExitCodeProcess(processHandle, &exitCode) == FALSE) {
-            CloseHandle(processHandle);
-            SetLastError(NO_ERROR);
-            throw (Int8)2;
-        }
-        if(exitCode != STILL_ACTIVE) {
-            CloseHandle(processHandle);
-            throw (Int8)2;
-        }
+    BasicMemoryModder(BasicMemoryModder const&) = delete;
+    BasicMemoryModder& operator=(BasicMemoryModder const&) = delete;
 
-        _processId = processId;
-        _processHandle = processHandle;
+    ~BasicMemoryModder() {
+        // The freeze thread writes to the process
+        _freezeEngine.Stop();
+    }
 
-        // Get process name
-        SizeT const bufSize = 256;
-        char* buf = new char[bufSize];
-        GetModuleBaseNameA(processHandle, NULL, buf, bufSize);
-        _processName = String(buf);
-        delete[] buf;
+    SizeT GetProcessId() const {
+        return _memory.GetProcessId();
+    }
 
-        _processBaseAddress = static_cast<SizeT>(GetProcessBaseAddress(processHandle));
+    String GetProcessName() const {
+        return _memory.GetProcessName();
     }
 
-    ~MemoryModder() {
-        if(_processHandle != nullptr) {
-            CloseHandle(_processHandle);
-        }
+    SizeT GetBaseAddress() const {
+        return _memory.GetBaseAddress();
     }
 
-    DWORD GetProcessId() const {
-        return _processId;
+    /// <returns>Every module loaded into the process, the executable first.</returns>
+    std::vector<Module> GetModules() const {
+        return _memory.GetModules();
     }
 
-    String GetProcessName() const {
-        return _processName;
+    /// <returns>The backend the process is read and written through.</returns>
+    Memory const& GetMemory() const noexcept {
+        return _memory;
     }
 
-    SizeT GetBaseAddress() const {
-        return _processBaseAddress;
+    /// <returns>The number of threads reading in parallel.</returns>
+    SizeT GetWorkerCount() const noexcept {
+        return _threadPool.GetWorkerCount();
     }
 
     /// <summary>
@@ -334,12 +164,137 @@ public:
         SizeT const size = sizeof(T);
         SizeT sizeRead;
 
-        if(ReadProcessMemory(_processHandle, (LPCVOID)address/*(address + _processBaseAddress)*/, (LPVOID)(&data), size, &sizeRead) == FALSE) throw (Int8)1;
+        if(ReadCached(address, size, reinterpret_cast<UInt8*>(&data))) {
+            return data;
+        }
+
+        sizeRead = _memory.Read(address, size, reinterpret_cast<UInt8*>(&data));
+        if(sizeRead == 0) throw (Int8)1;
         if(size != sizeRead) throw (Int8)2;
 
         return data;
     }
 
+    /// <summary>
+    /// <para>Reads a value at every address, addresses on the same or nearby pages are read with a single call.</para>
+    /// <para>values[i] and statuses[i] belong to addresses[i], values of addresses that could not be read are left as they were. Only as many addresses as all three spans hold are read.</para>
+    /// <para>Possible exceptions:</para>
+    /// <para>None for addresses that cannot be read, statuses tells why. Only running out of memory for the read plan throws.</para>
+    /// </summary>
+    /// <returns>The number of values read.</returns>
+    template<typename T>
+    SizeT ReadMany(std::span<SizeT const> const addresses, std::span<T> const values, std::span<ReadStatus> const statuses) const {
+        SizeT const count = min(addresses.size(), min(values.size(), statuses.size()));
+
+        // Reads go in address order, results in the order of the addresses
+        std::vector<SizeT> order = std::vector<SizeT>(count);
+        std::iota(order.begin(), order.end(), static_cast<SizeT>(0));
+        if(!std::is_sorted(addresses.begin(), addresses.begin() + count)) {
+            std::stable_sort(order.begin(), order.end(), [&addresses](SizeT const a, SizeT const b) {
+                return addresses[a] < addresses[b];
+            });
+        }
+
+        for(SizeT index = 0; index < count; ++index) {
+            statuses[index] = ReadStatus::Failed;
+        }
+
+        // Values are sparse, so windows only span a page of unused bytes and stay small
+        constexpr SizeT pageSize = 0x1000;
+        constexpr SizeT maxWindowSize = 0x10000;
+        // Windows are read in batches, backends that read several ranges with one call need one call per batch
+        constexpr SizeT maxBatchCount = 0x400;
+        constexpr SizeT maxBatchSize = 0x100000;
+        std::vector<UInt8> buffer = std::vector<UInt8>(max(maxBatchSize, pageSize + sizeof(T)));
+
+        SizeT readCount = 0;
+        auto const copyRun = [&](SizeT const first, SizeT const last, SizeT const start, UInt8 const* data) {
+            for(SizeT i = first; i < last; ++i) {
+                memcpy(&values[order[i]], data + (addresses[order[i]] - start), sizeof(T));
+                statuses[order[i]] = ReadStatus::Success;
+                ++readCount;
+            }
+        };
+        auto const readRun = [&](SizeT const first, SizeT const last, SizeT const start, SizeT const end, UInt8* data) -> Boolean {
+            if(ReadChunk(start, end - start, data) != (end - start)) {
+                return false;
+            }
+            copyRun(first, last, start, data);
+            return true;
+        };
+
+        // First and last value of every window of the batch
+        std::vector<ReadRequest> requests = std::vector<ReadRequest>();
+        std::vector<std::pair<SizeT, SizeT>> runs = std::vector<std::pair<SizeT, SizeT>>();
+        SizeT batchSize = 0;
+
+        auto const readBatch = [&]() {
+            ReadChunks(requests.data(), requests.size());
+
+            for(SizeT window = 0; window < requests.size(); ++window) {
+                ReadRequest const& request = requests[window];
+                SizeT const first = runs[window].first;
+                SizeT const last = runs[window].second;
+
+                // A window cut short still holds the values before the fault
+                SizeT split = first;
+                while((split < last) && ((addresses[order[split]] + sizeof(T)) <= (request.address + request.sizeRead))) {
+                    ++split;
+                }
+                copyRun(first, split, request.address, request.data);
+
+                // Part of the window cannot be read, so every page is tried on its own, and every value if its page fails too
+                for(SizeT pageFirst = split, pageLast = split; pageFirst < last; pageFirst = pageLast) {
+                    SizeT const page = addresses[order[pageFirst]] & ~(pageSize - 1);
+                    SizeT pageEnd = addresses[order[pageFirst]] + sizeof(T);
+                    for(pageLast = pageFirst + 1; (pageLast < last) && ((addresses[order[pageLast]] & ~(pageSize - 1)) == page); ++pageLast) {
+                        pageEnd = max(pageEnd, addresses[order[pageLast]] + sizeof(T));
+                    }
+
+                    // A page holding the whole window failed already
+                    if(((pageLast - pageFirst) == (last - first)) || !readRun(pageFirst, pageLast, page, pageEnd, request.data + (page - request.address))) {
+                        for(SizeT i = pageFirst; i < pageLast; ++i) {
+                            // Unless it is the only value and starts the page, the value on its own was not tried yet
+                            if(((pageLast - pageFirst) > 1) || (addresses[order[i]] != page)) {
+                                readRun(i, i + 1, addresses[order[i]], addresses[order[i]] + sizeof(T), request.data + (addresses[order[i]] - request.address));
+                            }
+                        }
+                    }
+                }
+            }
+
+            requests.clear();
+            runs.clear();
+            batchSize = 0;
+        };
+
+        for(SizeT first = 0, last = 0; first < count; first = last) {
+            SizeT const start = addresses[order[first]] & ~(pageSize - 1);
+            SizeT end = addresses[order[first]] + sizeof(T);
+            for(last = first + 1; last < count; ++last) {
+                SizeT const address = addresses[order[last]];
+                if((address > (((end - 1) & ~(pageSize - 1)) + pageSize + pageSize)) || ((address + sizeof(T) - start) > maxWindowSize)) {
+                    break;
+                }
+                end = max(end, address + sizeof(T));
+            }
+
+            if((requests.size() == maxBatchCount) || ((batchSize + (end - start)) > buffer.size())) {
+                readBatch();
+            }
+
+            requests.push_back(ReadRequest(start, end - start, buffer.data() + batchSize));
+            runs.push_back(std::make_pair(first, last));
+            batchSize += end - start;
+        }
+
+        if(!requests.empty()) {
+            readBatch();
+        }
+
+        return readCount;
+    }
+
     /// <summary>
     /// <para>Writes a single value with specified type to address.</para>
     /// <para>Works for valuetypes and structs.</para>
@@ -352,7 +307,10 @@ public:
         SizeT const size = sizeof(T);
         SizeT sizeWritten;
 
-        if(WriteProcessMemory(_processHandle, (LPVOID)address/*(address + _processBaseAddress)*/, (LPCVOID)(&data), size, &sizeWritten) == FALSE) throw (Int8)1;
+        sizeWritten = _memory.Write(address, size, reinterpret_cast<UInt8 const*>(&data));
+        WriteCached(address, size, reinterpret_cast<UInt8 const*>(&data), size == sizeWritten);
+
+        if(sizeWritten == 0) throw (Int8)1;
         if(size != sizeWritten) throw (Int8)2;
     }
 
@@ -367,7 +325,12 @@ public:
         SizeT const _size = sizeof(T) * size;
         SizeT sizeRead;
 
-        if(ReadProcessMemory(_processHandle, (LPCVOID)address/*(address + _processBaseAddress)*/, (LPVOID)data, _size, &sizeRead) == FALSE) throw (Int8)1;
+        if(ReadCached(address, _size, reinterpret_cast<UInt8*>(data))) {
+            return;
+        }
+
+        sizeRead = _memory.Read(address, _size, reinterpret_cast<UInt8*>(data));
+        if(sizeRead == 0) throw (Int8)1;
         if(_size != sizeRead) throw (Int8)2;
     }
 
@@ -382,37 +345,193 @@ public:
         SizeT const _size = sizeof(T) * size;
         SizeT sizeWrite;
 
-        if(WriteProcessMemory(_processHandle, (LPVOID)address/*(address + _processBaseAddress)*/, (LPCVOID)data, _size, &sizeWrite) == FALSE) throw (Int8)1;
+        sizeWrite = _memory.Write(address, _size, reinterpret_cast<UInt8 const*>(data));
+        WriteCached(address, _size, reinterpret_cast<UInt8 const*>(data), _size == sizeWrite);
+
+        if(sizeWrite == 0) throw (Int8)1;
         if(_size != sizeWrite) throw (Int8)2;
     }
 
     /// <summary>
     /// <para>This method is probably unused.</para>
-    /// <para>Large applications may return A LOT of data (Your process will use the same amount of memory as the target process).</para>
+    /// <para>Large applications may return A LOT of data (Your process will use the same amount of memory as the target process), ForEachRegion reads the same memory in chunks instead.</para>
+    /// <para>Only regions allowed by the region policy are read. The addresses of the values are lost, use SaveDump to keep them.</para>
     /// </summary>
     template<typename T>
     std::vector<T> ReadAllData() {
         std::vector<T> data = std::vector<T>();
 
-        MEMORY_BASIC_INFORMATION info;
-        for(SizeT p = 0; VirtualQueryEx(_processHandle, (LPCVOID)p, &info, sizeof(info)) == sizeof(info); p += info.RegionSize) {
-            if((info.State == MEM_COMMIT) && ((info.Type == MEM_MAPPED) || (info.Type == MEM_PRIVATE))) {
-                std::vector<T> dataPage = std::vector<T>();
+        // Chunks hold whole values, so only partial values at the end of a region are left out
+        SizeT const chunkSize = max((static_cast<SizeT>(0x100000) / sizeof(T)) * sizeof(T), sizeof(T));
+        ForEachRegion([&data](SizeT const start, SizeT const end, UInt8 const* chunk, SizeT const size) -> Boolean {
+            T const* values = reinterpret_cast<T const*>(chunk);
+            data.insert(data.end(), values, values + (min(end - start, size) / sizeof(T)));
+            return true;
+        }, chunkSize);
+
+        return data;
+    }
+
+    /// <summary>
+    /// <para>Reads every region allowed by the region policy in chunks of up to chunkSize bytes and hands every chunk to the visitor, ascending.</para>
+    /// <para>visitor: Boolean(SizeT start, SizeT end, UInt8 const* data, SizeT size), data holds size bytes from start, which go past end by up to overlap bytes, so values starting before end are whole if they fit in size. Returning false stops the reading.</para>
+    /// <para>Chunks of a region start chunkSize bytes apart, nearby small regions are read together, and parts that cannot be read are skipped.</para>
+    /// <para>Only one chunk buffer is used and reused for every chunk, so the memory used stays at about chunkSize no matter how large the process is. data is only valid during the call.</para>
+    /// </summary>
+    /// <param name="overlap">Bytes read past the end of every chunk, e.g. sizeof(T) - 1 so values straddling two chunks are whole.</param>
+    /// <returns>False if the visitor stopped the reading.</returns>
+    template<typename Visitor>
+    Boolean ForEachRegion(Visitor&& visitor, SizeT const chunkSize = 0x100000, SizeT const overlap = 0) {
+        MemoryList<UInt8> const regions = CreateStridedList<UInt8>(1);
+
+        if(_chunkPlanner.GetMaxWindowSize() != chunkSize) {
+            _chunkPlanner = ReadPlanner(0x1000, 0x4000, chunkSize);
+        }
+
+        Boolean stopped = false;
+        _chunkPlanner.Read(regions.begin(), regions.end(), overlap,
+            [this](ReadRequest* requests, SizeT const count) {
+                ReadChunks(requests, count);
+            },
+            [this, &visitor, &stopped](SizeT const start, SizeT const end, UInt8 const* data, SizeT const size) {
+                if(!visitor(start, end, data, size)) {
+                    stopped = true;
+                    _chunkPlanner.Stop();
+                }
+            });
 
-                SizeT bytesRead;
-                dataPage.resize(info.RegionSize);
-                ReadProcessMemory(_processHandle, (LPCVOID)p, (LPVOID)dataPage.data(), info.RegionSize, &bytesRead);
-                dataPage.resize(bytesRead);
+        return !stopped;
+    }
 
-                data.reserve(data.size() + dataPage.size());
-                data.insert(data.end(), dataPage.begin(), dataPage.end());
+    /// <summary>
+    /// <para>Compares the memory of before with the memory now and lists the values that changed, e.g. before is the memory of a DumpModder saved before an action, and this a process or a dump after it.</para>
+    /// <para>Only memory in both is compared: the regions allowed by the region policy, cut to the regions of before. Parts that cannot be read from either are skipped.</para>
+    /// <para>Blocks of equal bytes are skipped with vector compares, and the memory is compared on the thread pool.</para>
+    /// </summary>
+    /// <param name="before">A backend, see ProcessMemory.hpp.</param>
+    /// <param name="aligned">If true, values are <code>sizeof(T)</code> bytes apart. Otherwise values start at every byte, with UInt8 every byte that changed is listed.</param>
+    template<typename T, typename Snapshot>
+    SnapshotDiff<T> Diff(Snapshot const& before, Boolean const aligned = true) {
+        SizeT const stride = aligned ? sizeof(T) : 1;
+        SnapshotDiff<T> diff = SnapshotDiff<T>(stride);
+
+        std::vector<RegionInfo> beforeRegions = std::vector<RegionInfo>();
+        before.ForEachRegion([&beforeRegions](RegionInfo const& region) {
+            beforeRegions.push_back(region);
+        });
+
+        // Both are ascending, so one pass cuts the regions to the memory in both
+        std::vector<MemoryRegion<T>> ranges = std::vector<MemoryRegion<T>>();
+        std::vector<SizeT> rangeRegions = std::vector<SizeT>();
+        MemoryList<T> memoryList = MemoryList<T>(stride);
+
+        UpdateRegions();
+        SizeT next = 0;
+        _regionMap.ForEachRegion(_regionPolicy, [&](SizeT const start, SizeT const size) {
+            SizeT const end = start + size;
+            while((next < beforeRegions.size()) && (beforeRegions[next].GetEnd() <= start)) {
+                ++next;
+            }
+
+            for(SizeT i = next; (i < beforeRegions.size()) && (beforeRegions[i].start < end); ++i) {
+                SizeT const rangeStart = AlignUp(start, max(start, beforeRegions[i].start), stride);
+                SizeT const rangeEnd = min(end, beforeRegions[i].GetEnd());
+                if(rangeStart < rangeEnd) {
+                    ranges.push_back(MemoryRegion<T>(rangeStart, rangeEnd - rangeStart));
+                    rangeRegions.push_back(diff.regions.size());
+                    memoryList.AddRegion(ranges.back());
+                }
+            }
+
+            if(!rangeRegions.empty() && (rangeRegions.back() == diff.regions.size())) {
+                diff.regions.push_back(RegionChange(start, size, 0));
+            }
+        });
+
+        // Every task builds its own list and counts, which are joined in address order afterwards
+        ReadTasks<T> const tasks = PlanReadTasks<T>(memoryList);
+        std::vector<MemoryList<T>> taskMemoryLists = std::vector<MemoryList<T>>(tasks.GetCount(), MemoryList<T>(stride));
+        std::vector<std::vector<std::pair<SizeT, SizeT>>> taskRegionCounts = std::vector<std::vector<std::pair<SizeT, SizeT>>>(tasks.GetCount());
+        std::vector<SizeT> taskComparedBytes = std::vector<SizeT>(tasks.GetCount(), 0);
+        std::vector<SizeT> taskEnds = std::vector<SizeT>(tasks.GetCount(), 0);
+        std::vector<std::vector<UInt8>> buffers = std::vector<std::vector<UInt8>>(GetWorkerCount());
+
+        ReadTasksParallel<T>(memoryList, tasks, [&](SizeT const task, SizeT const worker, SizeT const, SizeT const start, SizeT const end, UInt8 const* data, SizeT const size) {
+            std::vector<UInt8>& buffer = buffers[worker];
+            if(buffer.size() < size) {
+                buffer.resize(size);
+            }
+            SizeT const compared = min(size, before.Read(start, size, buffer.data()));
+            taskComparedBytes[task] += min(compared, end - start);
+
+            MemoryList<T>& taskMemoryList = taskMemoryLists[task];
+            std::vector<std::pair<SizeT, SizeT>>& regionCounts = taskRegionCounts[task];
+            SizeT& taskEnd = taskEnds[task];
+
+            DiffBytes(data, buffer.data(), compared, [&](SizeT const runStart, SizeT const runEnd) {
+                // A value changed if any of its bytes did, so runs reach back to the values running into them
+                SizeT const first = max(max(start, taskEnd), AlignUp(start, start + ((runStart >= (sizeof(T) - 1)) ? (runStart - sizeof(T) + 1) : 0), stride));
+                SizeT const last = AlignUp(start, min(end, start + runEnd), stride);
+                if(first < last) {
+                    taskMemoryList.AddRegion(MemoryRegion<T>(first, last - first));
+                    taskEnd = last;
+                }
+
+                // Bytes past the end are counted by the visit they belong to
+                SizeT const changedStart = start + runStart;
+                SizeT const changedEnd = min(end, start + runEnd);
+                typename std::vector<MemoryRegion<T>>::const_iterator const after = std::upper_bound(ranges.begin(), ranges.end(), changedStart, [](SizeT const address, MemoryRegion<T> const& range) {
+                    return address < range.GetStart();
+                });
+                for(SizeT range = (after == ranges.begin()) ? 0 : static_cast<SizeT>(after - ranges.begin()) - 1; (range < ranges.size()) && (ranges[range].GetStart() < changedEnd); ++range) {
+                    SizeT const rangeStart = max(changedStart, ranges[range].GetStart());
+                    SizeT const rangeEnd = min(changedEnd, ranges[range].GetEnd());
+                    if(rangeStart >= rangeEnd) {
+                        continue;
+                    }
+                    SizeT const changedSize = rangeEnd - rangeStart;
+
+                    if(!regionCounts.empty() && (regionCounts.back().first == rangeRegions[range])) {
+                        regionCounts.back().second += changedSize;
+                    }
+                    else {
+                        regionCounts.push_back(std::make_pair(rangeRegions[range], changedSize));
+                    }
+                }
+            });
+        });
+
+        for(SizeT task = 0; task < tasks.GetCount(); ++task) {
+            diff.changes.AppendList(taskMemoryLists[task]);
+            diff.comparedBytes += taskComparedBytes[task];
+            for(std::pair<SizeT, SizeT> const& regionCount : taskRegionCounts[task]) {
+                diff.regions[regionCount.first].changedBytes += regionCount.second;
+                diff.changedBytes += regionCount.second;
             }
         }
+        diff.changes.Compact();
 
-        // Sneakily just silence the error it posts for some reason
-        SetLastError(NULL);
+        for(Module const& module : GetModules()) {
+            SizeT changedBytes = 0;
+            for(RegionChange const& region : diff.regions) {
+                if(module.IsInside(region.start)) {
+                    changedBytes += region.changedBytes;
+                }
+            }
+            diff.modules.push_back(ModuleChange(module.GetName(), changedBytes));
+        }
 
-        return data;
+        return diff;
+    }
+
+    /// <summary>
+    /// <para>Writes every readable region to a dump file, which DumpModder opens to search the memory as it is now, e.g. later or on another machine.</para>
+    /// <para>Possible exceptions:</para>
+    /// <para>(Int8)1: The file cannot be written.</para>
+    /// </summary>
+    /// <param name="compress">If true, pages are compressed, see DumpMemory::Save.</param>
+    void SaveDump(String const& path, Boolean const compress = true) const {
+        DumpMemory::Save(_memory, path, compress);
     }
 
     /// <param name="aligned">If true, returned addresses are aligned with a stride of <code>sizeof(T)</code>. Otherwise addresses are aligned with a stride of 1.</param>
@@ -421,34 +540,169 @@ public:
     MemoryList<T> const CreateList(Boolean const aligned = true) {
         SizeT const stride = aligned ? sizeof(T) : 1;
 
-        return CreateList<T>(stride);
+        return CreateStridedList<T>(stride);
+    }
+
+    /// <summary>
+    /// <para>Enumerates the regions of the process again, lists created afterwards use them.</para>
+    /// <para>Lists are created from the cached regions otherwise, which are refreshed once they are older than the maximum age.</para>
+    /// </summary>
+    /// <returns>The regions that changed since the previous refresh.</returns>
+    RegionDiff RefreshRegions() {
+        return _regionMap.Refresh(_memory);
+    }
+
+    /// <returns>The cached regions of the process, refreshed first if they are too old.</returns>
+    RegionMap const& GetRegionMap() {
+        UpdateRegions();
+        return _regionMap;
+    }
+
+    /// <summary>Sets which regions lists are created from, searches of the memory of modules add MEM_IMAGE to its types.</summary>
+    void SetRegionPolicy(RegionPolicy const& policy) {
+        _regionPolicy = policy;
+    }
+
+    RegionPolicy const& GetRegionPolicy() const noexcept {
+        return _regionPolicy;
+    }
+
+    /// <summary>Sets how long the cached regions are used before they are refreshed, 0 refreshes them for every list.</summary>
+    void SetRegionMaxAge(std::chrono::milliseconds const maxAge) {
+        _regionMaxAge = maxAge;
     }
 
 private:
+    inline void UpdateRegions() {
+        if(_regionMap.IsStale(_regionMaxAge)) {
+            _regionMap.Refresh(_memory);
+        }
+    }
+
     /// <param name="stride">Addresses are aligned with a stride.</param>
     /// <returns>A vector of available addresses in this process.</returns>
+    /// <param name="images">If true, the memory of modules is included as well.</param>
     template<typename T>
-    MemoryList<T> const CreateList(SizeT const stride) {
+    MemoryList<T> const CreateStridedList(SizeT const stride, Boolean const images = false) {
         MemoryList<T> memoryList = MemoryList<T>(stride);
 
-        MEMORY_BASIC_INFORMATION info;
-        SizeT end;
-        for(SizeT p = 0; VirtualQueryEx(_processHandle, (LPCVOID)p, &info, sizeof(info)) == sizeof(info); p = end) {
-            SizeT size = info.RegionSize;
-            end = p + size;
-
-            // Run through memory that is in use, free memory would be a waste to go through.
-            if((info.State == MEM_COMMIT) && ((info.Type == MEM_MAPPED) || (info.Type == MEM_PRIVATE))) {
-                memoryList.AddRegion(MemoryRegion<T>(p, size));
-            }
+        RegionPolicy policy = _regionPolicy;
+        if(images) {
+            policy.typeMask |= MEM_IMAGE;
         }
 
-        SetLastError(NULL);
+        // Run through memory that is in use and allowed by the policy, nothing is read yet.
+        UpdateRegions();
+        _regionMap.ForEachRegion(policy, [&memoryList](SizeT const start, SizeT const size) {
+            memoryList.AddRegion(MemoryRegion<T>(start, size));
+        });
 
         return memoryList;
     }
 
 public:
+    /// <summary>
+    /// <para>Reads the memory of every region in the list, nearby regions are read together with a single call.</para>
+    /// <para>visitor: void(SizeT start, SizeT end, UInt8 const* data, SizeT size), data holds size bytes from start. Values starting before end are whole if they fit in size.</para>
+    /// <para>Regions that could not be read are skipped.</para>
+    /// </summary>
+    template<typename T, typename Visitor>
+    void ReadList(MemoryList<T> const& memoryList, Visitor&& visitor) {
+        // With a stride of 1 the value at the last address of a region continues past its end
+        SizeT const tail = sizeof(T) - min(memoryList.GetStride(), sizeof(T));
+
+        _readPlanners[0].Read(memoryList.begin(), memoryList.end(), tail,
+            [this](ReadRequest* requests, SizeT const count) {
+                ReadChunks(requests, count);
+            },
+            visitor);
+    }
+
+    /// <summary>Cuts the list into tasks of about taskSize bytes or taskRegions regions, whichever comes first.</summary>
+    template<typename T>
+    ReadTasks<T> PlanReadTasks(MemoryList<T> const& memoryList, SizeT const taskSize = 0x400000, SizeT const taskRegions = 0x4000) const {
+        ReadTasks<T> tasks = ReadTasks<T>();
+
+        SizeT const stride = memoryList.GetStride();
+        // Pieces of large regions start on a stride, so the addresses in them line up with the addresses of the whole region
+        SizeT const pieceSize = max((taskSize / stride) * stride, stride);
+
+        SizeT size = 0;
+        SizeT regionCount = 0;
+        SizeT index = 0;
+        for(typename MemoryList<T>::Iterator it = memoryList.begin(), e = memoryList.end(); it != e; ++it) {
+            // Large regions are split so idle workers can take over the rest of them
+            for(SizeT start = it->GetStart(), end = it->GetEnd(); start < end; start += pieceSize) {
+                SizeT const pieceEnd = min(start + pieceSize, end);
+
+                if(tasks.tasks.empty() || (size >= taskSize) || (regionCount >= taskRegions)) {
+                    tasks.tasks.push_back(ReadTask<T>(it, start, index));
+                    size = 0;
+                    regionCount = 0;
+                }
+
+                size += pieceEnd - start;
+                ++regionCount;
+                index += (pieceEnd - start + stride - 1) / stride;
+            }
+        }
+
+        tasks.addressCount = index;
+
+        return tasks;
+    }
+
+    /// <summary>
+    /// <para>Reads all tasks on the thread pool, see ReadList.</para>
+    /// <para>visitor: void(SizeT task, SizeT worker, SizeT index, SizeT start, SizeT end, UInt8 const* data, SizeT size), index is the index of the address at start in the list.</para>
+    /// <para>The visitor is called from several threads at once but the regions of one task are visited in order by one thread, worker is below GetWorkerCount and unique to that thread.</para>
+    /// </summary>
+    template<typename T, typename Visitor>
+    void ReadTasksParallel(MemoryList<T> const& memoryList, ReadTasks<T> const& tasks, Visitor&& visitor) {
+        // With a stride of 1 the value at the last address of a region continues past its end
+        ReadTasksParallel<T>(memoryList, tasks, sizeof(T) - min(memoryList.GetStride(), sizeof(T)), visitor);
+    }
+
+    /// <summary>Reads all tasks on the thread pool with tail bytes past the end of every region, see ReadList and ReadPlanner::Read.</summary>
+    template<typename T, typename Visitor>
+    void ReadTasksParallel(MemoryList<T> const& memoryList, ReadTasks<T> const& tasks, SizeT const tail, Visitor&& visitor) {
+        ReadTasksParallel<T>(memoryList, tasks, tail, nullptr, visitor);
+    }
+
+    /// <summary>
+    /// <para>Reads only the values of the tasks with a byte on a dirty page, see ReadTasksParallel and ReadDirtyPages.</para>
+    /// <para>The other values are still what they were when the pages were cleared, their regions are visited in order as well but with null data and a size of 0.</para>
+    /// </summary>
+    template<typename T, typename Visitor>
+    void ReadTasksParallel(MemoryList<T> const& memoryList, ReadTasks<T> const& tasks, DirtyPages const& dirtyPages, Visitor&& visitor) {
+        ReadTasksParallel<T>(memoryList, tasks, sizeof(T) - min(memoryList.GetStride(), sizeof(T)), &dirtyPages, visitor);
+    }
+
+    /// <summary>
+    /// <para>Clears which pages the process wrote, so ReadDirtyPages only finds the pages written from now on.</para>
+    /// <para>Only Linux keeps track of this for other processes, with soft-dirty bits. The pages are cleared for the whole process, so every earlier clear stops being usable.</para>
+    /// </summary>
+    /// <returns>The number of the clear to pass to ReadDirtyPages, or 0 if the pages cannot be tracked.</returns>
+    UInt64 ClearDirtyPages() {
+        if(_memory.ClearDirtyPages()) {
+            return ++_dirtyPagesClear;
+        }
+        return 0;
+    }
+
+    /// <summary>Fills dirtyPages with the pages holding addresses of the list that the process wrote since a clear, see ClearDirtyPages.</summary>
+    /// <param name="clear">The number returned by ClearDirtyPages.</param>
+    /// <returns>False if the written pages are unknown, because the pages cannot be tracked or were cleared again since.</returns>
+    template<typename T>
+    Boolean ReadDirtyPages(MemoryList<T> const& memoryList, UInt64 const clear, DirtyPages& dirtyPages) const {
+        dirtyPages.Clear();
+
+        if((clear != 0) && (clear == _dirtyPagesClear)) {
+            return _memory.ReadDirtyPages(memoryList, sizeof(T) - min(memoryList.GetStride(), sizeof(T)), dirtyPages);
+        }
+        return false;
+    }
+
     /// <returns>A filtered list of the previous list of addresses with a filter value. This can be used to find a value that has changed in this process.</returns>
     template<typename T, MemoryComparison comparison = MemoryComparison::Equals>
     MemoryList<T> const FilterList(MemoryList<T> const& memoryList, T const filter) {
@@ -460,34 +714,25 @@ public:
 
         MemoryList<T> newMemoryList = MemoryList<T>(stride);
 
-        // TODO: Test with stride != sizeof(T) to see if it works now.
-        //if(stride != sizeof(T)) {
-        //    return newMemoryList;
-        //}
-
-        for(MemoryRegion<T> const& memoryRegion : memoryList) {
-            SizeT const start = memoryRegion.GetStart();
-            SizeT const size = memoryRegion.GetSize();
+        // Every task builds its own list, which are joined in address order afterwards
+        ReadTasks<T> const tasks = PlanReadTasks<T>(memoryList);
+        std::vector<MemoryList<T>> taskMemoryLists = std::vector<MemoryList<T>>(tasks.GetCount(), MemoryList<T>(stride));
 
-            T* newValues = new T[size / sizeof(T)]; // Create a buffer for our values
+        ReadTasksParallel<T>(memoryList, tasks, [&taskMemoryLists, filter, stride](SizeT const task, SizeT const, SizeT const, SizeT const start, SizeT const end, UInt8 const* data, SizeT const size) {
+            MemoryList<T>& taskMemoryList = taskMemoryLists[task];
 
-            SizeT sizeRead;
+            SizeT const count = (size >= sizeof(T)) ? (size - sizeof(T) + 1) : 0;
+            SizeT const valueCount = (min(end - start, count) + stride - 1) / stride;
+            CompareValues<T, comparison>(data, valueCount, stride, filter, [&taskMemoryList, start, stride](SizeT const index) {
+                taskMemoryList.AddAddress(start + (index * stride));
+            });
+        });
 
-            if(ReadProcessMemory(_processHandle, (LPCVOID)start/*(start + _processBaseAddress)*/, (LPVOID)newValues, size, &sizeRead) != FALSE) {
-                for(SizeT i = 0, ie = min(size, sizeRead) - (stride - 1), p = start; i < ie; i += stride, p += stride) {
-                    T const newValue = *reinterpret_cast<T const*>(reinterpret_cast<Boolean const*>(newValues) + i);
-                    if(Compare<T, comparison>(newValue, filter)) {
-                        newMemoryList.AddAddress(p);
-                    }
-                }
-            }
-
-            delete[] newValues;
+        for(MemoryList<T> const& taskMemoryList : taskMemoryLists) {
+            newMemoryList.AppendList(taskMemoryList);
         }
 
-        newMemoryList.MergeRegions();
-
-        SetLastError(NULL);
+        newMemoryList.Compact();
 
         return newMemoryList;
     }
@@ -505,135 +750,695 @@ public:
         }
     }
 
-    // TODO: Add functionality for freezing and unfreezing a process
-    void FreezeProcess() {
-    
+    /// <returns>A filtered list of the previous list of addresses with the floats of a tolerance of the filter value counting as equal, see FloatTolerance.</returns>
+    template<typename T>
+    MemoryList<T> const FilterList(MemoryList<T> const& memoryList, T const filter, MemoryComparison const comparison, FloatTolerance const& tolerance) {
+        T low;
+        T high;
+        tolerance.GetRange<T>(filter, low, high);
+        return FilterRange<T>(memoryList, low, high, comparison);
     }
 
-    // TODO: Add functionality for freezing and unfreezing a process
-    void UnfreezeProcess() {
-    
-    }
+    /// <returns>A filtered list of the previous list of addresses, comparing with a range of values that count as equal, see CompareRange.</returns>
+    template<typename T, MemoryComparison comparison = MemoryComparison::Equals>
+    MemoryList<T> const FilterRange(MemoryList<T> const& memoryList, T const low, T const high) {
+        SizeT const stride = memoryList.GetStride();
 
-private:
-    // Newer non-switch template specialized comparison method
-    template<typename T, MemoryComparison comparison>
-    inline static Boolean Compare(T const a, T const b) {
-        if constexpr(comparison == MemoryComparison::Equals) { return Equals<T>(a, b); }
-        else if constexpr(comparison == MemoryComparison::NotEquals) { return NotEquals<T>(a, b); }
-        else if constexpr(comparison == MemoryComparison::LessThan) { return LessThan<T>(a, b); }
-        else if constexpr(comparison == MemoryComparison::GreaterThan) { return GreaterThan<T>(a, b); }
-        else if constexpr(comparison == MemoryComparison::LessThanEquals) { return LessThanEquals<T>(a, b); }
-        else if constexpr(comparison == MemoryComparison::GreaterThanEquals) { return GreaterThanEquals<T>(a, b); }
-        return false;
+        if(memoryList.GetSize() == 0) {
+            return memoryList;
+        }
+
+        MemoryList<T> newMemoryList = MemoryList<T>(stride);
+
+        ReadTasks<T> const tasks = PlanReadTasks<T>(memoryList);
+        std::vector<MemoryList<T>> taskMemoryLists = std::vector<MemoryList<T>>(tasks.GetCount(), MemoryList<T>(stride));
+
+        ReadTasksParallel<T>(memoryList, tasks, [&taskMemoryLists, low, high, stride](SizeT const task, SizeT const, SizeT const, SizeT const start, SizeT const end, UInt8 const* data, SizeT const size) {
+            MemoryList<T>& taskMemoryList = taskMemoryLists[task];
+
+            SizeT const count = (size >= sizeof(T)) ? (size - sizeof(T) + 1) : 0;
+            SizeT const valueCount = (min(end - start, count) + stride - 1) / stride;
+            CompareRangeValues<T, comparison>(data, valueCount, stride, low, high, [&taskMemoryList, start, stride](SizeT const index) {
+                taskMemoryList.AddAddress(start + (index * stride));
+            });
+        });
+
+        for(MemoryList<T> const& taskMemoryList : taskMemoryLists) {
+            newMemoryList.AppendList(taskMemoryList);
+        }
+
+        newMemoryList.Compact();
+
+        return newMemoryList;
     }
 
-    // Traditional method
     template<typename T>
-    inline static Boolean Compare(T const a, T const b, MemoryComparison const comparison) {
+    MemoryList<T> const FilterRange(MemoryList<T> const& memoryList, T const low, T const high, MemoryComparison const comparison) {
         switch(comparison) {
-        case MemoryComparison::Equals: return Compare<T, MemoryComparison::Equals>(a, b);
-        case MemoryComparison::NotEquals: return Compare<T, MemoryComparison::NotEquals>(a, b);
-        case MemoryComparison::LessThan: return Compare<T, MemoryComparison::LessThan>(a, b);
-        case MemoryComparison::GreaterThan: return Compare<T, MemoryComparison::GreaterThan>(a, b);
-        case MemoryComparison::LessThanEquals: return Compare<T, MemoryComparison::LessThanEquals>(a, b);
-        case MemoryComparison::GreaterThanEquals: return Compare<T, MemoryComparison::GreaterThanEquals>(a, b);
-        default: return false;
+        case MemoryComparison::Equals: return FilterRange<T, MemoryComparison::Equals>(memoryList, low, high);
+        case MemoryComparison::NotEquals: return FilterRange<T, MemoryComparison::NotEquals>(memoryList, low, high);
+        case MemoryComparison::LessThan: return FilterRange<T, MemoryComparison::LessThan>(memoryList, low, high);
+        case MemoryComparison::GreaterThan: return FilterRange<T, MemoryComparison::GreaterThan>(memoryList, low, high);
+        case MemoryComparison::LessThanEquals: return FilterRange<T, MemoryComparison::LessThanEquals>(memoryList, low, high);
+        case MemoryComparison::GreaterThanEquals: return FilterRange<T, MemoryComparison::GreaterThanEquals>(memoryList, low, high);
+        default: return FilterRange<T, MemoryComparison::Equals>(memoryList, low, high);
         }
     }
 
-    template<typename T>
-    inline static Boolean Equals(T const a, T const b) {
-        return (a == b);
+    /// <summary>
+    /// <para>Searches for a byte pattern at every address of a list with a stride of 1, e.g. of <code>CreateList&lt;UInt8&gt;(false)</code> or of a previous search.</para>
+    /// <para>Patterns that run past the end of a region are found as long as the memory after it can be read.</para>
+    /// </summary>
+    /// <returns>A list of the addresses where the pattern starts.</returns>
+    MemoryList<UInt8> const FindPattern(MemoryList<UInt8> const& memoryList, BytePattern const& pattern) {
+        MemoryList<UInt8> newMemoryList = MemoryList<UInt8>(1);
+
+        if(memoryList.GetSize() == 0) {
+            return newMemoryList;
+        }
+
+        // Leading wildcards are skipped, the compared bytes start offset bytes after every address
+        SizeT const offset = pattern.GetOffset();
+        SizeT const size = offset + pattern.GetSize();
+
+        ReadTasks<UInt8> const tasks = PlanReadTasks<UInt8>(memoryList);
+        std::vector<MemoryList<UInt8>> taskMemoryLists = std::vector<MemoryList<UInt8>>(tasks.GetCount(), MemoryList<UInt8>(1));
+
+        ReadTasksParallel<UInt8>(memoryList, tasks, size - 1, [&taskMemoryLists, &pattern, offset, size](SizeT const task, SizeT const, SizeT const, SizeT const start, SizeT const end, UInt8 const* data, SizeT const dataSize) {
+            MemoryList<UInt8>& taskMemoryList = taskMemoryLists[task];
+
+            SizeT const count = (dataSize >= size) ? min(end - start, dataSize - size + 1) : 0;
+            pattern.Find(data + offset, count, [&taskMemoryList, start](SizeT const position) {
+                taskMemoryList.AddAddress(start + position);
+            });
+        });
+
+        for(MemoryList<UInt8> const& taskMemoryList : taskMemoryLists) {
+            newMemoryList.AppendList(taskMemoryList);
+        }
+
+        newMemoryList.Compact();
+
+        return newMemoryList;
     }
 
-    template<>
-    inline static Boolean Equals<Float32>(Float32 const a, Float32 const b) {
-        return (fabsf(a - b) <= 0.001F);
+    /// <returns>A list of the addresses in this process where the pattern starts.</returns>
+    inline MemoryList<UInt8> const FindPattern(BytePattern const& pattern) {
+        return FindPattern(CreateList<UInt8>(false), pattern);
     }
 
-    template<>
-    inline static Boolean Equals<Float64>(Float64 const a, Float64 const b) {
-        return (fabs(a - b) <= 0.001);
+    /// <summary>
+    /// <para>Searches for a group of fields at every address of a list in a single pass, e.g. of <code>CreateGroupList</code> or of a previous search.</para>
+    /// <para>Groups that run past the end of a region are found as long as the memory after it can be read.</para>
+    /// </summary>
+    /// <returns>A list of the base addresses where every field of the group compares true, with the stride of the searched list.</returns>
+    MemoryList<UInt8> const FindGroup(MemoryList<UInt8> const& memoryList, GroupPattern const& group) {
+        SizeT const stride = memoryList.GetStride();
+        MemoryList<UInt8> newMemoryList = MemoryList<UInt8>(stride);
+
+        if((memoryList.GetSize() == 0) || (group.GetFieldCount() == 0)) {
+            return newMemoryList;
+        }
+
+        SizeT const size = group.GetSize();
+
+        ReadTasks<UInt8> const tasks = PlanReadTasks<UInt8>(memoryList);
+        std::vector<MemoryList<UInt8>> taskMemoryLists = std::vector<MemoryList<UInt8>>(tasks.GetCount(), MemoryList<UInt8>(stride));
+        std::vector<std::vector<UInt32>> workerMatches = std::vector<std::vector<UInt32>>(GetWorkerCount());
+
+        ReadTasksParallel<UInt8>(memoryList, tasks, size - 1, [&taskMemoryLists, &workerMatches, &group, stride, size](SizeT const task, SizeT const worker, SizeT const, SizeT const start, SizeT const end, UInt8 const* data, SizeT const dataSize) {
+            MemoryList<UInt8>& taskMemoryList = taskMemoryLists[task];
+
+            SizeT const count = (dataSize >= size) ? min(end - start, dataSize - size + 1) : 0;
+            SizeT const baseCount = (count + stride - 1) / stride;
+            group.Find(data, baseCount, stride, workerMatches[worker], [&taskMemoryList, start, stride](SizeT const index) {
+                taskMemoryList.AddAddress(start + (index * stride));
+            });
+        });
+
+        for(MemoryList<UInt8> const& taskMemoryList : taskMemoryLists) {
+            newMemoryList.AppendList(taskMemoryList);
+        }
+
+        newMemoryList.Compact();
+
+        return newMemoryList;
     }
 
-    template<typename T>
-    inline static Boolean NotEquals(T const a, T const b) {
-        return (a != b);
+    /// <returns>A list of the base addresses in this process where every field of the group compares true.</returns>
+    inline MemoryList<UInt8> const FindGroup(GroupPattern const& group, SizeT const alignment = 4) {
+        return FindGroup(CreateGroupList(alignment), group);
     }
 
-    template<>
-    inline static Boolean NotEquals<Float32>(Float32 const a, Float32 const b) {
-        return (fabsf(a - b) > 0.001F);
+    /// <returns>A MemoryList of available base addresses in this process for FindGroup, aligned with a stride of alignment.</returns>
+    inline MemoryList<UInt8> const CreateGroupList(SizeT const alignment = 4) {
+        return CreateStridedList<UInt8>(alignment);
     }
 
-    template<>
-    inline static Boolean NotEquals<Float64>(Float64 const a, Float64 const b) {
-        return (fabs(a - b) > 0.001);
+    /// <summary>
+    /// <para>Reads every address of the list once and indexes it by its value, so equality and range lookups in this image take no further reads.</para>
+    /// <para>Addresses that cannot be read and NaNs are left out. The index takes about <code>sizeof(T) + 4</code> bytes per address while building and 4 bytes per address after.</para>
+    /// <para>Possible exceptions:</para>
+    /// <para>(Int8)1: The list has too many addresses to index, more than 4G.</para>
+    /// </summary>
+    template<typename T>
+    ValueIndex<T> CreateValueIndex(MemoryList<T> const& memoryList) {
+        SizeT const stride = memoryList.GetStride();
+
+        ReadTasks<T> const tasks = PlanReadTasks<T>(memoryList);
+        if(tasks.addressCount > 0xFFFFFFFFULL) {
+            throw (Int8)1;
+        }
+
+        std::vector<std::vector<T>> taskValues = std::vector<std::vector<T>>(tasks.GetCount());
+        std::vector<std::vector<UInt32>> taskLocations = std::vector<std::vector<UInt32>>(tasks.GetCount());
+
+        ReadTasksParallel<T>(memoryList, tasks, [&taskValues, &taskLocations, stride](SizeT const task, SizeT const, SizeT const index, SizeT const start, SizeT const end, UInt8 const* data, SizeT const size) {
+            SizeT const count = (size >= sizeof(T)) ? (size - sizeof(T) + 1) : 0;
+            SizeT const valueCount = (min(end - start, count) + stride - 1) / stride;
+
+            for(SizeT i = 0; i < valueCount; ++i) {
+                T const value = LoadValue<T>(data + (i * stride));
+                if constexpr(std::is_floating_point_v<T>) {
+                    // NaN equals nothing
+                    if(value != value) {
+                        continue;
+                    }
+                }
+                taskValues[task].push_back(value);
+                taskLocations[task].push_back(static_cast<UInt32>(index + i));
+            }
+        });
+
+        // Tasks are in list order, so joining them keeps the locations ascending
+        std::vector<SizeT> taskStarts = std::vector<SizeT>(tasks.GetCount() + 1, 0);
+        for(SizeT task = 0; task < tasks.GetCount(); ++task) {
+            taskStarts[task + 1] = taskStarts[task] + taskValues[task].size();
+        }
+        SizeT const total = taskStarts.back();
+
+        std::vector<T> values = std::vector<T>(total);
+        std::vector<UInt32> locations = std::vector<UInt32>(total);
+        _threadPool.ParallelFor(tasks.GetCount(), [&taskValues, &taskLocations, &taskStarts, &values, &locations](SizeT const task, SizeT const) {
+            std::copy(taskValues[task].begin(), taskValues[task].end(), values.begin() + taskStarts[task]);
+            std::copy(taskLocations[task].begin(), taskLocations[task].end(), locations.begin() + taskStarts[task]);
+            taskValues[task] = std::vector<T>();
+            taskLocations[task] = std::vector<UInt32>();
+        });
+
+        // Least significant byte first radix sort, it is stable so the locations of equal values stay ascending
+        constexpr SizeT chunkSize = 0x100000;
+        SizeT const chunkCount = (total + chunkSize - 1) / chunkSize;
+        std::vector<T> sortedValues = std::vector<T>(total);
+        std::vector<UInt32> sortedLocations = std::vector<UInt32>(total);
+        std::vector<SizeT> offsets = std::vector<SizeT>(chunkCount * 0x100);
+
+        for(SizeT shift = 0; shift < (sizeof(T) * 8); shift += 8) {
+            std::fill(offsets.begin(), offsets.end(), 0);
+            _threadPool.ParallelFor(chunkCount, [&values, &offsets, total, shift, chunkSize](SizeT const chunk, SizeT const) {
+                SizeT* chunkOffsets = offsets.data() + (chunk * 0x100);
+                for(SizeT i = chunk * chunkSize, e = min(i + chunkSize, total); i < e; ++i) {
+                    ++chunkOffsets[(ValueIndex<T>::GetSortKey(values[i]) >> shift) & 0xFF];
+                }
+            });
+
+            // Bytes that are the same everywhere, e.g. the high bytes of small integers, need no pass
+            Boolean sorted = false;
+            for(SizeT digit = 0; (digit < 0x100) && !sorted; ++digit) {
+                SizeT count = 0;
+                for(SizeT chunk = 0; chunk < chunkCount; ++chunk) {
+                    count += offsets[(chunk * 0x100) + digit];
+                }
+                sorted = count == total;
+            }
+            if(sorted) {
+                continue;
+            }
+
+            SizeT offset = 0;
+            for(SizeT digit = 0; digit < 0x100; ++digit) {
+                for(SizeT chunk = 0; chunk < chunkCount; ++chunk) {
+                    SizeT const count = offsets[(chunk * 0x100) + digit];
+                    offsets[(chunk * 0x100) + digit] = offset;
+                    offset += count;
+                }
+            }
+
+            _threadPool.ParallelFor(chunkCount, [&values, &locations, &sortedValues, &sortedLocations, &offsets, total, shift, chunkSize](SizeT const chunk, SizeT const) {
+                SizeT* chunkOffsets = offsets.data() + (chunk * 0x100);
+                for(SizeT i = chunk * chunkSize, e = min(i + chunkSize, total); i < e; ++i) {
+                    SizeT const target = chunkOffsets[(ValueIndex<T>::GetSortKey(values[i]) >> shift) & 0xFF]++;
+                    sortedValues[target] = values[i];
+                    sortedLocations[target] = locations[i];
+                }
+            });
+
+            std::swap(values, sortedValues);
+            std::swap(locations, sortedLocations);
+        }
+
+        sortedValues = std::vector<T>();
+        sortedLocations = std::vector<UInt32>();
+
+        return ValueIndex<T>(memoryList, values, std::move(locations));
     }
 
+    /// <returns>An index of the values of every available address in this process, see CreateValueIndex.</returns>
     template<typename T>
-    inline static Boolean LessThan(T const a, T const b) {
-        return (a < b);
+    inline ValueIndex<T> CreateValueIndex(Boolean const aligned = true) {
+        return CreateValueIndex<T>(CreateList<T>(aligned));
     }
 
-    template<>
-    inline static Boolean LessThan<Float32>(Float32 const a, Float32 const b) {
-        return ((a - 0.001F) < b);
+    /// <summary>
+    /// <para>Finds every aligned pointer into readable memory with one pass over all memory, including modules.</para>
+    /// <para>Possible exceptions:</para>
+    /// <para>(Int8)1: The process has too much memory to index, more than 4G pointer slots.</para>
+    /// </summary>
+    PointerMap CreatePointerMap() {
+        MemoryList<SizeT> const memoryList = CreateStridedList<SizeT>(sizeof(SizeT), true);
+        std::vector<Module> const modules = GetModules();
+
+        ReadTasks<SizeT> const tasks = PlanReadTasks<SizeT>(memoryList);
+        if(tasks.addressCount > 0xFFFFFFFFULL) {
+            throw (Int8)1;
+        }
+
+        // Readable memory as sorted bounds, a value is only a pointer if it points inside
+        std::vector<SizeT> starts = std::vector<SizeT>();
+        std::vector<SizeT> ends = std::vector<SizeT>();
+        std::vector<SizeT> indices = std::vector<SizeT>();
+        for(MemoryRegion<SizeT> const& region : memoryList) {
+            indices.push_back(indices.empty() ? 0 : (indices.back() + ((ends.back() - starts.back()) / sizeof(SizeT))));
+            starts.push_back(region.GetStart());
+            ends.push_back(region.GetEnd());
+        }
+        if(starts.empty()) {
+            return PointerMap(memoryList, modules, std::vector<PointerEntry>());
+        }
+        SizeT const lowest = starts.front();
+        SizeT const highest = ends.back();
+
+        // Pointers are sorted by bucket first, buckets split readable memory into equal parts so they are about the same size
+        constexpr SizeT bucketCount = 0x1000;
+        UInt64 const addressCount = max(static_cast<UInt64>(tasks.addressCount), static_cast<UInt64>(1));
+
+        std::vector<std::vector<PointerEntry>> taskEntries = std::vector<std::vector<PointerEntry>>(tasks.GetCount());
+        std::vector<std::vector<UInt16>> taskBuckets = std::vector<std::vector<UInt16>>(tasks.GetCount());
+
+        ReadTasksParallel<SizeT>(memoryList, tasks, [&taskEntries, &taskBuckets, &starts, &ends, &indices, lowest, highest, addressCount, bucketCount](SizeT const task, SizeT const, SizeT const index, SizeT const start, SizeT const end, UInt8 const* data, SizeT const size) {
+            std::vector<PointerEntry>& entries = taskEntries[task];
+            std::vector<UInt16>& buckets = taskBuckets[task];
+            SizeT const count = min(end - start, size) / sizeof(SizeT);
+
+            // Pointers next to each other mostly point into the same region
+            SizeT region = 0;
+            for(SizeT i = 0; i < count; ++i) {
+                SizeT const value = LoadValue<SizeT>(data + (i * sizeof(SizeT)));
+                if((value < lowest) || (value >= highest)) {
+                    continue;
+                }
+
+                if((value < starts[region]) || (value >= ends[region])) {
+                    region = static_cast<SizeT>(std::upper_bound(starts.begin(), starts.end(), value) - starts.begin()) - 1;
+                    if(value >= ends[region]) {
+                        continue;
+                    }
+                }
+
+                UInt64 const valueIndex = indices[region] + ((value - starts[region]) / sizeof(SizeT));
+                entries.push_back(PointerEntry(static_cast<UInt64>(value), static_cast<UInt32>(index + i)));
+                buckets.push_back(static_cast<UInt16>((valueIndex * bucketCount) / addressCount));
+            }
+        });
+
+        // Counting sort into buckets, every task writes its pointers of a bucket behind those of the tasks before it
+        std::vector<std::vector<SizeT>> taskOffsets = std::vector<std::vector<SizeT>>(tasks.GetCount(), std::vector<SizeT>(bucketCount, 0));
+        _threadPool.ParallelFor(tasks.GetCount(), [&taskBuckets, &taskOffsets](SizeT const task, SizeT const) {
+            for(UInt16 const bucket : taskBuckets[task]) {
+                ++taskOffsets[task][bucket];
+            }
+        });
+
+        std::vector<SizeT> bucketStarts = std::vector<SizeT>(bucketCount + 1, 0);
+        SizeT total = 0;
+        for(SizeT bucket = 0; bucket < bucketCount; ++bucket) {
+            bucketStarts[bucket] = total;
+            for(SizeT task = 0; task < taskOffsets.size(); ++task) {
+                SizeT const count = taskOffsets[task][bucket];
+                taskOffsets[task][bucket] = total;
+                total += count;
+            }
+        }
+        bucketStarts[bucketCount] = total;
+
+        std::vector<PointerEntry> entries = std::vector<PointerEntry>(total, PointerEntry(0, 0));
+        _threadPool.ParallelFor(tasks.GetCount(), [&taskEntries, &taskBuckets, &taskOffsets, &entries](SizeT const task, SizeT const) {
+            std::vector<SizeT>& offsets = taskOffsets[task];
+            for(SizeT i = 0, s = taskEntries[task].size(); i < s; ++i) {
+                entries[offsets[taskBuckets[task][i]]++] = taskEntries[task][i];
+            }
+
+            taskEntries[task] = std::vector<PointerEntry>();
+            taskBuckets[task] = std::vector<UInt16>();
+        });
+
+        _threadPool.ParallelFor(bucketCount, [&entries, &bucketStarts](SizeT const bucket, SizeT const) {
+            std::sort(entries.begin() + bucketStarts[bucket], entries.begin() + bucketStarts[bucket + 1]);
+        });
+
+        return PointerMap(memoryList, modules, entries);
     }
 
-    template<>
-    inline static Boolean LessThan<Float64>(Float64 const a, Float64 const b) {
-        return ((a - 0.001) < b);
+    /// <summary>
+    /// <para>Searches backwards from target for chains of pointers that start inside a module, see PointerChain.</para>
+    /// <para>Every level looks for pointers to at most maxOffset bytes before the addresses of the level before, all in parallel.</para>
+    /// </summary>
+    /// <param name="maxDepth">The most pointers in a chain.</param>
+    /// <param name="maxOffset">The largest offset added to a pointer.</param>
+    /// <param name="maxResults">The search stops once this many chains are found.</param>
+    std::vector<PointerChain> FindPointerChains(PointerMap const& map, SizeT const target, SizeT const maxDepth = 5, SizeT const maxOffset = 0x1000, SizeT const maxResults = 0x10000) {
+        // Every address found on the way remembers where it leads, so chains are built by walking back to the target
+        struct PointerNode {
+        public:
+            PointerNode(SizeT const _address, SizeT const _parent, SizeT const _offset) {
+                address = _address;
+                parent = _parent;
+                offset = _offset;
+            }
+
+            SizeT address;
+            SizeT parent;
+            SizeT offset;
+        };
+
+        // Bounds the memory of a level, the chains of larger levels are mostly noise anyway
+        constexpr SizeT maxLevelSize = 0x400000;
+        constexpr SizeT nodesPerTask = 0x100;
+
+        std::vector<PointerChain> chains = std::vector<PointerChain>();
+        std::vector<PointerNode> nodes = std::vector<PointerNode>();
+        nodes.push_back(PointerNode(target, 0, 0));
+
+        for(SizeT depth = 0, levelStart = 0, levelEnd = 1; (depth < maxDepth) && (levelStart < levelEnd) && (chains.size() < maxResults); ++depth) {
+            SizeT const taskCount = (levelEnd - levelStart + nodesPerTask - 1) / nodesPerTask;
+            std::vector<std::vector<PointerNode>> taskNodes = std::vector<std::vector<PointerNode>>(taskCount);
+            std::vector<std::vector<SizeT>> taskStatics = std::vector<std::vector<SizeT>>(taskCount);
+
+            _threadPool.ParallelFor(taskCount, [&map, &nodes, &taskNodes, &taskStatics, levelStart, levelEnd, maxOffset, nodesPerTask](SizeT const task, SizeT const) {
+                for(SizeT node = levelStart + (task * nodesPerTask), e = min(node + nodesPerTask, levelEnd); node < e; ++node) {
+                    SizeT const address = nodes[node].address;
+                    SizeT const low = (address >= maxOffset) ? (address - maxOffset) : 0;
+
+                    map.FindPointers(low, address, [&map, &taskNodes, &taskStatics, task, node, address](SizeT const value, SizeT const location) {
+                        // Chains end at the first module, there is no need to go on from a static address
+                        if(map.FindModule(location) != nullptr) {
+                            taskStatics[task].push_back(taskNodes[task].size());
+                        }
+                        taskNodes[task].push_back(PointerNode(location, node, address - value));
+                    });
+                }
+            });
+
+            levelStart = levelEnd;
+            for(SizeT task = 0; task < taskCount; ++task) {
+                SizeT staticIndex = 0;
+
+                for(SizeT i = 0, s = taskNodes[task].size(); i < s; ++i) {
+                    PointerNode const& pointerNode = taskNodes[task][i];
+
+                    if((staticIndex < taskStatics[task].size()) && (taskStatics[task][staticIndex] == i)) {
+                        ++staticIndex;
+
+                        if(chains.size() < maxResults) {
+                            Module const* module = map.FindModule(pointerNode.address);
+                            std::vector<SizeT> offsets = std::vector<SizeT>();
+                            offsets.push_back(pointerNode.offset);
+                            for(SizeT parent = pointerNode.parent; parent != 0; parent = nodes[parent].parent) {
+                                offsets.push_back(nodes[parent].offset);
+                            }
+                            chains.push_back(PointerChain(module->GetName(), pointerNode.address - module->GetBase(), offsets));
+                        }
+                        continue;
+                    }
+
+                    if((nodes.size() - levelStart) < maxLevelSize) {
+                        nodes.push_back(pointerNode);
+                    }
+                }
+            }
+            levelEnd = nodes.size();
+        }
+
+        return chains;
     }
 
-    template<typename T>
-    inline static Boolean GreaterThan(T const a, T const b) {
-        return (a > b);
+    /// <summary>
+    /// <para>Follows a chain in this process.</para>
+    /// <para>Possible exceptions:</para>
+    /// <para>(Int8)1: The module is not loaded or a pointer cannot be read.</para>
+    /// </summary>
+    /// <returns>The address the chain leads to.</returns>
+    SizeT ResolvePointerChain(PointerChain const& chain, std::vector<Module> const& modules) const {
+        std::vector<Module>::const_iterator const module = std::find_if(modules.begin(), modules.end(), [&chain](Module const& m) {
+            return m.GetName() == chain.module;
+        });
+        if(module == modules.end()) {
+            throw (Int8)1;
+        }
+
+        SizeT address = module->GetBase() + chain.offset;
+        for(SizeT const offset : chain.offsets) {
+            try {
+                address = Read<SizeT>(address) + offset;
+            }
+            catch(Int8) {
+                throw (Int8)1;
+            }
+        }
+        return address;
     }
 
-    template<>
-    inline static Boolean GreaterThan<Float32>(Float32 const a, Float32 const b) {
-        return ((a + 0.001F) > b);
+    /// <summary>Keeps the chains that still lead to target, e.g. in a new run of the process or after the target moved.</summary>
+    std::vector<PointerChain> FilterPointerChains(std::vector<PointerChain> const& chains, SizeT const target) {
+        std::vector<Module> const modules = GetModules();
+
+        std::vector<PointerChain> validChains = std::vector<PointerChain>();
+        for(PointerChain const& chain : chains) {
+            try {
+                if(ResolvePointerChain(chain, modules) == target) {
+                    validChains.push_back(chain);
+                }
+            }
+            catch(Int8) {
+            }
+        }
+
+        return validChains;
     }
 
-    template<>
-    inline static Boolean GreaterThan<Float64>(Float64 const a, Float64 const b) {
-        return ((a + 0.001) > b);
+    /// <summary>
+    /// <para>Keeps up to capacity pages read by Read and ReadData, so reading the same pages again costs a copy instead of a call. 0 disables the cache, which is the default.</para>
+    /// <para>Cached pages show the process as it was when they were read, call NextPageCacheGeneration once per tick or frame to read them again. Writes of this modder update them.</para>
+    /// </summary>
+    void SetPageCacheCapacity(SizeT const capacity) {
+        _pageCache.SetCapacity(capacity);
     }
 
+    /// <summary>Pages read from now on replace the cached ones, see SetPageCacheCapacity.</summary>
+    /// <returns>The new generation.</returns>
+    UInt64 NextPageCacheGeneration() {
+        return _pageCache.NextGeneration();
+    }
+
+    /// <returns>The page cache, for its hit and miss counters.</returns>
+    PageCache& GetPageCache() const noexcept {
+        return _pageCache;
+    }
+
+    /// <summary>Locks the value at address, it is written again on every tick of the freeze engine while it runs, see FreezeProcess.</summary>
     template<typename T>
-    inline static Boolean LessThanEquals(T const a, T const b) {
-        return (a <= b);
+    void Freeze(SizeT const address, T const value) {
+        UInt8 data[sizeof(T)];
+        memcpy(data, &value, sizeof(T));
+        _freezeEngine.Lock(address, data, sizeof(T));
     }
 
-    template<>
-    inline static Boolean LessThanEquals<Float32>(Float32 const a, Float32 const b) {
-        return ((a - 0.001F) <= b);
+    /// <returns>True if the value at address was locked.</returns>
+    Boolean Unfreeze(SizeT const address) {
+        return _freezeEngine.Unlock(address);
     }
 
-    template<>
-    inline static Boolean LessThanEquals<Float64>(Float64 const a, Float64 const b) {
-        return ((a - 0.001) <= b);
+    void UnfreezeAll() {
+        _freezeEngine.UnlockAll();
     }
 
-    template<typename T>
-    inline static Boolean GreaterThanEquals(T const a, T const b) {
-        return (a >= b);
+    /// <returns>The freeze engine, to change its tick rate or to only write values that changed.</returns>
+    FreezeEngine& GetFreezeEngine() noexcept {
+        return _freezeEngine;
+    }
+
+    /// <summary>Starts writing the locked values on a background thread, see Freeze.</summary>
+    void FreezeProcess() {
+        _freezeEngine.Start();
+    }
+
+    /// <summary>Stops writing the locked values, they stay locked for the next FreezeProcess.</summary>
+    void UnfreezeProcess() {
+        _freezeEngine.Stop();
+    }
+
+private:
+    /// <summary>Reads all tasks on the thread pool, with dirtyPages only the values with a byte on a dirty page, see the public overloads.</summary>
+    template<typename T, typename Visitor>
+    void ReadTasksParallel(MemoryList<T> const& memoryList, ReadTasks<T> const& tasks, SizeT const tail, DirtyPages const* dirtyPages, Visitor& visitor) {
+        SizeT const stride = memoryList.GetStride();
+
+        _threadPool.ParallelFor(tasks.GetCount(), [this, &memoryList, &tasks, stride, tail, dirtyPages, &visitor](SizeT const task, SizeT const worker) {
+            ReadTask<T> const& readTask = tasks.tasks[task];
+            SizeT const taskEnd = tasks.GetEnd(task);
+
+            // The regions of the task cut to the task, and the index of their first address
+            std::vector<MemoryRegion<T>> regions = std::vector<MemoryRegion<T>>();
+            std::vector<SizeT> indices = std::vector<SizeT>();
+            // The same for the pieces of the regions that are clean
+            std::vector<MemoryRegion<T>> cleanRegions = std::vector<MemoryRegion<T>>();
+            std::vector<SizeT> cleanIndices = std::vector<SizeT>();
+
+            SizeT index = readTask.index;
+            for(typename MemoryList<T>::Iterator it = readTask.region, e = memoryList.end(); (it != e) && (it->GetStart() < taskEnd); ++it) {
+                SizeT const start = max(it->GetStart(), readTask.start);
+                SizeT const end = min(it->GetEnd(), taskEnd);
+
+                if(dirtyPages == nullptr) {
+                    regions.push_back(MemoryRegion<T>(start, end - start));
+                    indices.push_back(index);
+                }
+                else {
+                    // A value is dirty if any of its bytes is, so dirty pages reach back to the values running into them
+                    SizeT clean = start;
+                    dirtyPages->ForEachRange(start, end + sizeof(T) - 1, [&](SizeT const dirtyStart, SizeT const dirtyEnd) {
+                        SizeT const first = max(clean, AlignUp(start, (dirtyStart >= (start + sizeof(T) - 1)) ? (dirtyStart - sizeof(T) + 1) : start, stride));
+                        SizeT const last = min(end, AlignUp(start, dirtyEnd, stride));
+                        if(first >= last) {
+                            return;
+                        }
+
+                        if(clean < first) {
+                            cleanRegions.push_back(MemoryRegion<T>(clean, first - clean));
+                            cleanIndices.push_back(index + ((clean - start) / stride));
+                        }
+                        regions.push_back(MemoryRegion<T>(first, last - first));
+                        indices.push_back(index + ((first - start) / stride));
+                        clean = last;
+                    });
+
+                    if(clean < end) {
+                        cleanRegions.push_back(MemoryRegion<T>(clean, end - clean));
+                        cleanIndices.push_back(index + ((clean - start) / stride));
+                    }
+                }
+
+                index += (end - start + stride - 1) / stride;
+            }
+
+            // Clean regions are visited in between the regions read, to keep the visits in address order
+            SizeT cleanRegion = 0;
+            auto const visitClean = [task, worker, &cleanRegions, &cleanIndices, &cleanRegion, &visitor](SizeT const before) {
+                for(; (cleanRegion < cleanRegions.size()) && (cleanRegions[cleanRegion].GetStart() < before); ++cleanRegion) {
+                    visitor(task, worker, cleanIndices[cleanRegion], cleanRegions[cleanRegion].GetStart(), cleanRegions[cleanRegion].GetEnd(), nullptr, 0);
+                }
+            };
+
+            SizeT region = 0;
+            _readPlanners[worker].Read(regions.begin(), regions.end(), tail,
+                [this](ReadRequest* requests, SizeT const count) {
+                    ReadChunks(requests, count);
+                },
+                [task, worker, stride, &regions, &indices, &region, &visitClean, &visitor](SizeT const start, SizeT const end, UInt8 const* data, SizeT const size) {
+                    // Regions that could not be read are skipped, so follow along by address
+                    while(regions[region].GetEnd() <= start) {
+                        ++region;
+                    }
+
+                    visitClean(start);
+                    visitor(task, worker, indices[region] + ((start - regions[region].GetStart()) / stride), start, end, data, size);
+                });
+
+            visitClean(~static_cast<SizeT>(0));
+        });
+    }
+
+    /// <returns>The first address from address on that is a whole number of strides from start.</returns>
+    static inline SizeT AlignUp(SizeT const start, SizeT const address, SizeT const stride) noexcept {
+        return start + (((address - start + stride - 1) / stride) * stride);
+    }
+
+    /// <returns>True if the page cache is enabled and holds size bytes from address, reads of more than a few pages always go to the process.</returns>
+    inline Boolean ReadCached(SizeT const address, SizeT const size, UInt8* data) const {
+        if(size > (4 * PageCache::pageSize)) {
+            return false;
+        }
+
+        return _pageCache.Read(address, size, data, [this](SizeT const pageAddress, SizeT const pageSize, UInt8* pageData) -> SizeT {
+            return ReadChunk(pageAddress, pageSize, pageData);
+        });
     }
 
-    template<>
-    inline static Boolean GreaterThanEquals<Float32>(Float32 const a, Float32 const b) {
-        return ((a + 0.001F) >= b);
+    /// <summary>Updates the cached pages with bytes written to the process, or drops them if the write failed and may have been partial.</summary>
+    inline void WriteCached(SizeT const address, SizeT const size, UInt8 const* data, Boolean const written) {
+        if(written) {
+            _pageCache.Write(address, size, data);
+        }
+        else {
+            _pageCache.Invalidate(address, size);
+        }
+    }
+
+    /// <returns>The number of bytes read, or 0 if the read failed.</returns>
+    inline SizeT ReadChunk(SizeT const address, SizeT const size, UInt8* data) const {
+        return _memory.Read(address, size, data);
     }
 
-    template<>
-    inline static Boolean GreaterThanEquals<Float64>(Float64 const a, Float64 const b) {
-        return ((a + 0.001) >= b);
+    /// <summary>Reads every request with as few calls as the backend allows, see ReadRequest.</summary>
+    inline void ReadChunks(ReadRequest* requests, SizeT const count) const {
+        _memory.ReadBatch(requests, count);
     }
 
-    DWORD _processId;
-    HANDLE _processHandle;
-    String _processName;
-    SizeT _processBaseAddress;
+    /// <returns>The number of bytes written, or 0 if the write failed.</returns>
+    inline SizeT WriteChunk(SizeT const address, SizeT const size, UInt8 const* data) const {
+        return _memory.Write(address, size, data);
+    }
+
+    Memory _memory;
+
+    // Number of the last ClearDirtyPages
+    UInt64 _dirtyPagesClear = 0;
+
+    RegionMap _regionMap = RegionMap();
+    RegionPolicy _regionPolicy = RegionPolicy();
+    std::chrono::milliseconds _regionMaxAge = std::chrono::milliseconds(1000);
+
+    ThreadPool _threadPool = ThreadPool();
+    std::vector<ReadPlanner> _readPlanners = std::vector<ReadPlanner>();
+    // Buffer of ForEachRegion, kept for the next call
+    ReadPlanner _chunkPlanner = ReadPlanner();
+
+    // Mutable because reads use it
+    mutable PageCache _pageCache = PageCache();
+
+    FreezeEngine _freezeEngine = FreezeEngine(
+        [this](SizeT const address, SizeT const size, UInt8* data) -> SizeT {
+            return ReadChunk(address, size, data);
+        },
+        [this](SizeT const address, SizeT const size, UInt8 const* data) -> SizeT {
+            SizeT const sizeWritten = WriteChunk(address, size, data);
+            WriteCached(address, size, data, sizeWritten == size);
+            return sizeWritten;
+        });
 };
+
+/// <summary>Reads, writes and searches the memory of a process of this platform.</summary>
+using MemoryModder = BasicMemoryModder<ProcessMemory>;
+
+/// <summary>Reads and searches a dump written by SaveDump, writes always fail.</summary>
+using DumpModder = BasicMemoryModder<DumpMemory>;
@@ -10,6 +10,7 @@
 #include "Table.hpp"
 
 #include "MemoryModder.hpp"
+#include "ScanSession.hpp"
 
 void GetMemoryUsage(SizeT& used, SizeT& total) {
     PROCESS_MEMORY_COUNTERS_EX pmc;
@@ -88,7 +89,7 @@ Table ProcessSelectionCreateProcessesTable(std::vector<Process>& processes) {
         std::vector<String> row = std::vector<String>();
         row.push_back(" ");
         row.push_back(ToString<SizeT>(index));
-        row.push_back(ToString<DWORD>(process.GetId()));
+        row.push_back(ToString<SizeT>(process.GetId()));
         row.push_back(process.GetName());
         rows.push_back(row);
 
@@ -203,18 +204,28 @@ void BeginMemoryModdingWriteProcess(MemoryModder& modder) {
         Console::SetTextStyle(FOREGROUND_INTENSITY);
         Console::WriteLine("!");
         Console::ResetTextStyle();
+
+        // Written again in the background until unfrozen
+        if(ConsoleAskYesNoQuestion("Freeze this value", true, false)) {
+            modder.Freeze<T>(address, value);
+            modder.FreezeProcess();
+        }
     }
     catch(Int8) {
         Console::ErrorLine("Failed to write, address is out of accessible process range.");
     }
 }
 
+/// <param name="previousValues">Values in the same order as the addresses in data, shown in a separate column if not null.</param>
 template<typename T>
-Table MemoryModdingFindCreateAddressesTable(MemoryModder const& modder, MemoryList<T> const& data, SizeT count) {
+Table MemoryModdingFindCreateAddressesTable(MemoryModder const& modder, MemoryList<T> const& data, SizeT count, std::vector<T> const* previousValues = nullptr) {
     std::vector<TableColumn> columns = std::vector<TableColumn>();
     columns.push_back(TableColumn("#", FOREGROUND_INTENSITY, FOREGROUND_INTENSITY, 0));
     columns.push_back(TableColumn("Address", FOREGROUND_INTENSITY, FOREGROUND_BLUE | FOREGROUND_INTENSITY, 0));
     columns.push_back(TableColumn("Value", FOREGROUND_INTENSITY, FOREGROUND_GREEN | FOREGROUND_BLUE, 0));
+    if(previousValues != nullptr) {
+        columns.push_back(TableColumn("Previous", FOREGROUND_INTENSITY, FOREGROUND_GREEN, 0));
+    }
 
     std::vector<std::vector<String>> rows = std::vector<std::vector<String>>();
 
@@ -222,6 +233,11 @@ Table MemoryModdingFindCreateAddressesTable(MemoryModder const& modder, MemoryLi
     SizeT size = addresses.size();
     SizeT sizeAll = data.GetSize();
 
+    // All rows are read together
+    std::vector<T> values = std::vector<T>(size);
+    std::vector<ReadStatus> statuses = std::vector<ReadStatus>(size);
+    modder.ReadMany<T>(addresses, values, statuses);
+
     for(SizeT index = 0; index < size; ++index) {
         SizeT address = addresses[index];
 
@@ -229,21 +245,24 @@ Table MemoryModdingFindCreateAddressesTable(MemoryModder const& modder, MemoryLi
         row.push_back(ToString<SizeT>(index));
         row.push_back("0x" + ToString<SizeT>(address, std::ios_base::uppercase | std::ios_base::hex));
 
-        try {
-            T value = modder.Read<T>(address);
-            row.push_back(ToString<T>(value));
+        if(statuses[index] == ReadStatus::Success) {
+            row.push_back(ToString<T>(values[index]));
         }
-        catch(Int8) {
+        else {
             row.push_back("???");
         }
 
+        if(previousValues != nullptr) {
+            row.push_back(ToString<T>((*previousValues)[index]));
+        }
+
         rows.push_back(row);
     }
     return Table(columns, rows);
 }
 
 template<typename T>
-void MemoryModdingFindWriteAddresses(MemoryModder const& modder, MemoryList<T> const& data, SizeT count) {
+void MemoryModdingFindWriteAddresses(MemoryModder const& modder, MemoryList<T> const& data, SizeT count, std::vector<T> const* previousValues = nullptr) {
     {
         // Statistics
         Console::SetTextStyle(FOREGROUND_INTENSITY);
@@ -268,7 +287,7 @@ void MemoryModdingFindWriteAddresses(MemoryModder const& modder, MemoryList<T> c
         Console::WriteLine();
     }
 
-    Table table = MemoryModdingFindCreateAddressesTable(modder, data, count);
+    Table table = MemoryModdingFindCreateAddressesTable(modder, data, count, previousValues);
     WriteTable(table, false, 0, 0, FOREGROUND_INTENSITY);
 
     std::vector<SizeT> const addresses = data.GetFirstAddresses(count);
@@ -284,89 +303,224 @@ void MemoryModdingFindWriteAddresses(MemoryModder const& modder, MemoryList<T> c
     Console::WriteLine();
 }
 
+FloatTolerance ConsoleAskFloatTolerance() {
+    while(true) {
+        Console::SetTextStyle(FOREGROUND_INTENSITY);
+        Console::Write("Float mode [absolute <difference>, relative <fraction>, ulps <count>, rounded <decimals>, truncated <decimals>, <empty> = absolute 0.001]: ");
+        try {
+            Console::SetTextStyle(FOREGROUND_GREEN | FOREGROUND_BLUE);
+            String modeString = ToLowerAscii(Console::ReadLine());
+            Console::ResetTextStyle();
+            if(modeString == "") {
+                return FloatTolerance();
+            }
+
+            SizeT const space = modeString.find(' ');
+            if(space == String::npos) {
+                throw (Int8)1;
+            }
+            String const name = modeString.substr(0, space);
+            Float64 const parameter = FromString<Float64>(modeString.substr(space + 1));
+
+            if(name == "absolute") { return FloatTolerance(FloatMode::Absolute, parameter); }
+            else if(name == "relative") { return FloatTolerance(FloatMode::Relative, parameter); }
+            else if(name == "ulps") { return FloatTolerance(FloatMode::Ulps, parameter); }
+            else if(name == "rounded") { return FloatTolerance(FloatMode::Rounded, parameter); }
+            else if(name == "truncated") { return FloatTolerance(FloatMode::Truncated, parameter); }
+            throw (Int8)1;
+        }
+        catch(Int8) {
+            ConsoleWriteInvalidInput();
+        }
+    }
+}
+
 template<typename T>
 void BeginMemoryModdingFindProcess(MemoryModder& modder) {
-    MemoryList<T> data = modder.CreateList<T>();
+    ScanSession<T> session = ScanSession<T>(modder);
 
-    SizeT sizeLast = data.GetSize();
+    // A saved search goes on where it stopped, also after the process was started again
+    Boolean loaded = false;
+    if(ConsoleAskYesNoQuestion("Load a saved session", true, false)) {
+        Console::SetTextStyle(FOREGROUND_INTENSITY);
+        Console::Write("File: ");
+        Console::ResetTextStyle();
+        String path = Console::ReadLine();
+
+        try {
+            session.Load(path);
+            // A session may hold a whole snapshot
+            session.SetSpill(String(), 512 * 0x100000);
+            loaded = true;
+        }
+        catch(Int8) {
+            Console::ErrorLine("Failed to read the session.");
+        }
+    }
+
+    // Every value filter of this search compares floats the same way
+    FloatTolerance tolerance = FloatTolerance();
+    if constexpr(std::is_floating_point_v<T>) {
+        tolerance = ConsoleAskFloatTolerance();
+    }
+
+    if(!loaded && ConsoleAskYesNoQuestion("Unknown initial value (snapshot all memory)", true, false)) {
+        // A snapshot of a large process does not fit in memory next to the process itself
+        SizeT memoryBudget = 512;
+        while(true) {
+            Console::SetTextStyle(FOREGROUND_INTENSITY);
+            Console::Write("Memory budget before spilling to disk [MiB, 0 = never, <empty> = 512]: ");
+            try {
+                Console::SetTextStyle(FOREGROUND_GREEN | FOREGROUND_BLUE);
+                String memoryBudgetString = Console::ReadLine();
+                if(memoryBudgetString != "") {
+                    memoryBudget = FromString<SizeT>(memoryBudgetString);
+                }
+                break;
+            }
+            catch(Int8) {
+                ConsoleWriteInvalidInput();
+            }
+        }
+        session.SetSpill(String(), memoryBudget * 0x100000);
+
+        Console::SetTextStyle(FOREGROUND_INTENSITY);
+        Console::WriteLine("...");
+
+        try {
+            session.Snapshot();
+        }
+        catch(Int8) {
+            Console::ErrorLine("Failed to spill the snapshot to disk.");
+        }
+
+        Console::ResetTextStyle();
+    }
+
+    SizeT sizeLast = session.GetList().GetSize();
 
     while(true) {
         Console::Clear();
 
         {
-            SizeT sizeCurrent = data.GetSize();
+            SizeT sizeCurrent = session.GetList().GetSize();
             Console::SetTextStyle(FOREGROUND_INTENSITY);
             Console::WriteLine("-" + ToString<SizeT>(sizeLast - sizeCurrent) + " from previous snapshot.");
             Console::ResetTextStyle();
             sizeLast = sizeCurrent;
         }
 
-        MemoryModdingFindWriteAddresses<T>(modder, data, 16);
+        Boolean hasPreviousValues = session.HasValues();
+        std::vector<T> previousValues = std::vector<T>();
+        try {
+            previousValues = session.GetFirstValues(16);
+        }
+        catch(Int8) {
+            hasPreviousValues = false;
+        }
+        MemoryModdingFindWriteAddresses<T>(modder, session.GetList(), 16, hasPreviousValues ? &previousValues : nullptr);
 
         if(!ConsoleAskYesNoQuestion("Filter", true, true)) {
             break;
         }
 
-        MemoryComparison comparison;
-        while(true) {
-            Console::SetTextStyle(FOREGROUND_INTENSITY);
-            Console::Write("Comparison [");
-            Console::SetTextStyle(FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
-            Console::Write("==");
-            Console::SetTextStyle(FOREGROUND_INTENSITY);
-            Console::Write(",!=,<,>,<=,>=]: ");
-            Console::SetTextStyle(FOREGROUND_INTENSITY);
-            String comparisonString = Console::ReadLine();
-
-            if((comparisonString == "==") || (comparisonString == "")) {
-                comparison = MemoryComparison::Equals;
-                break;
-            }
-            else if(comparisonString == "!=") {
-                comparison = MemoryComparison::NotEquals;
-                break;
-            }
-            else if(comparisonString == "<") {
-                comparison = MemoryComparison::LessThan;
-                break;
-            }
-            else if(comparisonString == ">") {
-                comparison = MemoryComparison::GreaterThan;
-                break;
-            }
-            else if(comparisonString == "<=") {
-                comparison = MemoryComparison::LessThanEquals;
-                break;
-            }
-            else if(comparisonString == ">=") {
-                comparison = MemoryComparison::GreaterThanEquals;
-                break;
-            }
-
-            ConsoleWriteInvalidInput();
-        }
-
-        T value;
+        // A bare value is compared for equality, e.g. "100", "between 90 and 110", "== 100 or == 250", "> 0 and != previous"
+        FilterExpression<T> expression = FilterExpression<T>();
         while(true) {
             Console::SetTextStyle(FOREGROUND_INTENSITY);
-            Console::Write(String("Value [<") + GetTypeName<T>() + ">]: ");
+            Console::Write(String("Filter [<") + GetTypeName<T>() + ">, ==,!=,<,>,<=,>=,between x and y,changed,unchanged,increased [by x],decreased [by x],previous [+,- x],and,or]: ");
             try {
                 Console::SetTextStyle(FOREGROUND_GREEN | FOREGROUND_BLUE);
-                value = FromString<T>(Console::ReadLine());
-                break;
+                expression = FilterExpression<T>::Parse(Console::ReadLine(), tolerance);
             }
             catch(Int8) {
                 ConsoleWriteInvalidInput();
+                continue;
+            }
+
+            if(expression.UsesPrevious() && !session.HasValues()) {
+                Console::ErrorLine("There are no previous values yet, filter by a value first.");
+                continue;
             }
+            break;
         }
 
         Console::SetTextStyle(FOREGROUND_INTENSITY);
         Console::WriteLine("...");
 
-        data = modder.FilterList<T>(data, value, comparison);
+        try {
+            session.Filter(expression);
+        }
+        catch(Int8) {
+            Console::ErrorLine("Failed to spill the values to disk, the list is unchanged.");
+        }
 
         Console::ResetTextStyle();
     }
+
+    if(ConsoleAskYesNoQuestion("Save the session", true, false)) {
+        Console::SetTextStyle(FOREGROUND_INTENSITY);
+        Console::Write("File: ");
+        Console::ResetTextStyle();
+        String path = Console::ReadLine();
+
+        try {
+            session.Save(path);
+        }
+        catch(Int8) {
+            Console::ErrorLine("Failed to write the session.");
+        }
+    }
+}
+
+/// <summary>Every lookup answers from the values read when the index was built, the process is not read again.</summary>
+template<typename T>
+void MemoryModdingIndexLookups(MemoryModder const& modder, ValueIndex<T> const& index) {
+    while(true) {
+        Console::SetTextStyle(FOREGROUND_INTENSITY);
+        Console::WriteLine(ToString<SizeT>(index.GetSize()) + " addresses, " + ToString<SizeT>(index.GetValueCount()) + " values, " + AbbreviateInteger<SizeT>(index.GetMemoryUsage()) + "B");
+
+        T low = T();
+        T high = T();
+        try {
+            Console::Write(String("Value [<") + GetTypeName<T>() + ">, <empty> = back]: ");
+            Console::SetTextStyle(FOREGROUND_GREEN | FOREGROUND_BLUE);
+            String lowString = Console::ReadLine();
+            if(lowString == "") {
+                return;
+            }
+            low = FromString<T>(lowString);
+
+            Console::SetTextStyle(FOREGROUND_INTENSITY);
+            Console::Write(String("Up to [<") + GetTypeName<T>() + ">, <empty> = equal]: ");
+            Console::SetTextStyle(FOREGROUND_GREEN | FOREGROUND_BLUE);
+            String highString = Console::ReadLine();
+            high = (highString == "") ? low : FromString<T>(highString);
+        }
+        catch(Int8) {
+            ConsoleWriteInvalidInput();
+            continue;
+        }
+
+        Console::Clear();
+        MemoryList<T> const list = (high == low) ? index.FindEquals(low) : index.FindRange(low, high);
+        MemoryModdingFindWriteAddresses<T>(modder, list, 16);
+    }
+}
+
+template<typename T>
+void BeginMemoryModdingIndexProcess(MemoryModder& modder) {
+    Console::SetTextStyle(FOREGROUND_INTENSITY);
+    Console::WriteLine("...");
+    Console::ResetTextStyle();
+
+    try {
+        ValueIndex<T> const index = modder.CreateValueIndex<T>(true);
+        MemoryModdingIndexLookups<T>(modder, index);
+    }
+    catch(Int8) {
+        Console::ErrorLine("This process has too much memory to index.");
+    }
 }
 
 template<typename T>
@@ -374,7 +528,7 @@ void BeginMemoryModdingProcess(MemoryModder& modder) {
     while(true) {
         Console::Clear();
         Console::SetTextStyle(FOREGROUND_INTENSITY);
-        Console::Write(String("Memory: Modding: (<") + GetTypeName<T>() + ">) [back, write, find]: ");
+        Console::Write(String("Memory: Modding: (<") + GetTypeName<T>() + ">) [back, write, find, index]: ");
         Console::ResetTextStyle();
         String task = Console::ReadLine();
 
@@ -387,6 +541,9 @@ void BeginMemoryModdingProcess(MemoryModder& modder) {
         else if(task == "find") {
             BeginMemoryModdingFindProcess<T>(modder);
         }
+        else if(task == "index") {
+            BeginMemoryModdingIndexProcess<T>(modder);
+        }
         else {
             ConsoleWriteInvalidInput();
         }
@@ -440,11 +597,230 @@ void BeginMemoryModdingTypeOptions(MemoryModder& modder) {
     }
 }
 
+void BeginMemoryPatternProcess(MemoryModder& modder) {
+    BytePattern pattern = BytePattern("00");
+    while(true) {
+        Console::Clear();
+        Console::SetTextStyle(FOREGROUND_INTENSITY);
+        Console::Write("Memory: Pattern: [back, <bytes, e.g. 48 8B ?? ?? 00 00 89>]: ");
+        try {
+            Console::SetTextStyle(FOREGROUND_GREEN | FOREGROUND_BLUE);
+            String patternString = Console::ReadLine();
+            if(patternString == "back") {
+                return;
+            }
+            pattern = BytePattern(patternString);
+            break;
+        }
+        catch(Int8) {
+            ConsoleWriteInvalidInput();
+        }
+    }
+
+    Console::SetTextStyle(FOREGROUND_INTENSITY);
+    Console::WriteLine("...");
+    Console::ResetTextStyle();
+
+    MemoryList<UInt8> list = modder.FindPattern(pattern);
+
+    while(true) {
+        Console::Clear();
+        MemoryModdingFindWriteAddresses<UInt8>(modder, list, 16);
+
+        // The pattern may move or disappear once the process changes
+        if(!ConsoleAskYesNoQuestion("Search the matches again", true, false)) {
+            return;
+        }
+
+        Console::SetTextStyle(FOREGROUND_INTENSITY);
+        Console::WriteLine("...");
+        Console::ResetTextStyle();
+
+        list = modder.FindPattern(list, pattern);
+    }
+}
+
+void BeginMemoryGroupProcess(MemoryModder& modder) {
+    GroupPattern group = GroupPattern();
+    while(true) {
+        Console::Clear();
+        Console::SetTextStyle(FOREGROUND_INTENSITY);
+        Console::Write("Memory: Group: [back, <fields, e.g. int32 hp == 100 @0, int32 maxhp == 100 @+4, float32 x @+8 in range>]: ");
+        try {
+            Console::SetTextStyle(FOREGROUND_GREEN | FOREGROUND_BLUE);
+            String groupString = Console::ReadLine();
+            if(groupString == "back") {
+                return;
+            }
+            group = GroupPattern::Parse(groupString);
+            break;
+        }
+        catch(Int8) {
+            ConsoleWriteInvalidInput();
+        }
+    }
+
+    Console::SetTextStyle(FOREGROUND_INTENSITY);
+    Console::WriteLine("...");
+    Console::ResetTextStyle();
+
+    MemoryList<UInt8> list = modder.FindGroup(group);
+
+    while(true) {
+        Console::Clear();
+        MemoryModdingFindWriteAddresses<UInt8>(modder, list, 16);
+
+        // Fields may change together, e.g. when the game moves its entities
+        if(!ConsoleAskYesNoQuestion("Search the matches again", true, false)) {
+            return;
+        }
+
+        Console::SetTextStyle(FOREGROUND_INTENSITY);
+        Console::WriteLine("...");
+        Console::ResetTextStyle();
+
+        list = modder.FindGroup(list, group);
+    }
+}
+
+SizeT ConsoleAskHex(String const& question, Boolean hasDefaultValue = false, SizeT defaultValue = 0) {
+    while(true) {
+        Console::SetTextStyle(FOREGROUND_INTENSITY);
+        Console::Write(question + " [<hex>" + (hasDefaultValue ? (", <empty> = " + ToString<SizeT>(defaultValue, std::ios_base::uppercase | std::ios_base::hex)) : String()) + "]: 0x");
+        try {
+            Console::SetTextStyle(FOREGROUND_BLUE | FOREGROUND_INTENSITY);
+            String valueString = Console::ReadLine();
+            Console::ResetTextStyle();
+            if(hasDefaultValue && (valueString == "")) {
+                return defaultValue;
+            }
+            return FromString<SizeT>(valueString, std::ios_base::hex);
+        }
+        catch(Int8) {
+            ConsoleWriteInvalidInput();
+        }
+    }
+}
+
+String PointerChainToString(PointerChain const& chain) {
+    String string = chain.module + "+0x" + ToString<SizeT>(chain.offset, std::ios_base::uppercase | std::ios_base::hex);
+    for(SizeT const offset : chain.offsets) {
+        string += " -> 0x" + ToString<SizeT>(offset, std::ios_base::uppercase | std::ios_base::hex);
+    }
+    return string;
+}
+
+void BeginMemoryPointerProcess(MemoryModder& modder) {
+    SizeT target = ConsoleAskHex("Target address");
+    SizeT maxDepth = ConsoleAskHex("Most pointers in a chain", true, 5);
+    SizeT maxOffset = ConsoleAskHex("Largest offset", true, 0x1000);
+
+    std::vector<PointerChain> chains = std::vector<PointerChain>();
+    try {
+        // A saved map can be searched for other targets without reading the process again, as long as the memory did not move
+        Boolean const load = ConsoleAskYesNoQuestion("Load a saved pointer map", true, false);
+        String path = String();
+        if(load) {
+            Console::SetTextStyle(FOREGROUND_INTENSITY);
+            Console::Write("File: ");
+            Console::ResetTextStyle();
+            path = Console::ReadLine();
+        }
+
+        Console::SetTextStyle(FOREGROUND_INTENSITY);
+        Console::WriteLine("...");
+        Console::ResetTextStyle();
+
+        PointerMap map = load ? PointerMap::Load(path) : modder.CreatePointerMap();
+
+        Console::SetTextStyle(FOREGROUND_INTENSITY);
+        Console::WriteLine(ToString<SizeT>(map.GetCount()) + " pointers, " + AbbreviateInteger<SizeT>(map.GetMemoryUsage()) + "B");
+        Console::ResetTextStyle();
+
+        if(!load && ConsoleAskYesNoQuestion("Save the pointer map", true, false)) {
+            Console::SetTextStyle(FOREGROUND_INTENSITY);
+            Console::Write("File: ");
+            Console::ResetTextStyle();
+            try {
+                map.Save(Console::ReadLine());
+            }
+            catch(Int8) {
+                Console::ErrorLine("Failed to write the pointer map.");
+            }
+        }
+
+        Console::SetTextStyle(FOREGROUND_INTENSITY);
+        Console::WriteLine("...");
+        Console::ResetTextStyle();
+
+        chains = modder.FindPointerChains(map, target, maxDepth, maxOffset);
+    }
+    catch(Int8 e) {
+        if(e == 1) {
+            Console::ErrorLine("This process has too much memory for a pointer map.");
+        }
+        else if(e == 2) {
+            Console::ErrorLine("Failed to read the pointer map.");
+        }
+        return;
+    }
+
+    while(true) {
+        Console::Clear();
+        Console::SetTextStyle(FOREGROUND_INTENSITY);
+        Console::WriteLine("-- " + modder.GetProcessName() + " --");
+        Console::WriteLine();
+        Console::WriteLine("Chains to 0x" + ToString<SizeT>(target, std::ios_base::uppercase | std::ios_base::hex) + ": " + ToString<SizeT>(chains.size()));
+        Console::ResetTextStyle();
+
+        std::vector<TableColumn> columns = std::vector<TableColumn>();
+        columns.push_back(TableColumn("#", FOREGROUND_INTENSITY, FOREGROUND_INTENSITY, 0));
+        columns.push_back(TableColumn("Chain", FOREGROUND_INTENSITY, FOREGROUND_BLUE | FOREGROUND_INTENSITY, 0));
+
+        std::vector<std::vector<String>> rows = std::vector<std::vector<String>>();
+        for(SizeT index = 0, size = min(chains.size(), static_cast<SizeT>(16)); index < size; ++index) {
+            std::vector<String> row = std::vector<String>();
+            row.push_back(ToString<SizeT>(index));
+            row.push_back(PointerChainToString(chains[index]));
+            rows.push_back(row);
+        }
+        WriteTable(Table(columns, rows), false, 0, 0, FOREGROUND_INTENSITY);
+        Console::WriteLine();
+
+        // Once the target moved, e.g. after loading again, only the chains that still lead to it are kept
+        if(!ConsoleAskYesNoQuestion("Keep the chains that lead to a new target address", true, false)) {
+            return;
+        }
+
+        target = ConsoleAskHex("New target address");
+        chains = modder.FilterPointerChains(chains, target);
+    }
+}
+
+void BeginMemoryDumpProcess(MemoryModder& modder) {
+    Console::SetTextStyle(FOREGROUND_INTENSITY);
+    Console::Write("File: ");
+    Console::ResetTextStyle();
+    String path = Console::ReadLine();
+    Boolean const compress = ConsoleAskYesNoQuestion("Compress the pages", true, true);
+
+    Console::SetTextStyle(FOREGROUND_INTENSITY);
+    Console::WriteLine("...");
+    Console::ResetTextStyle();
+
+    try {
+        modder.SaveDump(path, compress);
+    }
+    catch(Int8) {
+        Console::ErrorLine("Failed to write the dump.");
+    }
+}
+
 void BeginProcessOptions(MemoryModder& modder) {
     while(true) {
         Console::Clear();
         Console::SetTextStyle(FOREGROUND_INTENSITY);
-        Console::Write("Memory: [back, mod]: ");
+        Console::Write("Memory: [back, mod, pattern, group, pointers, dump, unfreeze]: ");
         Console::ResetTextStyle();
         String task = Console::ReadLine();
 
@@ -454,6 +830,22 @@ void BeginProcessOptions(MemoryModder& modder) {
         else if(task == "mod") {
             BeginMemoryModdingTypeOptions(modder);
         }
+        else if(task == "pattern") {
+            BeginMemoryPatternProcess(modder);
+        }
+        else if(task == "group") {
+            BeginMemoryGroupProcess(modder);
+        }
+        else if(task == "pointers") {
+            BeginMemoryPointerProcess(modder);
+        }
+        else if(task == "dump") {
+            BeginMemoryDumpProcess(modder);
+        }
+        else if(task == "unfreeze") {
+            modder.UnfreezeProcess();
+            modder.UnfreezeAll();
+        }
         //else if(task == "corrupt") {
             // Add warnings and confirmation inputs, e.g. vm is highly recommended
             //BeginMemoryCorruption(modder);
@@ -480,7 +872,7 @@ int main() {
             }
         }
 
-        DWORD processId = process->GetId();
+        SizeT processId = process->GetId();
         String processName = process->GetName();
 
         try {
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Types.hpp"
+
+/// <summary>An executable or library loaded into a process, its address changes every run but not the layout inside it.</summary>
+struct Module {
+public:
+    Module(String const& name, SizeT const base, SizeT const size) {
+        _name = name;
+        _base = base;
+        _size = size;
+    }
+
+    inline String const& GetName() const noexcept {
+        return _name;
+    }
+
+    inline SizeT GetBase() const noexcept {
+        return _base;
+    }
+
+    inline SizeT GetSize() const noexcept {
+        return _size;
+    }
+
+    inline SizeT GetEnd() const noexcept {
+        return _base + _size;
+    }
+
+    inline Boolean IsInside(SizeT const address) const noexcept {
+        return ((address >= _base) && (address < (_base + _size)));
+    }
+
+private:
+    String _name;
+    SizeT _base;
+    SizeT _size;
+};
@@ -0,0 +1,224 @@
+#pragma once
+
+#include <cstring>
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "Types.hpp"
+#include "Platform.hpp"
+
+/// <summary>
+/// <para>Copies of recently read pages of a process, so repeated small reads of the same pages within a frame cost a copy instead of a call.</para>
+/// <para>Pages are only used in the generation they were read in, the caller moves to the next generation once per tick or frame to see new values.</para>
+/// <para>The least recently used page is dropped once the cache is full. Safe to use from several threads.</para>
+/// </summary>
+struct PageCache {
+public:
+    static constexpr SizeT pageSize = 0x1000;
+
+private:
+    struct CachedPage {
+    public:
+        CachedPage(SizeT const _page) {
+            page = _page;
+        }
+
+        // Address of the page
+        SizeT page;
+        UInt64 generation = 0;
+        UInt8 data[pageSize];
+    };
+
+public:
+    /// <param name="capacity">The most pages kept, 0 disables the cache.</param>
+    PageCache(SizeT const capacity = 0) {
+        _capacity = capacity;
+    }
+
+    PageCache(PageCache const&) = delete;
+    PageCache& operator=(PageCache const&) = delete;
+
+    Boolean IsEnabled() {
+        std::unique_lock<std::mutex> lock = std::unique_lock<std::mutex>(_mutex);
+        return _capacity != 0;
+    }
+
+    /// <summary>Sets the most pages kept, 0 disables the cache and drops every page.</summary>
+    void SetCapacity(SizeT const capacity) {
+        std::unique_lock<std::mutex> lock = std::unique_lock<std::mutex>(_mutex);
+        _capacity = capacity;
+        while(_pages.size() > _capacity) {
+            _index.erase(_pages.back().page);
+            _pages.pop_back();
+        }
+    }
+
+    /// <summary>Moves to the next generation, pages read before are read again on their next use.</summary>
+    /// <returns>The new generation.</returns>
+    UInt64 NextGeneration() {
+        std::unique_lock<std::mutex> lock = std::unique_lock<std::mutex>(_mutex);
+        return ++_generation;
+    }
+
+    UInt64 GetGeneration() {
+        std::unique_lock<std::mutex> lock = std::unique_lock<std::mutex>(_mutex);
+        return _generation;
+    }
+
+    /// <summary>
+    /// <para>Copies size bytes from address to data, pages missing from the current generation are read with the reader first.</para>
+    /// <para>reader: SizeT(SizeT address, SizeT size, UInt8* data), returns the number of bytes read or 0 if the read failed.</para>
+    /// <para>The reader is called without holding the cache, so threads missing different pages read them at the same time.</para>
+    /// </summary>
+    /// <returns>False if a page could not be read as a whole, data is incomplete then.</returns>
+    template<typename Reader>
+    Boolean Read(SizeT const address, SizeT const size, UInt8* data, Reader&& reader) {
+        std::unique_lock<std::mutex> lock = std::unique_lock<std::mutex>(_mutex);
+        if(_capacity == 0) {
+            return false;
+        }
+
+        UInt8 pageData[pageSize];
+        for(SizeT position = address, end = address + size; position < end;) {
+            SizeT const page = position & ~(pageSize - 1);
+            SizeT const length = min(end, page + pageSize) - position;
+
+            CachedPage* cachedPage = FindPage(page);
+            if(cachedPage != nullptr) {
+                ++_hits;
+                memcpy(data + (position - address), cachedPage->data + (position - page), length);
+                position += length;
+                continue;
+            }
+
+            ++_misses;
+            UInt64 const generation = _generation;
+            UInt64 const changes = _changes;
+
+            lock.unlock();
+            Boolean const success = reader(page, pageSize, pageData) == pageSize;
+            lock.lock();
+
+            if(!success) {
+                return false;
+            }
+
+            // Bytes written or dropped meanwhile may be missing from the read, those are only used for this read
+            if((generation == _generation) && (changes == _changes)) {
+                AddPage(page, pageData);
+            }
+
+            memcpy(data + (position - address), pageData + (position - page), length);
+            position += length;
+        }
+
+        return true;
+    }
+
+    /// <summary>Updates the pages of the current generation with bytes that were written to the process.</summary>
+    void Write(SizeT const address, SizeT const size, UInt8 const* data) {
+        std::unique_lock<std::mutex> lock = std::unique_lock<std::mutex>(_mutex);
+        ++_changes;
+
+        for(SizeT position = address, end = address + size; position < end;) {
+            SizeT const page = position & ~(pageSize - 1);
+            SizeT const length = min(end, page + pageSize) - position;
+
+            std::unordered_map<SizeT, std::list<CachedPage>::iterator>::iterator const it = _index.find(page);
+            if((it != _index.end()) && (it->second->generation == _generation)) {
+                memcpy(it->second->data + (position - page), data + (position - address), length);
+            }
+            position += length;
+        }
+    }
+
+    /// <summary>Drops the pages holding size bytes from address, e.g. after a write failed halfway.</summary>
+    void Invalidate(SizeT const address, SizeT const size) {
+        std::unique_lock<std::mutex> lock = std::unique_lock<std::mutex>(_mutex);
+        ++_changes;
+
+        for(SizeT page = address & ~(pageSize - 1); page < (address + size); page += pageSize) {
+            std::unordered_map<SizeT, std::list<CachedPage>::iterator>::iterator const it = _index.find(page);
+            if(it != _index.end()) {
+                it->second->generation = 0;
+            }
+        }
+    }
+
+    /// <returns>The number of pages found in the cache.</returns>
+    UInt64 GetHits() {
+        std::unique_lock<std::mutex> lock = std::unique_lock<std::mutex>(_mutex);
+        return _hits;
+    }
+
+    /// <returns>The number of pages that had to be read.</returns>
+    UInt64 GetMisses() {
+        std::unique_lock<std::mutex> lock = std::unique_lock<std::mutex>(_mutex);
+        return _misses;
+    }
+
+    void ResetCounters() {
+        std::unique_lock<std::mutex> lock = std::unique_lock<std::mutex>(_mutex);
+        _hits = 0;
+        _misses = 0;
+    }
+
+private:
+    /// <returns>The page if it was read in the current generation, otherwise null.</returns>
+    CachedPage* FindPage(SizeT const page) {
+        std::unordered_map<SizeT, std::list<CachedPage>::iterator>::iterator const it = _index.find(page);
+        if((it == _index.end()) || (it->second->generation != _generation)) {
+            return nullptr;
+        }
+
+        // Most recently used pages are at the front
+        _pages.splice(_pages.begin(), _pages, it->second);
+        return &*it->second;
+    }
+
+    /// <summary>Keeps the data of page for the current generation, another thread may have added it already.</summary>
+    void AddPage(SizeT const page, UInt8 const* data) {
+        if(_capacity == 0) {
+            return;
+        }
+
+        std::unordered_map<SizeT, std::list<CachedPage>::iterator>::iterator const it = _index.find(page);
+        if(it != _index.end()) {
+            _pages.splice(_pages.begin(), _pages, it->second);
+            if(it->second->generation == _generation) {
+                return;
+            }
+        }
+        else if(_pages.size() < _capacity) {
+            _pages.push_front(CachedPage(page));
+            _index[page] = _pages.begin();
+        }
+        else {
+            // The least recently used page makes room
+            _index.erase(_pages.back().page);
+            _pages.splice(_pages.begin(), _pages, std::prev(_pages.end()));
+            _pages.front().page = page;
+            _index[page] = _pages.begin();
+        }
+
+        CachedPage& cachedPage = _pages.front();
+        memcpy(cachedPage.data, data, pageSize);
+        cachedPage.generation = _generation;
+    }
+
+    std::mutex _mutex;
+    SizeT _capacity;
+    // Generation 0 marks pages that are never valid
+    UInt64 _generation = 1;
+    // Counts writes and invalidations, a page read while one happened is not kept
+    UInt64 _changes = 0;
+
+    std::list<CachedPage> _pages = std::list<CachedPage>();
+    std::unordered_map<SizeT, std::list<CachedPage>::iterator> _index = std::unordered_map<SizeT, std::list<CachedPage>::iterator>();
+
+    UInt64 _hits = 0;
+    UInt64 _misses = 0;
+};
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <cstring>
+
+#include "Types.hpp"
+#include "Platform.hpp"
+
+/// <summary>
+/// <para>A small LZ77 codec for single pages of memory, used by dump files to compress every page of a region on its own.</para>
+/// <para>A block is a list of sequences: a token with the literal length in the high 4 bits and the match length minus 4 in the low 4 bits, longer lengths continued with bytes that add up, the literals, and a 2 byte offset back to the match. The last sequence has no offset.</para>
+/// <para>Pages only need a small window, so offsets fit in 16 bits and decoding is a few copies per sequence.</para>
+/// </summary>
+struct PageCodec {
+public:
+    /// <summary>Pages are at most this large, so every offset fits in 16 bits.</summary>
+    static constexpr SizeT MaxSize = 0x10000;
+
+    /// <summary>Compresses size bytes of source into at most capacity bytes of destination.</summary>
+    /// <returns>The size of the block, or 0 if it does not fit in capacity.</returns>
+    static SizeT Compress(UInt8 const* source, SizeT const size, UInt8* destination, SizeT const capacity) {
+        if(size > MaxSize) {
+            return 0;
+        }
+
+        // Positions plus 1 of the last 4 bytes with a hash, 0 is empty
+        UInt16 table[HashSize];
+        memset(table, 0, sizeof(table));
+
+        SizeT output = 0;
+        SizeT anchor = 0;
+        SizeT position = 0;
+        while((position + MinMatch) <= size) {
+            UInt32 const value = Load32(source + position);
+            UInt32 const hash = Hash(value);
+            SizeT const candidate = static_cast<SizeT>(table[hash]);
+            table[hash] = static_cast<UInt16>(position + 1);
+
+            if((candidate == 0) || (Load32(source + candidate - 1) != value)) {
+                ++position;
+                continue;
+            }
+
+            SizeT const match = candidate - 1;
+            SizeT length = MinMatch;
+            while(((position + length) < size) && (source[match + length] == source[position + length])) {
+                ++length;
+            }
+
+            if(!WriteSequence(destination, capacity, output, source + anchor, position - anchor, position - match, length)) {
+                return 0;
+            }
+            position += length;
+            anchor = position;
+        }
+
+        if(!WriteSequence(destination, capacity, output, source + anchor, size - anchor, 0, 0)) {
+            return 0;
+        }
+        return output;
+    }
+
+    /// <summary>Decompresses a block of size bytes into exactly destinationSize bytes of destination.</summary>
+    /// <returns>False if the block is damaged or does not decompress to destinationSize bytes.</returns>
+    static Boolean Decompress(UInt8 const* source, SizeT const size, UInt8* destination, SizeT const destinationSize) {
+        SizeT input = 0;
+        SizeT output = 0;
+        while(input < size) {
+            UInt8 const token = source[input++];
+
+            SizeT literalLength = token >> 4;
+            if(!ReadLength(source, size, input, literalLength) || (literalLength > (size - input)) || (literalLength > (destinationSize - output))) {
+                return false;
+            }
+            memcpy(destination + output, source + input, literalLength);
+            input += literalLength;
+            output += literalLength;
+
+            // The last sequence ends with its literals
+            if(input == size) {
+                break;
+            }
+
+            if((size - input) < sizeof(UInt16)) {
+                return false;
+            }
+            SizeT const offset = static_cast<SizeT>(source[input]) | (static_cast<SizeT>(source[input + 1]) << 8);
+            input += sizeof(UInt16);
+
+            SizeT matchLength = token & 0x0F;
+            if(!ReadLength(source, size, input, matchLength)) {
+                return false;
+            }
+            matchLength += MinMatch;
+            if((offset == 0) || (offset > output) || (matchLength > (destinationSize - output))) {
+                return false;
+            }
+
+            // Matches may overlap their own output, e.g. a run of one repeated value
+            UInt8 const* match = destination + output - offset;
+            if(offset >= matchLength) {
+                memcpy(destination + output, match, matchLength);
+            }
+            else {
+                for(SizeT i = 0; i < matchLength; ++i) {
+                    destination[output + i] = match[i];
+                }
+            }
+            output += matchLength;
+        }
+
+        return output == destinationSize;
+    }
+
+private:
+    static constexpr SizeT MinMatch = 4;
+    static constexpr SizeT HashBits = 12;
+    static constexpr SizeT HashSize = static_cast<SizeT>(1) << HashBits;
+
+    static inline UInt32 Load32(UInt8 const* data) {
+        UInt32 value;
+        memcpy(&value, data, sizeof(UInt32));
+        return value;
+    }
+
+    static inline UInt32 Hash(UInt32 const value) {
+        return (value * 2654435761U) >> (32 - HashBits);
+    }
+
+    /// <summary>Writes a sequence, a match length of 0 writes the last sequence without an offset.</summary>
+    /// <returns>False if it does not fit in capacity.</returns>
+    static Boolean WriteSequence(UInt8* destination, SizeT const capacity, SizeT& output, UInt8 const* literals, SizeT const literalLength, SizeT const offset, SizeT const matchLength) {
+        SizeT const matchCode = (matchLength != 0) ? (matchLength - MinMatch) : 0;
+        // Token, lengths past 15 take a byte for every 255, literals and offset
+        SizeT const sequenceSize = 1 + ((literalLength + 240) / 255) + literalLength + ((matchLength != 0) ? (sizeof(UInt16) + ((matchCode + 240) / 255)) : 0);
+        if(sequenceSize > (capacity - output)) {
+            return false;
+        }
+
+        destination[output++] = static_cast<UInt8>((min(literalLength, static_cast<SizeT>(15)) << 4) | min(matchCode, static_cast<SizeT>(15)));
+        WriteLength(destination, output, literalLength);
+        memcpy(destination + output, literals, literalLength);
+        output += literalLength;
+
+        if(matchLength != 0) {
+            destination[output++] = static_cast<UInt8>(offset);
+            destination[output++] = static_cast<UInt8>(offset >> 8);
+            WriteLength(destination, output, matchCode);
+        }
+        return true;
+    }
+
+    /// <summary>Writes the part of a length the token does not hold.</summary>
+    static inline void WriteLength(UInt8* destination, SizeT& output, SizeT const length) {
+        if(length < 15) {
+            return;
+        }
+        SizeT rest = length - 15;
+        for(; rest >= 255; rest -= 255) {
+            destination[output++] = 255;
+        }
+        destination[output++] = static_cast<UInt8>(rest);
+    }
+
+    /// <summary>Adds the bytes continuing a length of 15 from the token.</summary>
+    static inline Boolean ReadLength(UInt8 const* source, SizeT const size, SizeT& input, SizeT& length) {
+        if(length < 15) {
+            return true;
+        }
+        while(input < size) {
+            UInt8 const value = source[input++];
+            length += value;
+            if(value != 255) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
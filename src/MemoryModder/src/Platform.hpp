@@ -0,0 +1,37 @@
+#pragma once
+
+#if defined(_WIN32)
+
+#include <Windows.h>
+
+#else
+
+#include "Types.hpp"
+
+// Windows.h has min and max as macros, the library uses them on every platform
+template<typename T>
+constexpr T min(T const a, T const b) noexcept {
+    return (b < a) ? b : a;
+}
+
+template<typename T>
+constexpr T max(T const a, T const b) noexcept {
+    return (a < b) ? b : a;
+}
+
+// Regions are described with the PAGE_ and MEM_ flags of Windows on every platform
+constexpr UInt32 PAGE_NOACCESS = 0x01;
+constexpr UInt32 PAGE_READONLY = 0x02;
+constexpr UInt32 PAGE_READWRITE = 0x04;
+constexpr UInt32 PAGE_WRITECOPY = 0x08;
+constexpr UInt32 PAGE_EXECUTE = 0x10;
+constexpr UInt32 PAGE_EXECUTE_READ = 0x20;
+constexpr UInt32 PAGE_EXECUTE_READWRITE = 0x40;
+constexpr UInt32 PAGE_EXECUTE_WRITECOPY = 0x80;
+constexpr UInt32 PAGE_GUARD = 0x100;
+
+constexpr UInt32 MEM_PRIVATE = 0x20000;
+constexpr UInt32 MEM_MAPPED = 0x40000;
+constexpr UInt32 MEM_IMAGE = 0x1000000;
+
+#endif
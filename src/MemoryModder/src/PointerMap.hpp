@@ -0,0 +1,301 @@
+#pragma once
+
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+#include "Types.hpp"
+#include "MemoryList.hpp"
+#include "Module.hpp"
+
+#pragma pack(push, 4)
+/// <summary>A pointer found while building a pointer map, packed so the entries of a large process fit in memory while sorting.</summary>
+struct PointerEntry {
+public:
+    PointerEntry(UInt64 const _value, UInt32 const _location) {
+        value = _value;
+        location = _location;
+    }
+
+    inline Boolean operator<(PointerEntry const& other) const noexcept {
+        return (value < other.value) || ((value == other.value) && (location < other.location));
+    }
+
+    UInt64 value;
+    // Index of the address the pointer is stored at, see PointerMap::GetLocation
+    UInt32 location;
+};
+#pragma pack(pop)
+
+/// <summary>
+/// <para>The way from a module to an address: the pointer at module + offset, plus offsets[0], read as a pointer, plus offsets[1] and so on.</para>
+/// <para>Chains stay valid when the process is started again, as long as its code did not change.</para>
+/// </summary>
+struct PointerChain {
+public:
+    PointerChain(String const& _module, SizeT const _offset, std::vector<SizeT> const& _offsets) {
+        module = _module;
+        offset = _offset;
+        offsets = _offsets;
+    }
+
+    String module;
+    SizeT offset;
+    std::vector<SizeT> offsets;
+};
+
+/// <summary>
+/// <para>Every pointer in a process that points into readable memory, sorted by the address it points to.</para>
+/// <para>Each pointer takes 8 bytes: the low half of its value and the index of its location. The high halves are shared by groups of pointers.</para>
+/// </summary>
+struct PointerMap {
+private:
+    struct PointerRegion {
+    public:
+        PointerRegion(SizeT const _start, SizeT const _size, SizeT const _index) {
+            start = _start;
+            size = _size;
+            index = _index;
+        }
+
+        SizeT start;
+        SizeT size;
+        // Location index of the first address of the region
+        SizeT index;
+    };
+
+    struct PointerGroup {
+    public:
+        PointerGroup(UInt32 const _high, UInt64 const _first) {
+            high = _high;
+            first = _first;
+        }
+
+        UInt32 high;
+        // Index of the first pointer with this high half
+        UInt64 first;
+    };
+
+public:
+    /// <param name="memoryList">The scanned memory with a stride of <code>sizeof(SizeT)</code>, location indices count its addresses.</param>
+    /// <param name="entries">Every pointer found, sorted.</param>
+    PointerMap(MemoryList<SizeT> const& memoryList, std::vector<Module> const& modules, std::vector<PointerEntry> const& entries) {
+        SizeT index = 0;
+        for(MemoryRegion<SizeT> const& region : memoryList) {
+            _regions.push_back(PointerRegion(region.GetStart(), region.GetSize(), index));
+            index += region.GetSize() / sizeof(SizeT);
+        }
+
+        _modules = modules;
+
+        _lows.reserve(entries.size());
+        _locations.reserve(entries.size());
+        for(SizeT i = 0, s = entries.size(); i < s; ++i) {
+            UInt32 const high = static_cast<UInt32>(entries[i].value >> 32);
+            if(_groups.empty() || (_groups.back().high != high)) {
+                _groups.push_back(PointerGroup(high, i));
+            }
+
+            _lows.push_back(static_cast<UInt32>(entries[i].value));
+            _locations.push_back(entries[i].location);
+        }
+    }
+
+    inline SizeT GetCount() const noexcept {
+        return _lows.size();
+    }
+
+    inline std::vector<Module> const& GetModules() const noexcept {
+        return _modules;
+    }
+
+    /// <returns>The number of bytes used by the map.</returns>
+    inline SizeT GetMemoryUsage() const noexcept {
+        return (_lows.capacity() * sizeof(UInt32)) + (_locations.capacity() * sizeof(UInt32)) + (_groups.capacity() * sizeof(PointerGroup)) + (_regions.capacity() * sizeof(PointerRegion));
+    }
+
+    /// <returns>The address of a location index.</returns>
+    SizeT GetLocation(SizeT const location) const {
+        std::vector<PointerRegion>::const_iterator const it = std::upper_bound(_regions.begin(), _regions.end(), location, [](SizeT const index, PointerRegion const& region) {
+            return index < region.index;
+        }) - 1;
+
+        return it->start + ((location - it->index) * sizeof(SizeT));
+    }
+
+    /// <returns>The module the address is inside of, or null.</returns>
+    Module const* FindModule(SizeT const address) const noexcept {
+        for(Module const& module : _modules) {
+            if(module.IsInside(address)) {
+                return &module;
+            }
+        }
+        return nullptr;
+    }
+
+    /// <summary>Calls visitor(SizeT value, SizeT location) for every pointer with a value from low to high, ascending by value. location is the address the pointer is stored at.</summary>
+    template<typename Visitor>
+    void FindPointers(SizeT const low, SizeT const high, Visitor&& visitor) const {
+        if(_lows.empty() || (low > high)) {
+            return;
+        }
+
+        // The last group starting at or before low, or the first group
+        UInt32 const lowHigh = static_cast<UInt32>(static_cast<UInt64>(low) >> 32);
+        SizeT group = static_cast<SizeT>(std::upper_bound(_groups.begin(), _groups.end(), lowHigh, [](UInt32 const value, PointerGroup const& pointerGroup) {
+            return value < pointerGroup.high;
+        }) - _groups.begin());
+        group = (group == 0) ? 0 : (group - 1);
+
+        SizeT index = static_cast<SizeT>(_groups[group].first);
+        if(_groups[group].high == lowHigh) {
+            SizeT const groupEnd = GetGroupEnd(group);
+            index = static_cast<SizeT>(std::lower_bound(_lows.begin() + index, _lows.begin() + groupEnd, static_cast<UInt32>(low)) - _lows.begin());
+        }
+        else if(_groups[group].high < lowHigh) {
+            // Every pointer of this group is below low
+            index = GetGroupEnd(group);
+            ++group;
+        }
+
+        for(SizeT s = _lows.size(); index < s; ++index) {
+            while(index >= GetGroupEnd(group)) {
+                ++group;
+            }
+
+            SizeT const value = static_cast<SizeT>((static_cast<UInt64>(_groups[group].high) << 32) | _lows[index]);
+            if(value > high) {
+                break;
+            }
+
+            visitor(value, GetLocation(_locations[index]));
+        }
+    }
+
+    /// <summary>
+    /// <para>Writes the map to a file, so it can be searched again without the process.</para>
+    /// <para>Possible exceptions:</para>
+    /// <para>(Int8)1: The file cannot be written.</para>
+    /// </summary>
+    void Save(String const& path) const {
+        std::ofstream file = std::ofstream(path, std::ios_base::binary | std::ios_base::trunc);
+
+        WriteValue<UInt32>(file, FileMagic);
+        WriteValue<UInt32>(file, FileVersion);
+        WriteValue<UInt32>(file, static_cast<UInt32>(sizeof(SizeT)));
+
+        WriteValue<UInt64>(file, _modules.size());
+        for(Module const& module : _modules) {
+            WriteValue<UInt64>(file, module.GetName().length());
+            file.write(module.GetName().data(), static_cast<std::streamsize>(module.GetName().length()));
+            WriteValue<UInt64>(file, module.GetBase());
+            WriteValue<UInt64>(file, module.GetSize());
+        }
+
+        WriteVector(file, _regions);
+        WriteVector(file, _groups);
+        WriteVector(file, _lows);
+        WriteVector(file, _locations);
+
+        if(!file) {
+            throw (Int8)1;
+        }
+    }
+
+    /// <summary>
+    /// <para>Reads a map written by Save.</para>
+    /// <para>Possible exceptions:</para>
+    /// <para>(Int8)2: The file cannot be read or is not a pointer map of this pointer size.</para>
+    /// </summary>
+    static PointerMap Load(String const& path) {
+        std::ifstream file = std::ifstream(path, std::ios_base::binary);
+
+        if((ReadValue<UInt32>(file) != FileMagic) || (ReadValue<UInt32>(file) != FileVersion) || (ReadValue<UInt32>(file) != sizeof(SizeT))) {
+            throw (Int8)2;
+        }
+
+        PointerMap map = PointerMap();
+
+        UInt64 const moduleCount = ReadValue<UInt64>(file);
+        for(UInt64 i = 0; (i < moduleCount) && file; ++i) {
+            String name = String(static_cast<SizeT>(ReadLength(file, 1)), '\0');
+            file.read(name.data(), static_cast<std::streamsize>(name.length()));
+            SizeT const base = static_cast<SizeT>(ReadValue<UInt64>(file));
+            SizeT const size = static_cast<SizeT>(ReadValue<UInt64>(file));
+            map._modules.push_back(Module(name, base, size));
+        }
+
+        ReadVector(file, map._regions);
+        ReadVector(file, map._groups);
+        ReadVector(file, map._lows);
+        ReadVector(file, map._locations);
+
+        if(!file || (map._lows.size() != map._locations.size()) || (map._lows.empty() != map._groups.empty())) {
+            throw (Int8)2;
+        }
+
+        return map;
+    }
+
+private:
+    static constexpr UInt32 FileMagic = 0x4D504D4D;
+    static constexpr UInt32 FileVersion = 1;
+
+    PointerMap() = default;
+
+    inline SizeT GetGroupEnd(SizeT const group) const noexcept {
+        return ((group + 1) < _groups.size()) ? static_cast<SizeT>(_groups[group + 1].first) : _lows.size();
+    }
+
+    template<typename V>
+    static inline void WriteValue(std::ofstream& file, V const value) {
+        file.write(reinterpret_cast<char const*>(&value), sizeof(V));
+    }
+
+    template<typename V>
+    static inline V ReadValue(std::ifstream& file) {
+        V value = V();
+        file.read(reinterpret_cast<char*>(&value), sizeof(V));
+        return value;
+    }
+
+    /// <summary>Reads a count of elements and fails the stream if they cannot all be in the rest of the file.</summary>
+    static UInt64 ReadLength(std::ifstream& file, SizeT const elementSize) {
+        UInt64 const count = ReadValue<UInt64>(file);
+
+        std::streampos const position = file.tellg();
+        file.seekg(0, std::ios_base::end);
+        std::streampos const end = file.tellg();
+        file.seekg(position);
+
+        if(!file || (count > (static_cast<UInt64>(end - position) / elementSize))) {
+            file.setstate(std::ios_base::failbit);
+            return 0;
+        }
+        return count;
+    }
+
+    template<typename V>
+    static inline void WriteVector(std::ofstream& file, std::vector<V> const& vector) {
+        WriteValue<UInt64>(file, vector.size());
+        file.write(reinterpret_cast<char const*>(vector.data()), static_cast<std::streamsize>(vector.size() * sizeof(V)));
+    }
+
+    template<typename V>
+    static inline void ReadVector(std::ifstream& file, std::vector<V>& vector) {
+        SizeT const size = static_cast<SizeT>(ReadLength(file, sizeof(V))) * sizeof(V);
+
+        // Elements have no default constructor, so they are copied out of the raw bytes
+        std::vector<UInt8> bytes = std::vector<UInt8>(size);
+        file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(size));
+
+        V const* elements = reinterpret_cast<V const*>(bytes.data());
+        vector.assign(elements, elements + (size / sizeof(V)));
+    }
+
+    std::vector<Module> _modules = std::vector<Module>();
+    std::vector<PointerRegion> _regions = std::vector<PointerRegion>();
+    std::vector<PointerGroup> _groups = std::vector<PointerGroup>();
+    std::vector<UInt32> _lows = std::vector<UInt32>();
+    std::vector<UInt32> _locations = std::vector<UInt32>();
+};
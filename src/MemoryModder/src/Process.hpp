@@ -0,0 +1,24 @@
+#pragma once
+
+#include "Types.hpp"
+
+/// <summary>A running process, as listed by GetAllProcesses.</summary>
+struct Process {
+public:
+    Process(String const& name, SizeT const id) {
+        _name = name;
+        _id = id;
+    }
+
+    String GetName() const {
+        return _name;
+    }
+
+    SizeT GetId() const {
+        return _id;
+    }
+
+private:
+    String _name;
+    SizeT _id;
+};
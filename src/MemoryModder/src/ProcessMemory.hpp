@@ -0,0 +1,35 @@
+#pragma once
+
+/*
+    Every backend for the memory of a process has:
+
+    Memory(SizeT processId), throwing (Int8)1 if the process cannot be used and (Int8)2 if it has stopped running.
+    static std::vector<Process> GetProcesses().
+    SizeT GetProcessId() const, String GetProcessName() const and SizeT GetBaseAddress() const.
+    std::vector<Module> GetModules() const, the executable first.
+    void ForEachRegion(Visitor&& visitor) const, calling visitor(RegionInfo const& region) for every committed region, ascending.
+    SizeT Read(SizeT address, SizeT size, UInt8* data) const, returning the number of bytes read from address on or 0 if the read failed.
+    void ReadBatch(ReadRequest* requests, SizeT count) const, setting sizeRead of every request like Read would.
+    SizeT Write(SizeT address, SizeT size, UInt8 const* data) const, returning the number of bytes written or 0 if the write failed.
+    Boolean ClearDirtyPages() const and Boolean ReadDirtyPages<T>(MemoryList<T> const& memoryList, SizeT tail, DirtyPages& dirtyPages) const, false if the written pages cannot be tracked.
+
+    DumpMemory.hpp is a backend too, it reads a dump file instead of a process.
+
+    Backends are template arguments instead of virtual classes, so reads in the inner loops of searches are direct calls that can be inlined.
+*/
+
+#if defined(_WIN32)
+
+#include "WindowsProcessMemory.hpp"
+
+/// <summary>The memory of a process on this platform.</summary>
+using ProcessMemory = WindowsProcessMemory;
+
+#elif defined(__linux__)
+
+#include "LinuxProcessMemory.hpp"
+
+/// <summary>The memory of a process on this platform.</summary>
+using ProcessMemory = LinuxProcessMemory;
+
+#endif
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <vector>
+
+#include "Types.hpp"
+#include "Platform.hpp"
+#include "ReadRequest.hpp"
+
+/// <summary>
+/// <para>Groups neighbouring memory regions into page aligned windows and reads every window with a single call into a reusable buffer.</para>
+/// <para>Reading a few unused bytes between two regions is a lot cheaper than another ReadProcessMemory call.</para>
+/// <para>Windows are handed to the reader in batches, so backends that read several ranges with one call, like process_vm_readv, need one call per batch instead of one per window.</para>
+/// </summary>
+struct ReadPlanner {
+public:
+    /// <param name="pageSize">Windows start on a multiple of this size, must be a power of two.</param>
+    /// <param name="maxGap">Regions further apart than this many bytes are never read in the same window.</param>
+    /// <param name="maxWindowSize">The most bytes read with a single call, larger regions are read in chunks of this size. Batches of windows share a buffer of about this size too.</param>
+    /// <param name="maxBatchCount">The most windows in a batch, 1024 is the most ranges process_vm_readv takes.</param>
+    ReadPlanner(SizeT const pageSize = 0x1000, SizeT const maxGap = 0x4000, SizeT const maxWindowSize = 0x100000, SizeT const maxBatchCount = 0x400) {
+        _pageSize = pageSize;
+        _maxGap = maxGap;
+        _maxWindowSize = maxWindowSize;
+        _maxBatchCount = maxBatchCount;
+    }
+
+    inline SizeT GetPageSize() const noexcept {
+        return _pageSize;
+    }
+
+    inline SizeT GetMaxGap() const noexcept {
+        return _maxGap;
+    }
+
+    inline SizeT GetMaxWindowSize() const noexcept {
+        return _maxWindowSize;
+    }
+
+    inline SizeT GetMaxBatchCount() const noexcept {
+        return _maxBatchCount;
+    }
+
+    /// <summary>
+    /// <para>Reads all regions from begin to end and hands every region to the visitor. Regions MUST be in ascending order.</para>
+    /// <para>reader: void(ReadRequest* requests, SizeT count), sets sizeRead of every request to the number of bytes read or 0 if the read failed.</para>
+    /// <para>visitor: void(SizeT start, SizeT end, UInt8 const* data, SizeT size), data holds size bytes from start, which may go past end by up to tail bytes or stop short of end if the end could not be read.</para>
+    /// <para>The visitor may call Stop, no region is read or visited after that.</para>
+    /// </summary>
+    /// <param name="tail">Bytes needed past the end of every region, e.g. so a value starting at the last address can be read whole.</param>
+    template<typename Iterator, typename Reader, typename Visitor>
+    void Read(Iterator begin, Iterator end, SizeT const tail, Reader&& reader, Visitor&& visitor) {
+        // One extra page so a full window can still hold the tail, or more for long tails
+        _buffer.resize(_maxWindowSize + max(_pageSize, tail));
+        _pending.clear();
+        _windows.clear();
+        _requests.clear();
+        _batchSpans.clear();
+        _batchSize = 0;
+        _stopped = false;
+
+        for(Iterator it = begin; (it != end) && !_stopped; ++it) {
+            ReadSpan const span = ReadSpan(it->GetStart(), it->GetEnd());
+
+            if((AlignDown(span.start) + _maxWindowSize) < (span.end + tail)) {
+                // Too large to share a window, read it in chunks on its own
+                CloseWindow(tail, reader, visitor);
+                ReadBatch(tail, reader, visitor);
+                ReadChunked(span, tail, reader, visitor);
+                continue;
+            }
+
+            if(!_pending.empty()) {
+                SizeT const windowStart = AlignDown(_pending.front().start);
+                SizeT const windowEnd = _pending.back().end + tail;
+
+                if(((AlignDown(span.start) - AlignDown(windowEnd)) > _maxGap) || ((span.end + tail - windowStart) > _maxWindowSize)) {
+                    CloseWindow(tail, reader, visitor);
+                }
+            }
+
+            _pending.push_back(span);
+        }
+
+        CloseWindow(tail, reader, visitor);
+        ReadBatch(tail, reader, visitor);
+    }
+
+    /// <summary>Stops the current Read once the visitor returns.</summary>
+    inline void Stop() noexcept {
+        _stopped = true;
+    }
+
+private:
+    struct ReadSpan {
+    public:
+        ReadSpan(SizeT const _start, SizeT const _end) {
+            start = _start;
+            end = _end;
+        }
+
+        SizeT start;
+        SizeT end;
+    };
+
+    /// <summary>A window of the batch, its spans are the batch spans from first up to last.</summary>
+    struct ReadWindow {
+    public:
+        ReadWindow(SizeT const _start, SizeT const _first, SizeT const _last) {
+            start = _start;
+            first = _first;
+            last = _last;
+        }
+
+        SizeT start;
+        SizeT first;
+        SizeT last;
+    };
+
+    inline SizeT AlignDown(SizeT const address) const noexcept {
+        return address & ~(_pageSize - 1);
+    }
+
+    /// <summary>Adds the pending regions to the batch as one window, the batch is read first if the window does not fit.</summary>
+    template<typename Reader, typename Visitor>
+    void CloseWindow(SizeT const tail, Reader& reader, Visitor& visitor) {
+        if(_pending.empty()) {
+            return;
+        }
+
+        SizeT const windowStart = (_pending.size() == 1) ? _pending.front().start : AlignDown(_pending.front().start);
+        SizeT const windowSize = _pending.back().end + tail - windowStart;
+
+        if((_windows.size() == _maxBatchCount) || ((_batchSize + windowSize) > _buffer.size())) {
+            ReadBatch(tail, reader, visitor);
+        }
+
+        _windows.push_back(ReadWindow(windowStart, _batchSpans.size(), _batchSpans.size() + _pending.size()));
+        _requests.push_back(ReadRequest(windowStart, windowSize, _buffer.data() + _batchSize));
+        _batchSpans.insert(_batchSpans.end(), _pending.begin(), _pending.end());
+        _batchSize += windowSize;
+
+        _pending.clear();
+    }
+
+    /// <summary>Reads all windows of the batch, regions that could not be read that way are retried on their own.</summary>
+    template<typename Reader, typename Visitor>
+    void ReadBatch(SizeT const tail, Reader& reader, Visitor& visitor) {
+        if(_windows.empty()) {
+            return;
+        }
+
+        if(!_stopped) {
+            reader(_requests.data(), _requests.size());
+        }
+
+        for(SizeT w = 0; (w < _windows.size()) && !_stopped; ++w) {
+            ReadWindow const& window = _windows[w];
+            ReadRequest const& request = _requests[w];
+
+            for(SizeT i = window.first; (i < window.last) && !_stopped; ++i) {
+                ReadSpan const& span = _batchSpans[i];
+                UInt8* data = request.data + (span.start - window.start);
+
+                if((span.end + tail) <= (window.start + request.sizeRead)) {
+                    visitor(span.start, span.end, data, span.end + tail - span.start);
+                }
+                else {
+                    // Regions are ascending, so every region after this one failed too and the rest of the window is free to reuse
+                    ReadSingle(span, tail, (window.last - window.first) == 1, data, reader, visitor);
+                }
+            }
+        }
+
+        _windows.clear();
+        _requests.clear();
+        _batchSpans.clear();
+        _batchSize = 0;
+    }
+
+    /// <returns>The number of bytes read, or 0 if the read failed.</returns>
+    template<typename Reader>
+    static inline SizeT ReadOne(SizeT const address, SizeT const size, UInt8* data, Reader& reader) {
+        ReadRequest request = ReadRequest(address, size, data);
+        reader(&request, 1);
+        return request.sizeRead;
+    }
+
+    /// <summary>Reads one region into data, which holds its size and tail, first with its tail and then only up to the end of its last page, because the tail may be past the end of readable memory.</summary>
+    template<typename Reader, typename Visitor>
+    void ReadSingle(ReadSpan const& span, SizeT const tail, Boolean const triedTail, UInt8* data, Reader& reader, Visitor& visitor) {
+        SizeT const size = span.end - span.start;
+
+        if(!triedTail) {
+            SizeT const sizeRead = ReadOne(span.start, size + tail, data, reader);
+            if((sizeRead == (size + tail)) || ((tail == 0) && (sizeRead != 0))) {
+                visitor(span.start, span.end, data, sizeRead);
+                return;
+            }
+        }
+
+        if(tail == 0) {
+            // Nothing left to retry
+            return;
+        }
+
+        // The page holding the end of the region is readable as a whole, so values running into the rest of it stay whole
+        SizeT const pageSize = min(size + tail, AlignDown(span.end + _pageSize - 1) - span.start);
+        SizeT const sizeRead = ReadOne(span.start, pageSize, data, reader);
+        if(sizeRead != 0) {
+            visitor(span.start, span.end, data, sizeRead);
+        }
+    }
+
+    template<typename Reader, typename Visitor>
+    void ReadChunked(ReadSpan const& span, SizeT const tail, Reader& reader, Visitor& visitor) {
+        for(SizeT chunk = span.start; (chunk < span.end) && !_stopped; chunk += _maxWindowSize) {
+            ReadSpan const chunkSpan = ReadSpan(chunk, min(chunk + _maxWindowSize, span.end));
+            ReadSingle(chunkSpan, tail, false, _buffer.data(), reader, visitor);
+        }
+    }
+
+    SizeT _pageSize;
+    SizeT _maxGap;
+    SizeT _maxWindowSize;
+    SizeT _maxBatchCount;
+
+    std::vector<UInt8> _buffer = std::vector<UInt8>();
+    // Regions of the window that is not closed yet
+    std::vector<ReadSpan> _pending = std::vector<ReadSpan>();
+
+    // Closed windows waiting to be read, each with its request and its part of the buffer
+    std::vector<ReadWindow> _windows = std::vector<ReadWindow>();
+    std::vector<ReadRequest> _requests = std::vector<ReadRequest>();
+    std::vector<ReadSpan> _batchSpans = std::vector<ReadSpan>();
+    SizeT _batchSize = 0;
+
+    Boolean _stopped = false;
+};
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "Types.hpp"
+
+/// <summary>One range of a batched read, see ReadBatch of the process memory backends.</summary>
+struct ReadRequest {
+public:
+    ReadRequest(SizeT const _address, SizeT const _size, UInt8* _data) {
+        address = _address;
+        size = _size;
+        data = _data;
+    }
+
+    SizeT address;
+    SizeT size;
+    UInt8* data;
+
+    /// <summary>Set by the read to the number of bytes read from address on, or 0 if the read failed.</summary>
+    SizeT sizeRead = 0;
+};
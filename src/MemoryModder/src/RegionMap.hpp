@@ -0,0 +1,178 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "Types.hpp"
+#include "Platform.hpp"
+
+/// <summary>A committed region of a process, described with the PAGE_ and MEM_ flags of Windows on every platform.</summary>
+struct RegionInfo {
+public:
+    RegionInfo(SizeT const _start, SizeT const _size, UInt32 const _protection, UInt32 const _type) {
+        start = _start;
+        size = _size;
+        protection = _protection;
+        type = _type;
+    }
+
+    inline SizeT GetEnd() const noexcept {
+        return start + size;
+    }
+
+    inline Boolean operator==(RegionInfo const& other) const noexcept {
+        return (start == other.start) && (size == other.size) && (protection == other.protection) && (type == other.type);
+    }
+
+    SizeT start;
+    SizeT size;
+    // PAGE_ flags
+    UInt32 protection;
+    // MEM_PRIVATE, MEM_MAPPED or MEM_IMAGE
+    UInt32 type;
+};
+
+/// <summary>
+/// <para>Which regions are searched, decided from the region map alone before any bytes are read.</para>
+/// <para>The default keeps writable private and mapped memory, which holds the values of a process, and leaves out read-only mapped files like assets.</para>
+/// </summary>
+struct RegionPolicy {
+public:
+    /// <returns>A policy keeping every readable region of the types.</returns>
+    static RegionPolicy Readable(UInt32 const typeMask = MEM_PRIVATE | MEM_MAPPED) {
+        RegionPolicy policy = RegionPolicy();
+        policy.protectionMask = PAGE_READONLY | PAGE_READWRITE | PAGE_WRITECOPY | PAGE_EXECUTE_READ | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY;
+        policy.typeMask = typeMask;
+        return policy;
+    }
+
+    /// <returns>True if the region is searched.</returns>
+    inline Boolean Allows(RegionInfo const& region) const noexcept {
+        return ((region.protection & protectionMask) != 0)
+            && ((region.protection & excludedProtectionMask) == 0)
+            && ((region.type & typeMask) != 0)
+            && (region.size >= minSize) && (region.size <= maxSize)
+            && (region.GetEnd() > minAddress) && (region.start < maxAddress);
+    }
+
+    /// <summary>A region is kept if its protection has any of these PAGE_ flags.</summary>
+    UInt32 protectionMask = PAGE_READWRITE | PAGE_WRITECOPY | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY;
+    /// <summary>A region is left out if its protection has any of these PAGE_ flags, reading it would fail or trip a guard page.</summary>
+    UInt32 excludedProtectionMask = PAGE_GUARD | PAGE_NOACCESS;
+    /// <summary>A region is kept if its type is one of these MEM_ flags.</summary>
+    UInt32 typeMask = MEM_PRIVATE | MEM_MAPPED;
+
+    SizeT minSize = 0;
+    SizeT maxSize = ~static_cast<SizeT>(0);
+
+    /// <summary>Regions are cut to the window from minAddress up to maxAddress.</summary>
+    SizeT minAddress = 0;
+    SizeT maxAddress = ~static_cast<SizeT>(0);
+};
+
+/// <summary>The regions that changed between two enumerations of a region map.</summary>
+struct RegionDiff {
+public:
+    inline Boolean IsEmpty() const noexcept {
+        return added.empty() && removed.empty();
+    }
+
+    /// <summary>Regions that are new or whose protection, type or size changed, as they are now.</summary>
+    std::vector<RegionInfo> added = std::vector<RegionInfo>();
+    /// <summary>Regions that are gone or changed, as they were before.</summary>
+    std::vector<RegionInfo> removed = std::vector<RegionInfo>();
+};
+
+/// <summary>
+/// <para>The committed regions of a process, enumerated once and kept until they are refreshed.</para>
+/// <para>Every refresh is compared with the previous map, so callers can tell which regions changed, and the generation only moves on if any did.</para>
+/// </summary>
+struct RegionMap {
+public:
+    /// <summary>Enumerates the regions of the process memory again and compares them with the previous ones.</summary>
+    template<typename Memory>
+    RegionDiff Refresh(Memory const& memory) {
+        std::vector<RegionInfo> regions = std::vector<RegionInfo>();
+        regions.reserve(_regions.size());
+
+        memory.ForEachRegion([&regions](RegionInfo const& region) {
+            regions.push_back(region);
+        });
+
+        // Both lists are ascending, so one merge finds every difference
+        RegionDiff diff = RegionDiff();
+        SizeT i = 0;
+        SizeT j = 0;
+        while((i < _regions.size()) || (j < regions.size())) {
+            if((i < _regions.size()) && (j < regions.size()) && (_regions[i] == regions[j])) {
+                ++i;
+                ++j;
+            }
+            else if((j == regions.size()) || ((i < _regions.size()) && (_regions[i].start <= regions[j].start))) {
+                diff.removed.push_back(_regions[i++]);
+            }
+            else {
+                diff.added.push_back(regions[j++]);
+            }
+        }
+
+        _regions = std::move(regions);
+        _refreshTime = std::chrono::steady_clock::now();
+        _refreshed = true;
+        if(!diff.IsEmpty()) {
+            ++_generation;
+        }
+
+        return diff;
+    }
+
+    /// <returns>True if the map was never refreshed or is older than maxAge.</returns>
+    inline Boolean IsStale(std::chrono::milliseconds const maxAge) const {
+        return !_refreshed || ((std::chrono::steady_clock::now() - _refreshTime) > maxAge);
+    }
+
+    /// <summary>Drops the regions, so the next use refreshes them.</summary>
+    inline void Invalidate() noexcept {
+        _refreshed = false;
+    }
+
+    /// <returns>The number of refreshes that changed the map.</returns>
+    inline UInt64 GetGeneration() const noexcept {
+        return _generation;
+    }
+
+    /// <returns>Every committed region, ascending.</returns>
+    inline std::vector<RegionInfo> const& GetRegions() const noexcept {
+        return _regions;
+    }
+
+    /// <summary>Calls visitor(SizeT start, SizeT size) for the part inside the address window of every region the policy allows, ascending.</summary>
+    template<typename Visitor>
+    void ForEachRegion(RegionPolicy const& policy, Visitor&& visitor) const {
+        for(RegionInfo const& region : _regions) {
+            if(!policy.Allows(region)) {
+                continue;
+            }
+
+            SizeT const start = max(region.start, policy.minAddress);
+            SizeT const end = min(region.GetEnd(), policy.maxAddress);
+            visitor(start, end - start);
+        }
+    }
+
+    /// <returns>The number of bytes in the regions the policy allows.</returns>
+    SizeT GetSize(RegionPolicy const& policy) const {
+        SizeT size = 0;
+        ForEachRegion(policy, [&size](SizeT const, SizeT const regionSize) {
+            size += regionSize;
+        });
+        return size;
+    }
+
+private:
+    std::vector<RegionInfo> _regions = std::vector<RegionInfo>();
+    std::chrono::steady_clock::time_point _refreshTime = std::chrono::steady_clock::time_point();
+    Boolean _refreshed = false;
+    UInt64 _generation = 0;
+};
@@ -0,0 +1,459 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <utility>
+
+#include "Types.hpp"
+#include "Platform.hpp"
+#include "MemoryModder.hpp"
+#include "DirtyPages.hpp"
+#include "FilterExpression.hpp"
+#include "SessionFile.hpp"
+#include "SnapshotStore.hpp"
+
+/// <summary>Comparisons between the current value and the previous value of an address.</summary>
+enum struct SnapshotComparison : Int8 {
+    Changed = 0,
+    Unchanged = 1,
+    Increased = 2,
+    Decreased = 3,
+    IncreasedBy = 4,
+    DecreasedBy = 5
+};
+
+/// <summary>
+/// <para>A list of candidate addresses together with the value each address had in the previous step.</para>
+/// <para>This makes it possible to search for values that are never shown, by filtering on how they changed.</para>
+/// <para>Modder is the memory modder of the process, MemoryModder by default.</para>
+/// </summary>
+template<typename T, typename Modder = MemoryModder>
+struct ScanSession {
+public:
+    /// <param name="aligned">If true, addresses are aligned with a stride of <code>sizeof(T)</code>. Otherwise addresses are aligned with a stride of 1.</param>
+    ScanSession(Modder& modder, Boolean const aligned = true) : _modder(modder), _list(modder.template CreateList<T>(aligned)) {
+    }
+
+    inline MemoryList<T> const& GetList() const noexcept {
+        return _list;
+    }
+
+    /// <returns>True if every address in the list has a previous value.</returns>
+    inline Boolean HasValues() const noexcept {
+        return _hasValues;
+    }
+
+    /// <returns>True if the previous values are spilled to disk.</returns>
+    inline Boolean IsSpilled() const noexcept {
+        return _store != nullptr;
+    }
+
+    /// <summary>
+    /// <para>Previous values that would take more than memoryBudget bytes are spilled to a memory mapped file instead of kept in memory.</para>
+    /// <para>The mapped windows of all workers together stay within the budget. 0 keeps every value in memory.</para>
+    /// </summary>
+    /// <param name="directory">Directory of the spill files, empty uses the temporary directory.</param>
+    /// <param name="elideZeroPages">If true, pages of zero values are never written and take no memory, see SnapshotStore.</param>
+    inline void SetSpill(String const& directory, SizeT const memoryBudget, Boolean const elideZeroPages = true) {
+        _spillDirectory = directory;
+        _memoryBudget = memoryBudget;
+        _elideZeroPages = elideZeroPages;
+    }
+
+    /// <summary>
+    /// <para>If true, a step only reads the pages the process wrote since the previous step, where the process keeps track of that, see MemoryModder::ClearDirtyPages.</para>
+    /// <para>The values on the other pages are still the previous values, so every filter gets the same result from those. On by default.</para>
+    /// <para>A write in the moment between finding the written pages and clearing them is only seen once its page is written again.</para>
+    /// </summary>
+    inline void SetDirtyTracking(Boolean const track) noexcept {
+        _trackDirtyPages = track;
+        _dirtyPagesClear = 0;
+    }
+
+    /// <summary>
+    /// <para>Possible exceptions:</para>
+    /// <para>(Int8)2: The spilled values cannot be read.</para>
+    /// </summary>
+    /// <returns>The previous values of the first count addresses in the same order as the addresses in the list.</returns>
+    std::vector<T> GetFirstValues(SizeT const count) {
+        SizeT const valueCount = _hasValues ? min(count, _list.GetSize()) : 0;
+
+        std::vector<T> values = std::vector<T>();
+        try {
+            ReadValues(0, valueCount, [&values](SizeT const, T const* previousValues, SizeT const previousCount) {
+                values.insert(values.end(), previousValues, previousValues + previousCount);
+            });
+        }
+        catch(Int8) {
+            throw (Int8)2;
+        }
+        return values;
+    }
+
+    /// <summary>
+    /// <para>Writes the list and the previous values to a session file, so the search can go on after the console or the process was closed, see Load.</para>
+    /// <para>Addresses inside a module are written as offsets from the module, see SessionFile.</para>
+    /// <para>Possible exceptions:</para>
+    /// <para>(Int8)1: The file cannot be written.</para>
+    /// </summary>
+    void Save(String const& path) {
+        SessionFile<T>::Save(_modder, path, _list, _hasValues, [this](SizeT const index, SizeT const count, auto&& visitor) {
+            ReadValues(index, count, visitor);
+        });
+    }
+
+    /// <summary>
+    /// <para>Replaces the list and the previous values with a session file written by Save, also from a process that was started again since.</para>
+    /// <para>The file stays mapped until the next step and the previous values are read from it in place.</para>
+    /// <para>Possible exceptions:</para>
+    /// <para>(Int8)2: The file cannot be read or is not a session of this type.</para>
+    /// </summary>
+    void Load(String const& path) {
+        std::unique_ptr<SessionFile<T>> session = nullptr;
+        MemoryList<T> list = MemoryList<T>(1);
+        try {
+            session = std::make_unique<SessionFile<T>>(path);
+            list = session->CreateList(_modder.GetModules(), _modder.GetProcessId());
+        }
+        catch(Int8) {
+            throw (Int8)2;
+        }
+
+        _list = std::move(list);
+        _values = std::vector<T>();
+        _hasValues = session->HasValues();
+        _store = nullptr;
+        _session = _hasValues ? std::move(session) : nullptr;
+        _dirtyPagesClear = 0;
+    }
+
+    /// <summary>
+    /// <para>Stores the current value of every address in the list, for when the initial value is unknown.</para>
+    /// <para>Addresses that cannot be read are removed.</para>
+    /// <para>A full list takes about as much memory as the process itself when aligned, and <code>sizeof(T)</code> times as much when not. Use SetSpill to keep it on disk instead.</para>
+    /// <para>Possible exceptions:</para>
+    /// <para>(Int8)2: The values cannot be spilled to disk.</para>
+    /// </summary>
+    void Snapshot() {
+        Step([](UInt8 const*, SizeT const count, SizeT const, T const*, auto&& match) {
+            for(SizeT i = 0; i < count; ++i) {
+                match(i);
+            }
+        });
+    }
+
+    /// <summary>
+    /// <para>Keeps the addresses whose current value compares true with the filter value.</para>
+    /// <para>Possible exceptions:</para>
+    /// <para>(Int8)2: The values cannot be spilled to disk.</para>
+    /// </summary>
+    template<MemoryComparison comparison>
+    void Filter(T const filter) {
+        Step([filter](UInt8 const* data, SizeT const count, SizeT const stride, T const*, auto&& match) {
+            CompareValues<T, comparison>(data, count, stride, filter, match);
+        });
+    }
+
+    void Filter(T const filter, MemoryComparison const comparison) {
+        switch(comparison) {
+        case MemoryComparison::Equals: Filter<MemoryComparison::Equals>(filter); break;
+        case MemoryComparison::NotEquals: Filter<MemoryComparison::NotEquals>(filter); break;
+        case MemoryComparison::LessThan: Filter<MemoryComparison::LessThan>(filter); break;
+        case MemoryComparison::GreaterThan: Filter<MemoryComparison::GreaterThan>(filter); break;
+        case MemoryComparison::LessThanEquals: Filter<MemoryComparison::LessThanEquals>(filter); break;
+        case MemoryComparison::GreaterThanEquals: Filter<MemoryComparison::GreaterThanEquals>(filter); break;
+        default: Filter<MemoryComparison::Equals>(filter); break;
+        }
+    }
+
+    /// <summary>
+    /// <para>Keeps the addresses whose current value compares true with a range of values that count as equal, see CompareRange.</para>
+    /// <para>Possible exceptions:</para>
+    /// <para>(Int8)2: The values cannot be spilled to disk.</para>
+    /// </summary>
+    template<MemoryComparison comparison>
+    void FilterRange(T const low, T const high) {
+        Step([low, high](UInt8 const* data, SizeT const count, SizeT const stride, T const*, auto&& match) {
+            CompareRangeValues<T, comparison>(data, count, stride, low, high, match);
+        });
+    }
+
+    void FilterRange(T const low, T const high, MemoryComparison const comparison) {
+        switch(comparison) {
+        case MemoryComparison::Equals: FilterRange<MemoryComparison::Equals>(low, high); break;
+        case MemoryComparison::NotEquals: FilterRange<MemoryComparison::NotEquals>(low, high); break;
+        case MemoryComparison::LessThan: FilterRange<MemoryComparison::LessThan>(low, high); break;
+        case MemoryComparison::GreaterThan: FilterRange<MemoryComparison::GreaterThan>(low, high); break;
+        case MemoryComparison::LessThanEquals: FilterRange<MemoryComparison::LessThanEquals>(low, high); break;
+        case MemoryComparison::GreaterThanEquals: FilterRange<MemoryComparison::GreaterThanEquals>(low, high); break;
+        default: FilterRange<MemoryComparison::Equals>(low, high); break;
+        }
+    }
+
+    /// <summary>Keeps the addresses whose current float compares true with the filter value, with the floats of a tolerance counting as equal, see FilterRange.</summary>
+    void Filter(T const filter, MemoryComparison const comparison, FloatTolerance const& tolerance) {
+        T low;
+        T high;
+        tolerance.GetRange<T>(filter, low, high);
+        FilterRange(low, high, comparison);
+    }
+
+    /// <summary>
+    /// <para>Keeps the addresses whose current value compares true with their previous value.</para>
+    /// <para>Possible exceptions:</para>
+    /// <para>(Int8)1: There are no previous values, use Snapshot or a value filter first.</para>
+    /// <para>(Int8)2: The values cannot be spilled to disk.</para>
+    /// </summary>
+    /// <param name="difference">The amount the value changed by, only used by IncreasedBy and DecreasedBy.</param>
+    template<SnapshotComparison comparison>
+    void Filter(T const difference = T()) {
+        if(!_hasValues) {
+            throw (Int8)1;
+        }
+
+        Step([difference](UInt8 const* data, SizeT const count, SizeT const stride, T const* previousValues, auto&& match) {
+            for(SizeT i = 0; i < count; ++i) {
+                if(CompareSnapshot<comparison>(LoadValue<T>(data + (i * stride)), previousValues[i], difference)) {
+                    match(i);
+                }
+            }
+        });
+    }
+
+    /// <summary>
+    /// <para>Possible exceptions:</para>
+    /// <para>(Int8)1: There are no previous values, use Snapshot or a value filter first.</para>
+    /// <para>(Int8)2: The values cannot be spilled to disk.</para>
+    /// </summary>
+    void Filter(SnapshotComparison const comparison, T const difference = T()) {
+        switch(comparison) {
+        case SnapshotComparison::Changed: Filter<SnapshotComparison::Changed>(difference); break;
+        case SnapshotComparison::Unchanged: Filter<SnapshotComparison::Unchanged>(difference); break;
+        case SnapshotComparison::Increased: Filter<SnapshotComparison::Increased>(difference); break;
+        case SnapshotComparison::Decreased: Filter<SnapshotComparison::Decreased>(difference); break;
+        case SnapshotComparison::IncreasedBy: Filter<SnapshotComparison::IncreasedBy>(difference); break;
+        case SnapshotComparison::DecreasedBy: Filter<SnapshotComparison::DecreasedBy>(difference); break;
+        default: Filter<SnapshotComparison::Changed>(difference); break;
+        }
+    }
+
+    /// <summary>
+    /// <para>Keeps the addresses whose current value passes the expression, testing every predicate in a single pass.</para>
+    /// <para>Possible exceptions:</para>
+    /// <para>(Int8)1: The expression compares with previous values, but there are none, use Snapshot or a value filter first.</para>
+    /// <para>(Int8)2: The values cannot be spilled to disk.</para>
+    /// </summary>
+    void Filter(FilterExpression<T> const& expression) {
+        if(expression.UsesPrevious() && !_hasValues) {
+            throw (Int8)1;
+        }
+
+        Step([&expression](UInt8 const* data, SizeT const count, SizeT const stride, T const* previousValues, auto&& match) {
+            expression.Evaluate(data, count, stride, previousValues, match);
+        });
+    }
+
+private:
+    template<SnapshotComparison comparison>
+    static inline Boolean CompareSnapshot(T const value, T const previous, T const difference) {
+        if constexpr(comparison == SnapshotComparison::Changed) { return Compare<T, MemoryComparison::NotEquals>(value, previous); }
+        else if constexpr(comparison == SnapshotComparison::Unchanged) { return Compare<T, MemoryComparison::Equals>(value, previous); }
+        else if constexpr(comparison == SnapshotComparison::Increased) { return Compare<T, MemoryComparison::GreaterThan>(value, previous); }
+        else if constexpr(comparison == SnapshotComparison::Decreased) { return Compare<T, MemoryComparison::LessThan>(value, previous); }
+        else if constexpr(comparison == SnapshotComparison::IncreasedBy) { return Compare<T, MemoryComparison::Equals>(static_cast<T>(value - previous), difference); }
+        else if constexpr(comparison == SnapshotComparison::DecreasedBy) { return Compare<T, MemoryComparison::Equals>(static_cast<T>(previous - value), difference); }
+        return false;
+    }
+
+    /// <summary>
+    /// <para>Reads count previous values from index on, wherever they are kept.</para>
+    /// <para>visitor: void(SizeT offset, T const* values, SizeT count), see SnapshotStore::Read.</para>
+    /// <para>Possible exceptions:</para>
+    /// <para>(Int8)3: The spilled values cannot be mapped.</para>
+    /// </summary>
+    template<typename Visitor>
+    void ReadValues(SizeT const index, SizeT const count, Visitor&& visitor) {
+        if(_store != nullptr) {
+            typename SnapshotStore<T>::Cursor cursor = typename SnapshotStore<T>::Cursor(*_store);
+            _store->Read(cursor, index, count, visitor);
+        }
+        else if(_session != nullptr) {
+            _session->Read(index, count, visitor);
+        }
+        else if(count != 0) {
+            visitor(0, _values.data() + index, count);
+        }
+    }
+
+    /// <summary>
+    /// <para>Reads every address once, keeps the ones the scanner matches and stores their values for the next step.</para>
+    /// <para>scanner: void(UInt8 const* data, SizeT count, SizeT stride, T const* previousValues, match), calls match(i) in ascending order for every value i to keep. previousValues is null before the first step.</para>
+    /// <para>Possible exceptions:</para>
+    /// <para>(Int8)2: The values cannot be spilled to disk, the list and values stay as they were.</para>
+    /// </summary>
+    template<typename Scanner>
+    void Step(Scanner const& scanner) {
+        try {
+            RunStep(scanner);
+        }
+        catch(Int8) {
+            _spareStore = nullptr;
+            // The pages written since the values were taken are cleared already
+            _dirtyPagesClear = 0;
+            throw (Int8)2;
+        }
+    }
+
+    template<typename Scanner>
+    void RunStep(Scanner const& scanner) {
+        SizeT const stride = _list.GetStride();
+        SizeT const workerCount = _modder.GetWorkerCount();
+
+        MemoryList<T> newList = MemoryList<T>(stride);
+        std::vector<T> newValues = std::vector<T>();
+
+        ReadTasks<T> const tasks = _modder.template PlanReadTasks<T>(_list);
+        SizeT const taskCount = tasks.GetCount();
+
+        // Pages are cleared before reading, so a write during the step makes its page dirty for the next one
+        Boolean const dirtyOnly = _hasValues && _modder.template ReadDirtyPages<T>(_list, _dirtyPagesClear, _dirtyPages);
+        _dirtyPagesClear = _trackDirtyPages ? _modder.ClearDirtyPages() : 0;
+
+        // Every task writes its values into the slots of its own addresses, so it never has to wait for the tasks before it
+        Boolean const spill = (_memoryBudget != 0) && ((tasks.addressCount * sizeof(T)) > _memoryBudget);
+        if(spill) {
+            if(_spareStore == nullptr) {
+                // Reading the previous store and writing the next one, both with a window per worker
+                _spareStore = std::make_unique<SnapshotStore<T>>(_spillDirectory, _memoryBudget / (2 * workerCount), _elideZeroPages);
+            }
+            _spareStore->Reset(tasks.addressCount);
+        }
+
+        std::vector<typename SnapshotStore<T>::Cursor> readCursors = std::vector<typename SnapshotStore<T>::Cursor>();
+        std::vector<typename SnapshotStore<T>::Cursor> writeCursors = std::vector<typename SnapshotStore<T>::Cursor>();
+        for(SizeT worker = 0; (_store != nullptr) && (worker < workerCount); ++worker) {
+            readCursors.emplace_back(*_store);
+        }
+        for(SizeT worker = 0; spill && (worker < workerCount); ++worker) {
+            writeCursors.emplace_back(*_spareStore);
+        }
+
+        // Every task builds its own list
+        std::vector<MemoryList<T>> taskLists = std::vector<MemoryList<T>>(taskCount, MemoryList<T>(stride));
+        std::vector<std::vector<T>> taskValues = std::vector<std::vector<T>>(taskCount);
+        std::vector<SizeT> taskValueCounts = std::vector<SizeT>(taskCount, 0);
+
+        auto const visitor = [&](SizeT const task, SizeT const worker, SizeT const index, SizeT const start, SizeT const end, UInt8 const* data, SizeT const size) {
+            MemoryList<T>& taskList = taskLists[task];
+            std::vector<T>& taskValue = taskValues[task];
+            SizeT& taskValueCount = taskValueCounts[task];
+            SizeT const taskSlot = tasks.tasks[task].index;
+
+            SizeT const count = (size >= sizeof(T)) ? (size - sizeof(T) + 1) : 0;
+            SizeT const valueCount = (data == nullptr) ? ((end - start + stride - 1) / stride) : ((min(end - start, count) + stride - 1) / stride);
+
+            // Scans the values in scanData from first on, match gets the index from first
+            auto const scan = [&](SizeT const first, SizeT const scanCount, UInt8 const* scanData, SizeT const scanStride, T const* previousValues) {
+                scanner(scanData, scanCount, scanStride, previousValues, [&](SizeT const i) {
+                    T const value = LoadValue<T>(scanData + (i * scanStride));
+
+                    taskList.AddAddress(start + ((first + i) * stride));
+                    if(spill) {
+                        _spareStore->Write(writeCursors[worker], taskSlot + taskValueCount, value);
+                    }
+                    else {
+                        taskValue.push_back(value);
+                    }
+                    ++taskValueCount;
+                });
+            };
+
+            // Values on clean pages were not read, the previous values are the current ones
+            auto const scanPrevious = [&](SizeT const first, SizeT const scanCount, T const* previousValues) {
+                if(data == nullptr) {
+                    scan(first, scanCount, reinterpret_cast<UInt8 const*>(previousValues), sizeof(T), previousValues);
+                }
+                else {
+                    scan(first, scanCount, data + (first * stride), stride, previousValues);
+                }
+            };
+
+            if(!_hasValues) {
+                scan(0, valueCount, data, stride, nullptr);
+            }
+            else if(_store != nullptr) {
+                // Spilled values are only contiguous within one segment and one window
+                _store->Read(readCursors[worker], index, valueCount, [&scanPrevious](SizeT const offset, T const* previousValues, SizeT const previousCount) {
+                    scanPrevious(offset, previousCount, previousValues);
+                });
+            }
+            else if(_session != nullptr) {
+                _session->Read(index, valueCount, [&scanPrevious](SizeT const offset, T const* previousValues, SizeT const previousCount) {
+                    scanPrevious(offset, previousCount, previousValues);
+                });
+            }
+            else {
+                scanPrevious(0, valueCount, _values.data() + index);
+            }
+        };
+
+        if(dirtyOnly) {
+            _modder.template ReadTasksParallel<T>(_list, tasks, _dirtyPages, visitor);
+        }
+        else {
+            _modder.template ReadTasksParallel<T>(_list, tasks, visitor);
+        }
+
+        readCursors.clear();
+        writeCursors.clear();
+
+        for(SizeT task = 0; task < taskCount; ++task) {
+            newList.AppendList(taskLists[task]);
+
+            if(spill) {
+                _spareStore->AddSegment(tasks.tasks[task].index, taskValueCounts[task]);
+            }
+            else {
+                newValues.insert(newValues.end(), taskValues[task].begin(), taskValues[task].end());
+            }
+        }
+
+        newList.Compact();
+
+        _list = std::move(newList);
+        _values = std::move(newValues);
+        _hasValues = true;
+        _session = nullptr;
+
+        if(spill) {
+            // The old store is reused for the next step
+            std::swap(_store, _spareStore);
+        }
+        else {
+            _store = nullptr;
+            _spareStore = nullptr;
+        }
+        if(_spareStore != nullptr) {
+            _spareStore->Reset(0);
+        }
+    }
+
+    Modder& _modder;
+    MemoryList<T> _list;
+    std::vector<T> _values = std::vector<T>();
+    Boolean _hasValues = false;
+
+    // Pages written since the values were taken, known if the clear they were taken after is the latest
+    Boolean _trackDirtyPages = true;
+    UInt64 _dirtyPagesClear = 0;
+    DirtyPages _dirtyPages = DirtyPages();
+
+    // Previous values when spilled, and the store the next values are written to
+    std::unique_ptr<SnapshotStore<T>> _store = nullptr;
+    std::unique_ptr<SnapshotStore<T>> _spareStore = nullptr;
+    // Previous values of a loaded session, read in place until the next step
+    std::unique_ptr<SessionFile<T>> _session = nullptr;
+    String _spillDirectory = String();
+    SizeT _memoryBudget = 0;
+    Boolean _elideZeroPages = true;
+};
@@ -0,0 +1,567 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Types.hpp"
+#include "Platform.hpp"
+#include "MemoryList.hpp"
+#include "Module.hpp"
+
+/// <summary>
+/// <para>A search written to a file: the list of candidate addresses and, if there are any, the previous values of the addresses, see ScanSession::Save.</para>
+/// <para>The file holds a header, the modules, a block table, the storage of the blocks the way MemoryList keeps it and the values in list order. A block inside a module starts at an offset from the module, so it moves with the module when the process is started again.</para>
+/// <para>The file is mapped as a whole. Loading copies only the address storage, which is small next to the values, and the values are read in place.</para>
+/// </summary>
+template<typename T>
+struct SessionFile {
+private:
+    /// <summary>An entry of the block table, written to the file as it is.</summary>
+    struct SessionBlock {
+    public:
+        SessionBlock(UInt64 const _start, UInt64 const _size, UInt64 const _first, UInt64 const _count, UInt64 const _addressCount, UInt32 const _module, UInt32 const _type) {
+            start = _start;
+            size = _size;
+            first = _first;
+            count = _count;
+            addressCount = _addressCount;
+            module = _module;
+            type = _type;
+        }
+
+        // Offset from the module, or the address itself if the block is in no module
+        UInt64 start;
+        // Bytes from start to the end of the last address
+        UInt64 size;
+        // Range in the storage of the block type, regions start at offsets from the block
+        UInt64 first;
+        UInt64 count;
+        UInt64 addressCount;
+        // Index of the module holding the first address, or NoModule
+        UInt32 module;
+        // MemoryBlockType
+        UInt32 type;
+    };
+
+    struct SessionSegment {
+    public:
+        SessionSegment(SizeT const _index, SizeT const _slot, SizeT const _count) {
+            index = _index;
+            slot = _slot;
+            count = _count;
+        }
+
+        // Index in the list of the first value
+        SizeT index;
+        // Index in the file of the first value
+        SizeT slot;
+        SizeT count;
+    };
+
+public:
+    /// <summary>
+    /// <para>Opens the session at path.</para>
+    /// <para>Possible exceptions:</para>
+    /// <para>(Int8)1: The file cannot be read or is not a session of this type and pointer size.</para>
+    /// </summary>
+    SessionFile(String const& path) {
+#if defined(_WIN32)
+        _file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        LARGE_INTEGER size;
+        if((_file == INVALID_HANDLE_VALUE) || (GetFileSizeEx(_file, &size) == FALSE) || (size.QuadPart == 0)) {
+            Close();
+            SetLastError(NULL);
+            throw (Int8)1;
+        }
+        _size = static_cast<SizeT>(size.QuadPart);
+
+        _mapping = CreateFileMappingA(_file, NULL, PAGE_READONLY, 0, 0, NULL);
+        _view = (_mapping != NULL) ? static_cast<UInt8 const*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+        SetLastError(NULL);
+#else
+        _file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat status;
+        if((_file < 0) || (fstat(_file, &status) != 0) || (status.st_size == 0)) {
+            Close();
+            throw (Int8)1;
+        }
+        _size = static_cast<SizeT>(status.st_size);
+
+        void* view = mmap(nullptr, _size, PROT_READ, MAP_SHARED, _file, 0);
+        _view = (view != MAP_FAILED) ? static_cast<UInt8 const*>(view) : nullptr;
+#endif
+
+        if(_view == nullptr) {
+            Close();
+            throw (Int8)1;
+        }
+
+        try {
+            Parse();
+        }
+        catch(Int8) {
+            Close();
+            throw;
+        }
+    }
+
+    SessionFile(SessionFile const&) = delete;
+    SessionFile& operator=(SessionFile const&) = delete;
+
+    ~SessionFile() {
+        Close();
+    }
+
+    /// <summary>
+    /// <para>Writes list and the previous values of its addresses to a session at path.</para>
+    /// <para>readValues: void(SizeT index, SizeT count, visitor), calls visitor(SizeT offset, T const* values, SizeT count) in order with the values from index on, like SnapshotStore::Read. Only called if hasValues.</para>
+    /// <para>The file is written next to path and moved over it once it is complete, so a crash while saving leaves the previous session as it was.</para>
+    /// <para>Possible exceptions:</para>
+    /// <para>(Int8)1: The file cannot be written.</para>
+    /// </summary>
+    /// <param name="modder">The memory modder of the process the list is from.</param>
+    template<typename Modder, typename ValueReader>
+    static void Save(Modder const& modder, String const& path, MemoryList<T> const& list, Boolean const hasValues, ValueReader&& readValues) {
+        String const temporaryPath = path + ".tmp";
+
+        try {
+            Write(modder, temporaryPath, list, hasValues, readValues);
+        }
+        catch(Int8) {
+            std::remove(temporaryPath.c_str());
+            throw (Int8)1;
+        }
+
+#if defined(_WIN32)
+        Boolean const moved = MoveFileExA(temporaryPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != FALSE;
+        SetLastError(NULL);
+#else
+        Boolean const moved = std::rename(temporaryPath.c_str(), path.c_str()) == 0;
+#endif
+        if(!moved) {
+            std::remove(temporaryPath.c_str());
+            throw (Int8)1;
+        }
+    }
+
+    inline SizeT GetStride() const noexcept {
+        return _stride;
+    }
+
+    /// <returns>True if the file holds a previous value for every address.</returns>
+    inline Boolean HasValues() const noexcept {
+        return _hasValues;
+    }
+
+    /// <returns>The id of the process the session was saved from.</returns>
+    inline SizeT GetProcessId() const noexcept {
+        return _processId;
+    }
+
+    inline String const& GetProcessName() const noexcept {
+        return _processName;
+    }
+
+    /// <summary>
+    /// <para>Builds the list of the session for a process with these modules, every block moved to where its module is now.</para>
+    /// <para>Blocks of a module the process does not have are dropped, and so are the blocks in no module unless the process is the one the session was saved from. Reads then skip the values of the dropped blocks.</para>
+    /// <para>The address storage is copied block by block, no address is visited on its own.</para>
+    /// <para>Possible exceptions:</para>
+    /// <para>(Int8)1: The block table does not match the storage.</para>
+    /// </summary>
+    MemoryList<T> CreateList(std::vector<Module> const& modules, SizeT const processId) {
+        // The base of every saved module in the process, found by name
+        std::vector<Module const*> moved = std::vector<Module const*>(_modules.size(), nullptr);
+        for(SizeT i = 0; i < _modules.size(); ++i) {
+            for(Module const& module : modules) {
+                if(module.GetName() == _modules[i].GetName()) {
+                    moved[i] = &module;
+                    break;
+                }
+            }
+        }
+
+        // New start and index of every block that is kept, and the first value of every block
+        std::vector<std::pair<SizeT, SizeT>> starts = std::vector<std::pair<SizeT, SizeT>>();
+        std::vector<SizeT> slots = std::vector<SizeT>(_blockCount, 0);
+        SizeT slot = 0;
+        for(SizeT i = 0; i < _blockCount; ++i) {
+            SessionBlock const& block = _blocks[i];
+            slots[i] = slot;
+            slot += static_cast<SizeT>(block.addressCount);
+
+            if(block.module == NoModule) {
+                if(processId == _processId) {
+                    starts.push_back(std::pair<SizeT, SizeT>(static_cast<SizeT>(block.start), i));
+                }
+            }
+            else if((moved[block.module] != nullptr) && (block.start < moved[block.module]->GetSize())) {
+                starts.push_back(std::pair<SizeT, SizeT>(moved[block.module]->GetBase() + static_cast<SizeT>(block.start), i));
+            }
+        }
+
+        // Modules may be in another order than before
+        std::sort(starts.begin(), starts.end());
+
+        MemoryList<T> list = MemoryList<T>(_stride);
+        _segments.clear();
+
+        SizeT end = 0;
+        for(std::pair<SizeT, SizeT> const& start : starts) {
+            SessionBlock const& block = _blocks[start.second];
+
+            // A block running past the end of its module may now run into the next one
+            if(start.first < end) {
+                continue;
+            }
+            end = start.first + static_cast<SizeT>(block.size);
+
+            SizeT const index = list.GetSize();
+            MemoryBlockType const type = static_cast<MemoryBlockType>(block.type);
+            SizeT const first = static_cast<SizeT>(block.first);
+            SizeT const count = static_cast<SizeT>(block.count);
+            if(type == MemoryBlockType::Regions) {
+                list.AddBlock(type, start.first, _regions + first, count, 0);
+            }
+            else if(type == MemoryBlockType::Bitmap) {
+                list.AddBlock(type, start.first, _bits + first, count, 0);
+            }
+            else {
+                list.AddBlock(type, start.first, _offsets + first, count, 0);
+            }
+
+            if((list.GetSize() - index) != block.addressCount) {
+                throw (Int8)1;
+            }
+
+            if((block.addressCount != 0) && !_segments.empty() && ((_segments.back().slot + _segments.back().count) == slots[start.second])) {
+                _segments.back().count += static_cast<SizeT>(block.addressCount);
+            }
+            else if(block.addressCount != 0) {
+                _segments.push_back(SessionSegment(index, slots[start.second], static_cast<SizeT>(block.addressCount)));
+            }
+        }
+
+        return list;
+    }
+
+    /// <summary>
+    /// <para>Reads count values from index on in the order of the list from the last CreateList.</para>
+    /// <para>visitor: void(SizeT offset, T const* values, SizeT count), called in order with values that are contiguous in memory, offset counts from index.</para>
+    /// </summary>
+    template<typename Visitor>
+    void Read(SizeT const index, SizeT const count, Visitor&& visitor) const {
+        // Find the last segment starting at or before index
+        SizeT low = 0;
+        SizeT high = _segments.size();
+        while((high - low) > 1) {
+            SizeT const middle = (low + high) / 2;
+            if(_segments[middle].index <= index) {
+                low = middle;
+            }
+            else {
+                high = middle;
+            }
+        }
+
+        for(SizeT segment = low, offset = 0; (offset < count) && (segment < _segments.size()); ++segment) {
+            SessionSegment const& sessionSegment = _segments[segment];
+            SizeT const segmentEnd = sessionSegment.index + sessionSegment.count;
+
+            if((index + offset) < segmentEnd) {
+                SizeT const valueCount = min(segmentEnd - (index + offset), count - offset);
+                visitor(offset, _values + sessionSegment.slot + (index + offset - sessionSegment.index), valueCount);
+                offset += valueCount;
+            }
+        }
+    }
+
+private:
+    static constexpr UInt32 FileMagic = 0x534D4D4D;
+    static constexpr UInt32 FileVersion = 1;
+
+    // Values start on a page boundary, so they stay aligned in the mapped file
+    static constexpr SizeT PageSize = 0x1000;
+    static constexpr UInt32 NoModule = ~static_cast<UInt32>(0);
+
+    template<typename Modder, typename ValueReader>
+    static void Write(Modder const& modder, String const& path, MemoryList<T> const& list, Boolean const hasValues, ValueReader& readValues) {
+        std::ofstream file = std::ofstream(path, std::ios_base::binary | std::ios_base::trunc);
+
+        std::vector<Module> const modules = modder.GetModules();
+
+        std::vector<SessionBlock> blocks = std::vector<SessionBlock>();
+        std::vector<MemoryRegion<T>> regions = std::vector<MemoryRegion<T>>();
+        std::vector<UInt64> bits = std::vector<UInt64>();
+        std::vector<UInt16> offsets = std::vector<UInt16>();
+
+        SizeT const stride = list.GetStride();
+        list.ForEachBlock([&](MemoryBlockType const type, SizeT const start, void const* storage, SizeT const count) {
+            UInt64 first = 0;
+            SizeT size = 0;
+            SizeT addressCount = 0;
+
+            if(type == MemoryBlockType::Regions) {
+                MemoryRegion<T> const* blockRegions = static_cast<MemoryRegion<T> const*>(storage);
+
+                first = regions.size();
+                for(SizeT i = 0; i < count; ++i) {
+                    regions.push_back(MemoryRegion<T>(blockRegions[i].GetStart() - start, blockRegions[i].GetSize()));
+                    addressCount += blockRegions[i].GetSize() / stride;
+                }
+                size = blockRegions[count - 1].GetEnd() - start;
+            }
+            else if(type == MemoryBlockType::Bitmap) {
+                UInt64 const* blockBits = static_cast<UInt64 const*>(storage);
+
+                first = bits.size();
+                bits.insert(bits.end(), blockBits, blockBits + count);
+                for(SizeT i = 0; i < count; ++i) {
+                    addressCount += static_cast<SizeT>(std::popcount(blockBits[i]));
+                    if(blockBits[i] != 0) {
+                        size = ((i * 64) + (64 - static_cast<SizeT>(std::countl_zero(blockBits[i])))) * stride;
+                    }
+                }
+            }
+            else {
+                UInt16 const* blockOffsets = static_cast<UInt16 const*>(storage);
+
+                first = offsets.size();
+                offsets.insert(offsets.end(), blockOffsets, blockOffsets + count);
+                addressCount = count;
+                size = (static_cast<SizeT>(blockOffsets[count - 1]) + 1) * stride;
+            }
+
+            UInt32 module = NoModule;
+            for(SizeT i = 0; i < modules.size(); ++i) {
+                if(modules[i].IsInside(start)) {
+                    module = static_cast<UInt32>(i);
+                    break;
+                }
+            }
+
+            UInt64 const blockStart = (module == NoModule) ? start : (start - modules[module].GetBase());
+            blocks.push_back(SessionBlock(blockStart, size, first, count, addressCount, module, static_cast<UInt32>(type)));
+        });
+
+        WriteValue<UInt32>(file, FileMagic);
+        WriteValue<UInt32>(file, FileVersion);
+        WriteValue<UInt32>(file, static_cast<UInt32>(sizeof(SizeT)));
+        WriteValue<UInt32>(file, static_cast<UInt32>(sizeof(T)));
+        WriteString(file, GetTypeName<T>());
+        WriteValue<UInt64>(file, stride);
+        WriteValue<UInt64>(file, hasValues ? 1 : 0);
+        WriteValue<UInt64>(file, modder.GetProcessId());
+        WriteString(file, modder.GetProcessName());
+
+        WriteValue<UInt64>(file, modules.size());
+        for(Module const& module : modules) {
+            WriteString(file, module.GetName());
+            WriteValue<UInt64>(file, module.GetBase());
+            WriteValue<UInt64>(file, module.GetSize());
+        }
+
+        WriteArray(file, blocks.data(), blocks.size(), sizeof(UInt64));
+        WriteArray(file, regions.data(), regions.size(), sizeof(UInt64));
+        WriteArray(file, bits.data(), bits.size(), sizeof(UInt64));
+        WriteArray(file, offsets.data(), offsets.size(), sizeof(UInt64));
+
+        SizeT const valueCount = hasValues ? list.GetSize() : 0;
+        WriteValue<UInt64>(file, valueCount);
+        Pad(file, PageSize);
+        if(valueCount != 0) {
+            readValues(0, valueCount, [&file](SizeT const, T const* values, SizeT const count) {
+                file.write(reinterpret_cast<char const*>(values), static_cast<std::streamsize>(count * sizeof(T)));
+            });
+        }
+
+        file.close();
+        if(!file) {
+            throw (Int8)1;
+        }
+    }
+
+    /// <summary>Reads the header and tables, and checks that every block points into the storage.</summary>
+    void Parse() {
+        SizeT offset = 0;
+
+        UInt32 const magic = TakeValue<UInt32>(offset);
+        UInt32 const version = TakeValue<UInt32>(offset);
+        UInt32 const pointerSize = TakeValue<UInt32>(offset);
+        UInt32 const valueSize = TakeValue<UInt32>(offset);
+        if((magic != FileMagic) || (version != FileVersion) || (pointerSize != sizeof(SizeT)) || (valueSize != sizeof(T)) || (TakeString(offset) != GetTypeName<T>())) {
+            throw (Int8)1;
+        }
+
+        _stride = static_cast<SizeT>(TakeValue<UInt64>(offset));
+        _hasValues = TakeValue<UInt64>(offset) != 0;
+        _processId = static_cast<SizeT>(TakeValue<UInt64>(offset));
+        _processName = TakeString(offset);
+        if(_stride == 0) {
+            throw (Int8)1;
+        }
+
+        UInt64 const moduleCount = TakeValue<UInt64>(offset);
+        for(UInt64 i = 0; i < moduleCount; ++i) {
+            String const name = TakeString(offset);
+            SizeT const base = static_cast<SizeT>(TakeValue<UInt64>(offset));
+            SizeT const size = static_cast<SizeT>(TakeValue<UInt64>(offset));
+            _modules.push_back(Module(name, base, size));
+        }
+
+        SizeT regionCount = 0;
+        SizeT bitCount = 0;
+        SizeT offsetCount = 0;
+        SizeT valueCount = 0;
+        _blocks = TakeArray<SessionBlock>(offset, sizeof(UInt64), _blockCount);
+        _regions = TakeArray<MemoryRegion<T>>(offset, sizeof(UInt64), regionCount);
+        _bits = TakeArray<UInt64>(offset, sizeof(UInt64), bitCount);
+        _offsets = TakeArray<UInt16>(offset, sizeof(UInt64), offsetCount);
+        _values = TakeArray<T>(offset, PageSize, valueCount);
+
+        UInt64 addressCount = 0;
+        for(SizeT i = 0; i < _blockCount; ++i) {
+            SessionBlock const& block = _blocks[i];
+
+            UInt64 const storageCount = (block.type == static_cast<UInt32>(MemoryBlockType::Regions)) ? regionCount
+                : (block.type == static_cast<UInt32>(MemoryBlockType::Bitmap)) ? bitCount
+                : (block.type == static_cast<UInt32>(MemoryBlockType::Offsets)) ? offsetCount : 0;
+            if((block.first > storageCount) || (block.count > (storageCount - block.first)) || ((block.module != NoModule) && (block.module >= _modules.size()))) {
+                throw (Int8)1;
+            }
+            addressCount += block.addressCount;
+        }
+
+        if(_hasValues && (addressCount != valueCount)) {
+            throw (Int8)1;
+        }
+    }
+
+    /// <returns>The size bytes at offset, which is moved past them.</returns>
+    inline UInt8 const* Take(SizeT& offset, SizeT const size) const {
+        if((offset > _size) || (size > (_size - offset))) {
+            throw (Int8)1;
+        }
+        UInt8 const* data = _view + offset;
+        offset += size;
+        return data;
+    }
+
+    template<typename V>
+    inline V TakeValue(SizeT& offset) const {
+        V value;
+        memcpy(&value, Take(offset, sizeof(V)), sizeof(V));
+        return value;
+    }
+
+    inline String TakeString(SizeT& offset) const {
+        UInt64 const length = TakeValue<UInt64>(offset);
+        if(length > (_size - offset)) {
+            throw (Int8)1;
+        }
+        return String(reinterpret_cast<char const*>(Take(offset, static_cast<SizeT>(length))), static_cast<SizeT>(length));
+    }
+
+    /// <returns>The elements of an array written by WriteArray, used in place.</returns>
+    template<typename V>
+    inline V const* TakeArray(SizeT& offset, SizeT const alignment, SizeT& count) const {
+        UInt64 const length = TakeValue<UInt64>(offset);
+        Take(offset, (alignment - (offset % alignment)) % alignment);
+        if(length > ((_size - offset) / sizeof(V))) {
+            throw (Int8)1;
+        }
+        count = static_cast<SizeT>(length);
+        return reinterpret_cast<V const*>(Take(offset, count * sizeof(V)));
+    }
+
+    template<typename V>
+    static inline void WriteValue(std::ofstream& file, V const value) {
+        file.write(reinterpret_cast<char const*>(&value), sizeof(V));
+    }
+
+    static inline void WriteString(std::ofstream& file, String const& string) {
+        WriteValue<UInt64>(file, string.length());
+        file.write(string.data(), static_cast<std::streamsize>(string.length()));
+    }
+
+    /// <summary>Writes the count and, from the next multiple of alignment on, the elements.</summary>
+    template<typename V>
+    static inline void WriteArray(std::ofstream& file, V const* elements, SizeT const count, SizeT const alignment) {
+        WriteValue<UInt64>(file, count);
+        Pad(file, alignment);
+        file.write(reinterpret_cast<char const*>(elements), static_cast<std::streamsize>(count * sizeof(V)));
+    }
+
+    /// <summary>Writes zeros up to the next multiple of alignment.</summary>
+    static void Pad(std::ofstream& file, SizeT const alignment) {
+        SizeT const position = static_cast<SizeT>(file.tellp());
+        SizeT const padding = (alignment - (position % alignment)) % alignment;
+        for(SizeT i = 0; i < padding; ++i) {
+            file.put('\0');
+        }
+    }
+
+    void Close() {
+#if defined(_WIN32)
+        if(_view != nullptr) {
+            UnmapViewOfFile(_view);
+        }
+        if(_mapping != NULL) {
+            CloseHandle(_mapping);
+        }
+        if(_file != INVALID_HANDLE_VALUE) {
+            CloseHandle(_file);
+        }
+        _mapping = NULL;
+        _file = INVALID_HANDLE_VALUE;
+#else
+        if(_view != nullptr) {
+            munmap(const_cast<UInt8*>(_view), _size);
+        }
+        if(_file >= 0) {
+            close(_file);
+        }
+        _file = -1;
+#endif
+        _view = nullptr;
+    }
+
+#if defined(_WIN32)
+    HANDLE _file = INVALID_HANDLE_VALUE;
+    HANDLE _mapping = NULL;
+#else
+    int _file = -1;
+#endif
+    UInt8 const* _view = nullptr;
+    SizeT _size = 0;
+
+    SizeT _stride = 0;
+    Boolean _hasValues = false;
+    SizeT _processId = 0;
+    String _processName = String();
+    std::vector<Module> _modules = std::vector<Module>();
+
+    // Tables and storage in the mapped file
+    SessionBlock const* _blocks = nullptr;
+    SizeT _blockCount = 0;
+    MemoryRegion<T> const* _regions = nullptr;
+    UInt64 const* _bits = nullptr;
+    UInt16 const* _offsets = nullptr;
+    T const* _values = nullptr;
+
+    std::vector<SessionSegment> _segments = std::vector<SessionSegment>();
+};
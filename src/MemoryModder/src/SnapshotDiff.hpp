@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+
+#include "Types.hpp"
+#include "MemoryList.hpp"
+
+/// <summary>The number of bytes that changed in one region, see Diff.</summary>
+struct RegionChange {
+public:
+    RegionChange(SizeT const _start, SizeT const _size, SizeT const _changedBytes) {
+        start = _start;
+        size = _size;
+        changedBytes = _changedBytes;
+    }
+
+    SizeT start;
+    SizeT size;
+    SizeT changedBytes;
+};
+
+/// <summary>The number of bytes that changed in the regions of one module, see Diff.</summary>
+struct ModuleChange {
+public:
+    ModuleChange(String const& _module, SizeT const _changedBytes) {
+        module = _module;
+        changedBytes = _changedBytes;
+    }
+
+    String module;
+    SizeT changedBytes;
+};
+
+/// <summary>The values that changed between two snapshots of the same process, see Diff.</summary>
+template<typename T>
+struct SnapshotDiff {
+public:
+    SnapshotDiff(SizeT const stride) : changes(stride) {
+    }
+
+    /// <summary>Addresses of the values with any byte that changed.</summary>
+    MemoryList<T> changes;
+
+    /// <summary>Every region compared, ascending, with the bytes that changed inside.</summary>
+    std::vector<RegionChange> regions = std::vector<RegionChange>();
+    /// <summary>Every module of the process, with the bytes that changed in the regions starting inside.</summary>
+    std::vector<ModuleChange> modules = std::vector<ModuleChange>();
+
+    SizeT changedBytes = 0;
+    /// <summary>Bytes that were in both snapshots and could be read from both.</summary>
+    SizeT comparedBytes = 0;
+};
@@ -0,0 +1,329 @@
+#pragma once
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "Types.hpp"
+#include "Platform.hpp"
+
+/// <summary>
+/// <para>Values of a list of addresses in list order, spilled to a temporary memory mapped file instead of kept in memory.</para>
+/// <para>Values are written into slots of the file and joined into the list order by segments, so parallel writers never need to know where the others end.</para>
+/// <para>Only one window per cursor is mapped at a time, so the memory used stays bounded no matter how large the store is.</para>
+/// </summary>
+template<typename T>
+struct SnapshotStore {
+private:
+    struct SnapshotSegment {
+    public:
+        SnapshotSegment(SizeT const _index, SizeT const _slot, SizeT const _count) {
+            index = _index;
+            slot = _slot;
+            count = _count;
+        }
+
+        // Index in the list of the first value
+        SizeT index;
+        // Slot in the file of the first value
+        SizeT slot;
+        SizeT count;
+    };
+
+public:
+    /// <summary>A mapped window into the store, every thread needs its own cursor.</summary>
+    struct Cursor {
+    public:
+        Cursor(SnapshotStore<T>& store) : _store(store) {
+        }
+
+        Cursor(Cursor&& other) noexcept : _store(other._store) {
+            _view = other._view;
+            _viewStart = other._viewStart;
+            _viewEnd = other._viewEnd;
+            other._view = nullptr;
+        }
+
+        Cursor(Cursor const&) = delete;
+        Cursor& operator=(Cursor const&) = delete;
+
+        ~Cursor() {
+            Release();
+        }
+
+        /// <summary>Unmaps the window, the store may only be reset once every cursor is released.</summary>
+        inline void Release() {
+            if(_view != nullptr) {
+#if defined(_WIN32)
+                UnmapViewOfFile(_view);
+#else
+                munmap(_view, _viewEnd - _viewStart);
+#endif
+                _view = nullptr;
+            }
+        }
+
+        /// <summary>
+        /// <para>Maps the window holding the byte at offset. Reading windows are prefetched, because they are read from start to end.</para>
+        /// <para>Possible exceptions:</para>
+        /// <para>(Int8)3: The window cannot be mapped.</para>
+        /// </summary>
+        /// <returns>The byte at offset, the window holds the bytes up to GetWindowEnd.</returns>
+        UInt8* Map(SizeT const offset, Boolean const prefetch) {
+            if((_view != nullptr) && (offset >= _viewStart) && (offset < _viewEnd)) {
+                return static_cast<UInt8*>(_view) + (offset - _viewStart);
+            }
+
+            Release();
+
+            _viewStart = offset - (offset % _store._granularity);
+            _viewEnd = min(_viewStart + _store._windowSize, _store._capacity * sizeof(T));
+
+#if defined(_WIN32)
+            UInt64 const start = static_cast<UInt64>(_viewStart);
+            _view = MapViewOfFile(_store._mapping, FILE_MAP_READ | FILE_MAP_WRITE, static_cast<DWORD>(start >> 32), static_cast<DWORD>(start), _viewEnd - _viewStart);
+            if(_view == nullptr) {
+                SetLastError(NULL);
+                throw (Int8)3;
+            }
+
+            if(prefetch) {
+                // Read ahead the whole window with a few large reads instead of faulting in page by page
+                WIN32_MEMORY_RANGE_ENTRY entry;
+                entry.VirtualAddress = _view;
+                entry.NumberOfBytes = _viewEnd - _viewStart;
+                PrefetchVirtualMemory(GetCurrentProcess(), 1, &entry, 0);
+            }
+#else
+            _view = mmap(nullptr, _viewEnd - _viewStart, PROT_READ | PROT_WRITE, MAP_SHARED, _store._file, static_cast<off_t>(_viewStart));
+            if(_view == MAP_FAILED) {
+                _view = nullptr;
+                throw (Int8)3;
+            }
+
+            if(prefetch) {
+                madvise(_view, _viewEnd - _viewStart, MADV_WILLNEED);
+            }
+#endif
+
+            return static_cast<UInt8*>(_view) + (offset - _viewStart);
+        }
+
+        inline SizeT GetWindowEnd() const noexcept {
+            return _viewEnd;
+        }
+
+    private:
+        SnapshotStore<T>& _store;
+        void* _view = nullptr;
+        SizeT _viewStart = 0;
+        SizeT _viewEnd = 0;
+    };
+
+    /// <summary>
+    /// <para>Creates an empty store in a new temporary file, which is deleted when the store is destroyed.</para>
+    /// <para>Possible exceptions:</para>
+    /// <para>(Int8)1: The file cannot be created.</para>
+    /// </summary>
+    /// <param name="directory">Directory of the file, empty uses the temporary directory.</param>
+    /// <param name="windowSize">Bytes mapped by every cursor, rounded to the allocation granularity.</param>
+    /// <param name="elideZeroPages">If true, zero values are never written, so pages of zeros are never touched and take no memory.</param>
+    SnapshotStore(String const& directory, SizeT const windowSize, Boolean const elideZeroPages = true) {
+#if defined(_WIN32)
+        char path[MAX_PATH];
+        char tempDirectory[MAX_PATH];
+        if(directory.empty()) {
+            GetTempPathA(MAX_PATH, tempDirectory);
+        }
+        if(GetTempFileNameA(directory.empty() ? tempDirectory : directory.c_str(), "mms", 0, path) == 0) {
+            SetLastError(NULL);
+            throw (Int8)1;
+        }
+
+        _file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if(_file == INVALID_HANDLE_VALUE) {
+            DeleteFileA(path);
+            SetLastError(NULL);
+            throw (Int8)1;
+        }
+
+        SYSTEM_INFO systemInfo;
+        GetSystemInfo(&systemInfo);
+        _granularity = static_cast<SizeT>(systemInfo.dwAllocationGranularity);
+
+        SetLastError(NULL);
+#else
+        char const* tempDirectory = getenv("TMPDIR");
+        String path = directory.empty() ? String(((tempDirectory != nullptr) && (*tempDirectory != '\0')) ? tempDirectory : "/tmp") : directory;
+        path += "/mmsXXXXXX";
+
+        _file = mkostemp(path.data(), O_CLOEXEC);
+        if(_file < 0) {
+            throw (Int8)1;
+        }
+        // The file is gone once it is closed
+        unlink(path.c_str());
+
+        _granularity = static_cast<SizeT>(sysconf(_SC_PAGESIZE));
+#endif
+
+        _windowSize = max((windowSize / _granularity) * _granularity, _granularity);
+        _elideZeroPages = elideZeroPages;
+    }
+
+    SnapshotStore(SnapshotStore const&) = delete;
+    SnapshotStore& operator=(SnapshotStore const&) = delete;
+
+    ~SnapshotStore() {
+#if defined(_WIN32)
+        if(_mapping != NULL) {
+            CloseHandle(_mapping);
+        }
+        CloseHandle(_file);
+#else
+        close(_file);
+#endif
+    }
+
+    /// <returns>The number of values in the store.</returns>
+    inline SizeT GetCount() const noexcept {
+        return _count;
+    }
+
+    /// <summary>
+    /// <para>Removes all values and makes room for capacity value slots. Every cursor MUST be released.</para>
+    /// <para>The disk space is taken here, so a full disk is reported now and not as a fault when a mapped window is written.</para>
+    /// <para>Possible exceptions:</para>
+    /// <para>(Int8)2: The file cannot grow, e.g. the disk is full.</para>
+    /// </summary>
+    void Reset(SizeT const capacity) {
+        _segments.clear();
+        _count = 0;
+        _capacity = 0;
+
+#if defined(_WIN32)
+        if(_mapping != NULL) {
+            CloseHandle(_mapping);
+            _mapping = NULL;
+        }
+
+        // Truncating drops the old values, growing again leaves the file zeroed. The file is not sparse, so growing it takes the disk space
+        LARGE_INTEGER size;
+        size.QuadPart = 0;
+        Boolean success = (SetFilePointerEx(_file, size, NULL, FILE_BEGIN) != FALSE) && (SetEndOfFile(_file) != FALSE);
+
+        size.QuadPart = static_cast<LONGLONG>(capacity * sizeof(T));
+        success = success && (SetFilePointerEx(_file, size, NULL, FILE_BEGIN) != FALSE) && (SetEndOfFile(_file) != FALSE);
+
+        if(success && (capacity != 0)) {
+            _mapping = CreateFileMappingA(_file, NULL, PAGE_READWRITE, 0, 0, NULL);
+            success = _mapping != NULL;
+        }
+
+        SetLastError(NULL);
+#else
+        // Truncating drops the old values, growing with ftruncate alone would leave a sparse file
+        Boolean success = ftruncate(_file, 0) == 0;
+        if(success && (capacity != 0)) {
+            success = posix_fallocate(_file, 0, static_cast<off_t>(capacity * sizeof(T))) == 0;
+        }
+#endif
+
+        if(!success) {
+            throw (Int8)2;
+        }
+
+        _capacity = capacity;
+    }
+
+    /// <summary>
+    /// <para>Writes value into slot. Slots only become values of the list once a segment is added for them.</para>
+    /// <para>Possible exceptions:</para>
+    /// <para>(Int8)3: The window cannot be mapped.</para>
+    /// </summary>
+    inline void Write(Cursor& cursor, SizeT const slot, T const value) {
+        if(_elideZeroPages && IsZero(value)) {
+            return;
+        }
+
+        memcpy(cursor.Map(slot * sizeof(T), false), &value, sizeof(T));
+    }
+
+    /// <summary>Adds count values from slot on to the end of the list order. Segments MUST be added after all writes to their slots.</summary>
+    inline void AddSegment(SizeT const slot, SizeT const count) {
+        if(count != 0) {
+            _segments.push_back(SnapshotSegment(_count, slot, count));
+            _count += count;
+        }
+    }
+
+    /// <summary>
+    /// <para>Reads count values from index on in list order.</para>
+    /// <para>visitor: void(SizeT offset, T const* values, SizeT count), called in order with values that are contiguous in memory, offset counts from index.</para>
+    /// <para>Possible exceptions:</para>
+    /// <para>(Int8)3: A window cannot be mapped.</para>
+    /// </summary>
+    template<typename Visitor>
+    void Read(Cursor& cursor, SizeT const index, SizeT const count, Visitor&& visitor) {
+        // Find the last segment starting at or before index
+        SizeT low = 0;
+        SizeT high = _segments.size();
+        while((high - low) > 1) {
+            SizeT const middle = (low + high) / 2;
+            if(_segments[middle].index <= index) {
+                low = middle;
+            }
+            else {
+                high = middle;
+            }
+        }
+
+        for(SizeT segment = low, offset = 0; (offset < count) && (segment < _segments.size()); ++segment) {
+            SnapshotSegment const& snapshotSegment = _segments[segment];
+            SizeT const segmentEnd = snapshotSegment.index + snapshotSegment.count;
+
+            while(((index + offset) < segmentEnd) && (offset < count)) {
+                SizeT const byteOffset = (snapshotSegment.slot + (index + offset - snapshotSegment.index)) * sizeof(T);
+                T const* values = reinterpret_cast<T const*>(cursor.Map(byteOffset, true));
+
+                SizeT const valueCount = min(min(segmentEnd - (index + offset), count - offset), (cursor.GetWindowEnd() - byteOffset) / sizeof(T));
+                visitor(offset, values, valueCount);
+                offset += valueCount;
+            }
+        }
+    }
+
+private:
+    static inline Boolean IsZero(T const value) {
+        UInt8 bytes[sizeof(T)];
+        memcpy(bytes, &value, sizeof(T));
+        for(SizeT i = 0; i < sizeof(T); ++i) {
+            if(bytes[i] != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+#if defined(_WIN32)
+    HANDLE _file = INVALID_HANDLE_VALUE;
+    HANDLE _mapping = NULL;
+#else
+    int _file = -1;
+#endif
+    SizeT _granularity = 0x10000;
+    SizeT _windowSize = 0x10000;
+    Boolean _elideZeroPages = true;
+
+    SizeT _capacity = 0;
+    SizeT _count = 0;
+    std::vector<SnapshotSegment> _segments = std::vector<SnapshotSegment>();
+};
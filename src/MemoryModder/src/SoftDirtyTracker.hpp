@@ -0,0 +1,153 @@
+#pragma once
+
+#if defined(__linux__)
+
+#include <cstdio>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "Types.hpp"
+#include "Platform.hpp"
+#include "DirtyPages.hpp"
+#include "MemoryList.hpp"
+
+/// <summary>
+/// <para>Finds the pages a Linux process wrote to with the soft-dirty bits of <code>/proc/&lt;pid&gt;/pagemap</code>, which are cleared by writing 4 to <code>/proc/&lt;pid&gt;/clear_refs</code>.</para>
+/// <para>Needs a kernel built with CONFIG_MEM_SOFT_DIRTY and the same access as reading the memory of the process.</para>
+/// </summary>
+struct SoftDirtyTracker {
+public:
+    SoftDirtyTracker(SizeT const processId) {
+        _processId = processId;
+    }
+
+    /// <returns>True if the kernel keeps soft-dirty bits.</returns>
+    static Boolean IsSupported() {
+        // Pages start out soft-dirty and this process never clears its own bits, so a page it just wrote has the bit unless the kernel has none
+        static Boolean const supported = []() {
+            volatile UInt8 page[1] = { 1 };
+            UInt64 entry = 0;
+
+            int const file = open("/proc/self/pagemap", O_RDONLY | O_CLOEXEC);
+            if(file < 0) {
+                return false;
+            }
+            Boolean const read = ReadEntries(file, reinterpret_cast<SizeT>(page) / GetPageSize(), 1, &entry);
+            close(file);
+
+            return read && ((entry & softDirtyBit) != 0);
+        }();
+        return supported;
+    }
+
+    /// <summary>Clears the soft-dirty bits of every page of the process, pages written afterwards are dirty again.</summary>
+    /// <returns>False if the bits could not be cleared.</returns>
+    Boolean Clear() const {
+        if(!IsSupported()) {
+            return false;
+        }
+
+        int const file = open(GetPath("clear_refs").c_str(), O_WRONLY | O_CLOEXEC);
+        if(file < 0) {
+            return false;
+        }
+
+        Boolean const cleared = write(file, "4", 1) == 1;
+        close(file);
+        return cleared;
+    }
+
+    /// <summary>
+    /// <para>Fills dirtyPages with the dirty pages holding the addresses of the list and the tail bytes past every region.</para>
+    /// <para>Pages that are not in memory count as dirty, they may have been unmapped.</para>
+    /// </summary>
+    /// <returns>False if the bits could not be read.</returns>
+    template<typename T>
+    Boolean Read(MemoryList<T> const& memoryList, SizeT const tail, DirtyPages& dirtyPages) const {
+        dirtyPages.Clear();
+        if(!IsSupported()) {
+            return false;
+        }
+
+        int const file = open(GetPath("pagemap").c_str(), O_RDONLY | O_CLOEXEC);
+        if(file < 0) {
+            return false;
+        }
+
+        SizeT const pageSize = GetPageSize();
+        Boolean read = true;
+
+        // Neighbouring regions share pages, so the pages of the list are joined into runs first
+        SizeT runStart = 0;
+        SizeT runEnd = 0;
+        for(typename MemoryList<T>::Iterator it = memoryList.begin(), e = memoryList.end(); read && (it != e); ++it) {
+            MemoryRegion<T> const& region = *it;
+            SizeT const start = region.GetStart() / pageSize;
+            SizeT const end = (region.GetEnd() + tail + pageSize - 1) / pageSize;
+
+            if((runEnd != 0) && (start <= runEnd)) {
+                runEnd = max(runEnd, end);
+                continue;
+            }
+            if(runEnd != 0) {
+                read = ReadRun(file, runStart, runEnd, dirtyPages);
+            }
+            runStart = start;
+            runEnd = end;
+        }
+
+        read = read && ((runEnd == 0) || ReadRun(file, runStart, runEnd, dirtyPages));
+        close(file);
+        return read;
+    }
+
+private:
+    static constexpr UInt64 softDirtyBit = static_cast<UInt64>(1) << 55;
+    static constexpr UInt64 swappedBit = static_cast<UInt64>(1) << 62;
+    static constexpr UInt64 presentBit = static_cast<UInt64>(1) << 63;
+
+    static inline SizeT GetPageSize() {
+        return static_cast<SizeT>(sysconf(_SC_PAGESIZE));
+    }
+
+    String GetPath(char const* file) const {
+        char path[64];
+        snprintf(path, sizeof(path), "/proc/%zu/%s", _processId, file);
+        return String(path);
+    }
+
+    /// <summary>Reads the pagemap entries of count pages from page on.</summary>
+    static inline Boolean ReadEntries(int const file, SizeT const page, SizeT const count, UInt64* entries) {
+        SizeT const size = count * sizeof(UInt64);
+        return pread(file, entries, size, static_cast<off_t>(page * sizeof(UInt64))) == static_cast<ssize_t>(size);
+    }
+
+    static Boolean ReadRun(int const file, SizeT const start, SizeT const end, DirtyPages& dirtyPages) {
+        SizeT const pageSize = GetPageSize();
+
+        // 4096 entries per call cover 16 MiB of 4 KiB pages
+        constexpr SizeT batchSize = 0x1000;
+        UInt64 entries[batchSize];
+        for(SizeT batch = start; batch < end; batch += batchSize) {
+            SizeT const count = min(batchSize, end - batch);
+            if(!ReadEntries(file, batch, count, entries)) {
+                return false;
+            }
+
+            for(SizeT i = 0; i < count; ++i) {
+                UInt64 const entry = entries[i];
+                if(((entry & softDirtyBit) != 0) || ((entry & (presentBit | swappedBit)) == 0)) {
+                    dirtyPages.AddRange((batch + i) * pageSize, (batch + i + 1) * pageSize);
+                }
+            }
+        }
+
+        return true;
+    }
+
+    SizeT _processId;
+};
+
+#endif
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Types.hpp"
+#include "Platform.hpp"
 #include <locale>
 
 constexpr String StringRepeat(String const& string, SizeT count) {
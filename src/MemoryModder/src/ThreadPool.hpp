@@ -0,0 +1,155 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Types.hpp"
+#include "Platform.hpp"
+
+/// <summary>
+/// <para>A fixed set of worker threads that are started once and reused for every parallel loop.</para>
+/// <para>Indices are handed out one at a time, so a worker that finishes early simply takes the next one.</para>
+/// </summary>
+struct ThreadPool {
+public:
+    /// <param name="threadCount">Number of threads including the calling thread, 0 uses one per hardware thread.</param>
+    ThreadPool(SizeT const threadCount = 0) {
+        SizeT const hardwareCount = static_cast<SizeT>(std::thread::hardware_concurrency());
+        _workerCount = (threadCount != 0) ? threadCount : max(hardwareCount, static_cast<SizeT>(1));
+    }
+
+    ThreadPool(ThreadPool const&) = delete;
+    ThreadPool& operator=(ThreadPool const&) = delete;
+
+    ~ThreadPool() {
+        {
+            std::unique_lock<std::mutex> lock = std::unique_lock<std::mutex>(_mutex);
+            _stop = true;
+        }
+        _wake.notify_all();
+
+        for(std::thread& thread : _threads) {
+            thread.join();
+        }
+    }
+
+    /// <returns>The number of workers, worker indices passed to functions are below this number.</returns>
+    inline SizeT GetWorkerCount() const noexcept {
+        return _workerCount;
+    }
+
+    /// <summary>
+    /// <para>Calls function(index, worker) for every index from 0 to count on all workers and returns when all calls are done.</para>
+    /// <para>The calling thread works along as worker 0. Threads are started on first use.</para>
+    /// <para>If a call throws, no further indices are handed out and the first exception is rethrown on the calling thread once every worker stopped.</para>
+    /// <para>Not reentrant, function must not call ParallelFor on the same pool.</para>
+    /// </summary>
+    template<typename Function>
+    void ParallelFor(SizeT const count, Function&& function) {
+        if((count <= 1) || (_workerCount <= 1)) {
+            for(SizeT i = 0; i < count; ++i) {
+                function(i, 0);
+            }
+            return;
+        }
+
+        if(_threads.empty()) {
+            for(SizeT worker = 1; worker < _workerCount; ++worker) {
+                _threads.push_back(std::thread(&ThreadPool::Work, this, worker));
+            }
+        }
+
+        {
+            std::unique_lock<std::mutex> lock = std::unique_lock<std::mutex>(_mutex);
+            _job = [&function](SizeT const index, SizeT const worker) {
+                function(index, worker);
+            };
+            _count = count;
+            _next.store(0);
+            _active = _threads.size();
+            _error = nullptr;
+            ++_generation;
+        }
+        _wake.notify_all();
+
+        RunJob(0);
+
+        std::unique_lock<std::mutex> lock = std::unique_lock<std::mutex>(_mutex);
+        _done.wait(lock, [this]() {
+            return _active == 0;
+        });
+        _job = nullptr;
+
+        if(_error != nullptr) {
+            std::exception_ptr const error = _error;
+            _error = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+
+private:
+    void Work(SizeT const worker) {
+        SizeT generation = 0;
+
+        while(true) {
+            {
+                std::unique_lock<std::mutex> lock = std::unique_lock<std::mutex>(_mutex);
+                _wake.wait(lock, [this, generation]() {
+                    return _stop || (_generation != generation);
+                });
+
+                if(_stop) {
+                    return;
+                }
+
+                generation = _generation;
+            }
+
+            RunJob(worker);
+
+            {
+                std::unique_lock<std::mutex> lock = std::unique_lock<std::mutex>(_mutex);
+                --_active;
+            }
+            _done.notify_one();
+        }
+    }
+
+    void RunJob(SizeT const worker) {
+        try {
+            for(SizeT index = _next.fetch_add(1); index < _count; index = _next.fetch_add(1)) {
+                _job(index, worker);
+            }
+        }
+        catch(...) {
+            // The other workers finish their current index and take no new one
+            _next.store(_count);
+
+            std::unique_lock<std::mutex> lock = std::unique_lock<std::mutex>(_mutex);
+            if(_error == nullptr) {
+                _error = std::current_exception();
+            }
+        }
+    }
+
+    SizeT _workerCount;
+    std::vector<std::thread> _threads = std::vector<std::thread>();
+
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::condition_variable _done;
+    Boolean _stop = false;
+    SizeT _generation = 0;
+    SizeT _active = 0;
+
+    std::function<void(SizeT, SizeT)> _job;
+    SizeT _count = 0;
+    std::atomic<SizeT> _next = 0;
+    // First exception of the current job, rethrown by ParallelFor
+    std::exception_ptr _error = nullptr;
+};
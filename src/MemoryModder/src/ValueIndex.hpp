@@ -0,0 +1,153 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include "Types.hpp"
+#include "MemoryList.hpp"
+
+/// <summary>
+/// <para>The addresses of a memory list by the value they held when the index was built, for many lookups in the same frozen image.</para>
+/// <para>Every address takes 4 bytes for its location, every distinct value <code>sizeof(T)</code> plus the start of its run, so repeated values are cheap.</para>
+/// </summary>
+template<typename T>
+struct ValueIndex {
+private:
+    struct IndexRegion {
+    public:
+        IndexRegion(SizeT const _start, SizeT const _index) {
+            start = _start;
+            index = _index;
+        }
+
+        SizeT start;
+        // Location index of the first address of the region
+        SizeT index;
+    };
+
+public:
+    /// <param name="memoryList">The indexed list, location indices count its addresses.</param>
+    /// <param name="values">The value of every indexed address, sorted by GetSortKey.</param>
+    /// <param name="locations">The location of every value, ascending among equal values.</param>
+    ValueIndex(MemoryList<T> const& memoryList, std::vector<T> const& values, std::vector<UInt32>&& locations) {
+        _stride = memoryList.GetStride();
+
+        SizeT index = 0;
+        for(MemoryRegion<T> const& region : memoryList) {
+            _regions.push_back(IndexRegion(region.GetStart(), index));
+            index += (region.GetSize() + _stride - 1) / _stride;
+        }
+
+        // Runs of equal values share one entry
+        for(SizeT i = 0, s = values.size(); i < s; ++i) {
+            if((i == 0) || (GetSortKey(values[i]) != GetSortKey(values[i - 1]))) {
+                _values.push_back(values[i]);
+                _starts.push_back(i);
+            }
+        }
+        _starts.push_back(values.size());
+        _values.shrink_to_fit();
+        _starts.shrink_to_fit();
+
+        _locations = std::move(locations);
+    }
+
+    /// <returns>The number of indexed addresses.</returns>
+    inline SizeT GetSize() const noexcept {
+        return _locations.size();
+    }
+
+    /// <returns>The number of distinct values.</returns>
+    inline SizeT GetValueCount() const noexcept {
+        return _values.size();
+    }
+
+    /// <returns>The number of bytes used by the index.</returns>
+    inline SizeT GetMemoryUsage() const noexcept {
+        return (_values.capacity() * sizeof(T)) + (_starts.capacity() * sizeof(SizeT)) + (_locations.capacity() * sizeof(UInt32)) + (_regions.capacity() * sizeof(IndexRegion));
+    }
+
+    /// <returns>The addresses whose value was equal to value, compared like Equals.</returns>
+    MemoryList<T> FindEquals(T const value) const {
+        if constexpr(std::is_floating_point_v<T>) {
+            // Equals allows a small difference for floats
+            return FindRange(static_cast<T>(value - static_cast<T>(0.001)), static_cast<T>(value + static_cast<T>(0.001)));
+        }
+        else {
+            return FindRange(value, value);
+        }
+    }
+
+    /// <returns>The addresses whose value was from low to high.</returns>
+    MemoryList<T> FindRange(T const low, T const high) const {
+        UInt64 const lowKey = GetSortKey(low);
+        UInt64 const highKey = GetSortKey(high);
+
+        SizeT const first = static_cast<SizeT>(std::lower_bound(_values.begin(), _values.end(), lowKey, [](T const a, UInt64 const key) {
+            return GetSortKey(a) < key;
+        }) - _values.begin());
+        SizeT const last = static_cast<SizeT>(std::upper_bound(_values.begin(), _values.end(), highKey, [](UInt64 const key, T const a) {
+            return key < GetSortKey(a);
+        }) - _values.begin());
+
+        MemoryList<T> memoryList = MemoryList<T>(_stride);
+        if(first >= last) {
+            return memoryList;
+        }
+
+        // Locations of one value are ascending already, several values are merged by sorting
+        if((last - first) == 1) {
+            for(SizeT i = _starts[first], e = _starts[last]; i < e; ++i) {
+                memoryList.AddAddress(GetAddress(_locations[i]));
+            }
+            return memoryList;
+        }
+
+        std::vector<UInt32> locations = std::vector<UInt32>(_locations.begin() + _starts[first], _locations.begin() + _starts[last]);
+        std::sort(locations.begin(), locations.end());
+        for(UInt32 const location : locations) {
+            memoryList.AddAddress(GetAddress(location));
+        }
+        return memoryList;
+    }
+
+    /// <returns>An unsigned key that sorts like the values, NaNs sort outside of every number.</returns>
+    static inline UInt64 GetSortKey(T const value) noexcept {
+        if constexpr(std::is_same_v<T, Float32>) {
+            UInt32 bits;
+            memcpy(&bits, &value, sizeof(bits));
+            return static_cast<UInt64>(((bits & 0x80000000U) != 0) ? ~bits : (bits | 0x80000000U));
+        }
+        else if constexpr(std::is_same_v<T, Float64>) {
+            UInt64 bits;
+            memcpy(&bits, &value, sizeof(bits));
+            return ((bits & 0x8000000000000000ULL) != 0) ? ~bits : (bits | 0x8000000000000000ULL);
+        }
+        else if constexpr(std::is_signed_v<T>) {
+            // Flipping the sign bit sorts negative values first
+            using Unsigned = std::make_unsigned_t<T>;
+            return static_cast<UInt64>(static_cast<Unsigned>(static_cast<Unsigned>(value) ^ (static_cast<Unsigned>(1) << ((sizeof(T) * 8) - 1))));
+        }
+        else {
+            return static_cast<UInt64>(value);
+        }
+    }
+
+private:
+    inline SizeT GetAddress(SizeT const location) const {
+        typename std::vector<IndexRegion>::const_iterator const it = std::upper_bound(_regions.begin(), _regions.end(), location, [](SizeT const index, IndexRegion const& region) {
+            return index < region.index;
+        }) - 1;
+
+        return it->start + ((location - it->index) * _stride);
+    }
+
+    SizeT _stride = sizeof(T);
+    std::vector<IndexRegion> _regions = std::vector<IndexRegion>();
+    std::vector<T> _values = std::vector<T>();
+    // Run of every value in the locations, with one more for the end of the last run
+    std::vector<SizeT> _starts = std::vector<SizeT>();
+    std::vector<UInt32> _locations = std::vector<UInt32>();
+};
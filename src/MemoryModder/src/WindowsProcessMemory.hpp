@@ -0,0 +1,234 @@
+#pragma once
+
+#if defined(_WIN32)
+
+#include <vector>
+
+#include <Windows.h>
+#include <Psapi.h>
+#include <WtsApi32.h>
+
+#include "Types.hpp"
+#include "DirtyPages.hpp"
+#include "MemoryList.hpp"
+#include "Module.hpp"
+#include "Process.hpp"
+#include "ReadRequest.hpp"
+#include "RegionMap.hpp"
+
+/// <summary>The memory of a Windows process, read and written through a process handle.</summary>
+struct WindowsProcessMemory {
+public:
+    /// <summary>
+    /// <para>Opens the process with this processId.</para>
+    /// <para>Possible exceptions:</para>
+    /// <para>(Int8)1: The process cannot be used.</para>
+    /// <para>(Int8)2: The process has stopped running.</para>
+    /// </summary>
+    WindowsProcessMemory(SizeT const processId) {
+        if(processId == GetCurrentProcessId()) {
+            // Prevent using own process because fetching all memory will allocate forever.
+            throw (Int8)1;
+        }
+
+        HANDLE processHandle = OpenProcess(PROCESS_ALL_ACCESS, TRUE, static_cast<DWORD>(processId));
+
+        // Confirm that the process is still running
+        if(processHandle == NULL) {
+#pragma warning(suppress: 6387)
+            CloseHandle(processHandle);
+            SetLastError(NO_ERROR);
+            throw (Int8)1;
+        }
+
+        DWORD exitCode = (DWORD)0;
+        if(GetExitCodeProcess(processHandle, &exitCode) == FALSE) {
+            CloseHandle(processHandle);
+            SetLastError(NO_ERROR);
+            throw (Int8)2;
+        }
+        if(exitCode != STILL_ACTIVE) {
+            CloseHandle(processHandle);
+            throw (Int8)2;
+        }
+
+        _processId = processId;
+        _processHandle = processHandle;
+
+        // Get process name
+        SizeT const bufSize = 256;
+        char* buf = new char[bufSize];
+        GetModuleBaseNameA(processHandle, NULL, buf, bufSize);
+        _processName = String(buf);
+        delete[] buf;
+
+        _processBaseAddress = static_cast<SizeT>(GetProcessBaseAddress(processHandle));
+    }
+
+    WindowsProcessMemory(WindowsProcessMemory const&) = delete;
+    WindowsProcessMemory& operator=(WindowsProcessMemory const&) = delete;
+
+    ~WindowsProcessMemory() {
+        if(_processHandle != nullptr) {
+            CloseHandle(_processHandle);
+        }
+    }
+
+    // TODO: Don't use WTS to get all processes.
+    static std::vector<Process> GetProcesses() {
+        std::vector<Process> processes = std::vector<Process>();
+
+        WTS_PROCESS_INFOA* pWPIs = NULL;
+        DWORD dwProcCount = 0;
+        if(WTSEnumerateProcessesA(WTS_CURRENT_SERVER_HANDLE, NULL, 1, &pWPIs, &dwProcCount)) {
+            // Go through all processes retrieved
+            for(DWORD i = 0; i < dwProcCount; ++i) {
+                WTS_PROCESS_INFOA& pWPI = pWPIs[i];
+
+                processes.push_back(Process(pWPI.pProcessName, pWPI.ProcessId));
+            }
+        }
+
+        // Free memory
+        if(pWPIs != NULL) {
+            WTSFreeMemory(pWPIs);
+            pWPIs = NULL;
+        }
+
+        return processes;
+    }
+
+    SizeT GetProcessId() const {
+        return _processId;
+    }
+
+    String GetProcessName() const {
+        return _processName;
+    }
+
+    SizeT GetBaseAddress() const {
+        return _processBaseAddress;
+    }
+
+    /// <returns>Every module loaded into the process, the executable first.</returns>
+    std::vector<Module> GetModules() const {
+        std::vector<Module> modules = std::vector<Module>();
+
+        DWORD bytesRequired = 0;
+        if(EnumProcessModules(_processHandle, NULL, 0, &bytesRequired) && (bytesRequired != 0)) {
+            std::vector<HMODULE> handles = std::vector<HMODULE>(bytesRequired / sizeof(HMODULE));
+            if(EnumProcessModules(_processHandle, handles.data(), static_cast<DWORD>(handles.size() * sizeof(HMODULE)), &bytesRequired)) {
+                // Modules loaded in the meantime are left out
+                handles.resize(min(handles.size(), static_cast<SizeT>(bytesRequired / sizeof(HMODULE))));
+
+                for(HMODULE const handle : handles) {
+                    char name[MAX_PATH];
+                    MODULEINFO info;
+                    if((GetModuleBaseNameA(_processHandle, handle, name, MAX_PATH) != 0) && GetModuleInformation(_processHandle, handle, &info, sizeof(info))) {
+                        modules.push_back(Module(String(name), reinterpret_cast<SizeT>(info.lpBaseOfDll), static_cast<SizeT>(info.SizeOfImage)));
+                    }
+                }
+            }
+        }
+
+        SetLastError(NULL);
+
+        return modules;
+    }
+
+    /// <summary>Calls visitor(RegionInfo const& region) for every committed region, ascending.</summary>
+    template<typename Visitor>
+    void ForEachRegion(Visitor&& visitor) const {
+        MEMORY_BASIC_INFORMATION info;
+        for(SizeT p = 0; VirtualQueryEx(_processHandle, (LPCVOID)p, &info, sizeof(info)) == sizeof(info); p += info.RegionSize) {
+            if(info.State == MEM_COMMIT) {
+                visitor(RegionInfo(p, info.RegionSize, info.Protect, info.Type));
+            }
+
+            // The last region ends at the top of the address space
+            if((p + info.RegionSize) <= p) {
+                break;
+            }
+        }
+
+        SetLastError(NULL);
+    }
+
+    /// <summary>Reads are expected to fail while searching, so a failed read does not leave an error behind.</summary>
+    /// <returns>The number of bytes read, or 0 if the read failed.</returns>
+    inline SizeT Read(SizeT const address, SizeT const size, UInt8* data) const {
+        SizeT sizeRead;
+        if(ReadProcessMemory(_processHandle, (LPCVOID)address, (LPVOID)data, size, &sizeRead) == FALSE) {
+            SetLastError(NULL);
+            return 0;
+        }
+        return sizeRead;
+    }
+
+    /// <summary>Reads every request on its own, Windows has no call that reads several ranges at once.</summary>
+    inline void ReadBatch(ReadRequest* requests, SizeT const count) const {
+        for(SizeT i = 0; i < count; ++i) {
+            requests[i].sizeRead = Read(requests[i].address, requests[i].size, requests[i].data);
+        }
+    }
+
+    /// <returns>The number of bytes written, or 0 if the write failed.</returns>
+    inline SizeT Write(SizeT const address, SizeT const size, UInt8 const* data) const {
+        SizeT sizeWritten;
+        if(WriteProcessMemory(_processHandle, (LPVOID)address, (LPCVOID)data, size, &sizeWritten) == FALSE) {
+            SetLastError(NULL);
+            return 0;
+        }
+        return sizeWritten;
+    }
+
+    /// <summary>Windows does not keep track of the pages another process writes.</summary>
+    /// <returns>Always false.</returns>
+    inline Boolean ClearDirtyPages() const noexcept {
+        return false;
+    }
+
+    /// <returns>Always false, see ClearDirtyPages.</returns>
+    template<typename T>
+    inline Boolean ReadDirtyPages(MemoryList<T> const&, SizeT const, DirtyPages& dirtyPages) const {
+        dirtyPages.Clear();
+        return false;
+    }
+
+private:
+    static DWORD_PTR GetProcessBaseAddress(HANDLE processHandle) {
+        DWORD_PTR baseAddress = 0;
+
+        HMODULE* moduleArray;
+        LPBYTE moduleArrayBytes;
+        DWORD bytesRequired;
+
+        if(EnumProcessModules(processHandle, NULL, 0, &bytesRequired)) {
+            if(bytesRequired) {
+                moduleArrayBytes = (LPBYTE)LocalAlloc(LPTR, bytesRequired);
+
+                if(moduleArrayBytes) {
+                    unsigned int moduleCount;
+
+                    moduleCount = bytesRequired / sizeof(HMODULE);
+                    moduleArray = (HMODULE*)moduleArrayBytes;
+
+                    if(EnumProcessModules(processHandle, moduleArray, bytesRequired, &bytesRequired)) {
+                        baseAddress = (DWORD_PTR)moduleArray[0];
+                    }
+
+                    LocalFree(moduleArrayBytes);
+                }
+            }
+        }
+
+        return baseAddress;
+    }
+
+    SizeT _processId;
+    HANDLE _processHandle;
+    String _processName;
+    SizeT _processBaseAddress;
+};
+
+#endif
@@ -0,0 +1,368 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "Types.hpp"
+#include "Platform.hpp"
+#include "Convert.hpp"
+#include "MemoryModder.hpp"
+#include "SyntheticProcess.hpp"
+
+// Every read of the target is a process_vm_readv call, defining it here counts the read syscalls of the library
+static std::atomic<UInt64> readCalls = 0;
+
+extern "C" ssize_t process_vm_readv(pid_t const processId, iovec const* local, unsigned long const localCount, iovec const* remote, unsigned long const remoteCount, unsigned long const flags) noexcept {
+    readCalls.fetch_add(1, std::memory_order_relaxed);
+    return static_cast<ssize_t>(syscall(SYS_process_vm_readv, processId, local, localCount, remote, remoteCount, flags));
+}
+
+static constexpr char const* ChildArgument = "--child";
+static constexpr UInt32 ResultVersion = 1;
+
+struct BenchmarkOptions {
+public:
+    SyntheticLayout layout = SyntheticLayout();
+    /// <summary>Filter steps after the scan of all memory.</summary>
+    SizeT steps = 8;
+    /// <summary>Runs of every step on the same list, for the latency percentiles.</summary>
+    SizeT repeat = 5;
+    Boolean aligned = true;
+    /// <summary>File the JSON results are written to, "-" writes them to the standard output.</summary>
+    String output = "-";
+};
+
+/// <summary>The measurements of one step, every run of it filters the same list.</summary>
+struct StepResult {
+public:
+    StepResult(String const& _name, Int32 const _value) {
+        name = _name;
+        value = _value;
+    }
+
+    String name;
+    Int32 value;
+
+    SizeT candidatesBefore = 0;
+    SizeT candidatesAfter = 0;
+    SizeT plantedFound = 0;
+    SizeT plantedExpected = 0;
+    // Bytes of memory scanned, or of candidate values compared, by one run
+    SizeT bytes = 0;
+    UInt64 syscalls = 0;
+    std::vector<Float64> latencies = std::vector<Float64>();
+    SizeT peakRss = 0;
+};
+
+void WriteUsage() {
+    fprintf(stderr,
+        "Usage: MemoryModderBenchmark [options]\n"
+        "Scans a synthetic child process and writes the results as JSON.\n"
+        "  --memory <MiB>          Readable memory of the child (256)\n"
+        "  --regions <count>       Regions the memory is split into (64)\n"
+        "  --fragmentation <0..1>  Share of the pages of a region followed by a hole (0)\n"
+        "  --planted <count>       Planted values found by the scan (1000)\n"
+        "  --steps <count>         Filter steps after the scan, every step halves the planted values (8)\n"
+        "  --repeat <count>        Runs of every step for the latency percentiles (5)\n"
+        "  --unaligned             Search every byte instead of every 4th\n"
+        "  --seed <number>         Seed of the fill and the planted positions (1)\n"
+        "  --output <file>         File the results are written to, - for the standard output (-)\n");
+}
+
+/// <summary>
+/// <para>Possible exceptions:</para>
+/// <para>(Int8)1: An option is unknown or its value is invalid.</para>
+/// </summary>
+BenchmarkOptions ParseOptions(int const argumentCount, char** arguments) {
+    BenchmarkOptions options = BenchmarkOptions();
+
+    for(int i = 1; i < argumentCount; ++i) {
+        String const option = arguments[i];
+        if(option == "--unaligned") {
+            options.aligned = false;
+            continue;
+        }
+
+        if((i + 1) >= argumentCount) {
+            throw (Int8)1;
+        }
+        String const value = arguments[++i];
+
+        if(option == "--memory") { options.layout.memorySize = FromString<SizeT>(value) * 0x100000; }
+        else if(option == "--regions") { options.layout.regionCount = FromString<SizeT>(value); }
+        else if(option == "--fragmentation") { options.layout.fragmentation = FromString<Float64>(value); }
+        else if(option == "--planted") { options.layout.plantedCount = FromString<SizeT>(value); }
+        else if(option == "--steps") { options.steps = FromString<SizeT>(value); }
+        else if(option == "--repeat") { options.repeat = FromString<SizeT>(value); }
+        else if(option == "--seed") { options.layout.seed = FromString<UInt64>(value); }
+        else if(option == "--output") { options.output = value; }
+        else {
+            throw (Int8)1;
+        }
+    }
+
+    if((options.layout.memorySize == 0) || (options.layout.regionCount == 0) || (options.repeat == 0) || (options.steps > SyntheticProcess::MaxSteps)
+        || (options.layout.fragmentation < 0.0) || (options.layout.fragmentation > 1.0)) {
+        throw (Int8)1;
+    }
+
+    return options;
+}
+
+/// <summary>Resets the peak resident set size of this process, so the next GetPeakRss only covers what comes after.</summary>
+void ResetPeakRss() {
+    std::ofstream file = std::ofstream("/proc/self/clear_refs");
+    file << "5";
+}
+
+/// <returns>The peak resident set size of this process in bytes.</returns>
+SizeT GetPeakRss() {
+    std::ifstream file = std::ifstream("/proc/self/status");
+    String line = String();
+    while(std::getline(file, line)) {
+        if(line.rfind("VmHWM:", 0) == 0) {
+            return static_cast<SizeT>(strtoull(line.c_str() + 6, nullptr, 10)) * 1024;
+        }
+    }
+    return 0;
+}
+
+/// <returns>The number of addresses of the list inside the area of the synthetic process.</returns>
+SizeT CountInside(MemoryList<Int32> const& list, SizeT const start, SizeT const size) {
+    SizeT count = 0;
+    for(MemoryRegion<Int32> const& region : list) {
+        SizeT const regionStart = max(region.GetStart(), start);
+        SizeT const regionEnd = min(region.GetEnd(), start + size);
+        if(regionStart < regionEnd) {
+            count += (regionEnd - regionStart + list.GetStride() - 1) / list.GetStride();
+        }
+    }
+    return count;
+}
+
+/// <summary>
+/// <para>Runs filter options.repeat times and records the latency, read syscalls and peak RSS of every run into result.</para>
+/// <para>filter: MemoryList&lt;Int32&gt;(), the list of the step.</para>
+/// </summary>
+template<typename Filter>
+MemoryList<Int32> MeasureStep(BenchmarkOptions const& options, SyntheticProcess const& process, StepResult& result, Filter&& filter) {
+    MemoryList<Int32> list = MemoryList<Int32>(options.aligned ? sizeof(Int32) : 1);
+
+    UInt64 const calls = readCalls.load();
+    for(SizeT run = 0; run < options.repeat; ++run) {
+        ResetPeakRss();
+
+        std::chrono::steady_clock::time_point const start = std::chrono::steady_clock::now();
+        list = filter();
+        std::chrono::steady_clock::time_point const end = std::chrono::steady_clock::now();
+
+        result.latencies.push_back(std::chrono::duration<Float64>(end - start).count());
+        result.peakRss = max(result.peakRss, GetPeakRss());
+    }
+    result.syscalls = (readCalls.load() - calls) / options.repeat;
+
+    result.candidatesAfter = list.GetSize();
+    result.plantedFound = CountInside(list, process.GetAreaStart(), process.GetAreaSize());
+    return list;
+}
+
+/// <returns>The sample at percentile of the sorted samples, by nearest rank.</returns>
+Float64 GetPercentile(std::vector<Float64> const& sorted, Float64 const percentile) {
+    SizeT const rank = static_cast<SizeT>(std::ceil((percentile / 100.0) * static_cast<Float64>(sorted.size())));
+    return sorted[min(max(rank, static_cast<SizeT>(1)), sorted.size()) - 1];
+}
+
+String FormatNumber(Float64 const value) {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.6f", value);
+    return String(buffer);
+}
+
+String FormatStep(StepResult const& result) {
+    std::vector<Float64> sorted = result.latencies;
+    std::sort(sorted.begin(), sorted.end());
+
+    Float64 mean = 0.0;
+    for(Float64 const latency : sorted) {
+        mean += latency;
+    }
+    mean /= static_cast<Float64>(sorted.size());
+
+    Float64 const median = GetPercentile(sorted, 50.0);
+    Float64 const gigabytesPerSecond = (median > 0.0) ? (static_cast<Float64>(result.bytes) / median / 1e9) : 0.0;
+
+    String json = String();
+    json += "    {\n";
+    json += "      \"name\": \"" + result.name + "\",\n";
+    json += "      \"value\": " + std::to_string(result.value) + ",\n";
+    json += "      \"candidatesBefore\": " + std::to_string(result.candidatesBefore) + ",\n";
+    json += "      \"candidatesAfter\": " + std::to_string(result.candidatesAfter) + ",\n";
+    json += "      \"plantedFound\": " + std::to_string(result.plantedFound) + ",\n";
+    json += "      \"plantedExpected\": " + std::to_string(result.plantedExpected) + ",\n";
+    json += "      \"bytes\": " + std::to_string(result.bytes) + ",\n";
+    json += "      \"gigabytesPerSecond\": " + FormatNumber(gigabytesPerSecond) + ",\n";
+    json += "      \"syscalls\": " + std::to_string(result.syscalls) + ",\n";
+    json += "      \"latencyMilliseconds\": {";
+    json += "\"min\": " + FormatNumber(sorted.front() * 1e3);
+    json += ", \"p50\": " + FormatNumber(median * 1e3);
+    json += ", \"p90\": " + FormatNumber(GetPercentile(sorted, 90.0) * 1e3);
+    json += ", \"p99\": " + FormatNumber(GetPercentile(sorted, 99.0) * 1e3);
+    json += ", \"max\": " + FormatNumber(sorted.back() * 1e3);
+    json += ", \"mean\": " + FormatNumber(mean * 1e3) + "},\n";
+    json += "      \"peakRssBytes\": " + std::to_string(result.peakRss) + "\n";
+    json += "    }";
+
+    fprintf(stderr, "%-8s %10zu -> %-10zu p50 %10.3f ms %8.3f GB/s %8llu syscalls\n", result.name.c_str(), result.candidatesBefore, result.candidatesAfter,
+        median * 1e3, gigabytesPerSecond, static_cast<unsigned long long>(result.syscalls));
+
+    return json;
+}
+
+/// <summary>
+/// <para>Scans the synthetic process for the planted value, then filters the list once for every step, and writes the results.</para>
+/// <para>Possible exceptions:</para>
+/// <para>(Int8)1: The synthetic process cannot be started or read, or the results cannot be written.</para>
+/// <para>(Int8)2: The synthetic process stopped running.</para>
+/// </summary>
+/// <returns>True if every step found exactly the planted values it should.</returns>
+Boolean RunBenchmark(BenchmarkOptions const& options) {
+    SyntheticProcess process = SyntheticProcess(options.layout, "/proc/self/exe", ChildArgument);
+
+    MemoryModder modder = MemoryModder(process.GetProcessId());
+    // Every scan reads the regions again, like the first scan of a process
+    modder.SetRegionMaxAge(std::chrono::milliseconds(0));
+
+    std::chrono::steady_clock::time_point const start = std::chrono::steady_clock::now();
+    std::vector<StepResult> results = std::vector<StepResult>();
+
+    // The scan creates the list of all memory and filters it
+    StepResult scan = StepResult("scan", SyntheticProcess::GetPlantedValue(0));
+    scan.plantedExpected = SyntheticProcess::GetPlantedCount(options.layout, 0);
+    MemoryList<Int32> list = MeasureStep(options, process, scan, [&modder, &options, &scan]() {
+        MemoryList<Int32> const all = modder.CreateList<Int32>(options.aligned);
+        scan.candidatesBefore = all.GetSize();
+        scan.bytes = all.GetSize() * all.GetStride();
+        return modder.FilterList<Int32, MemoryComparison::Equals>(all, SyntheticProcess::GetPlantedValue(0));
+    });
+    results.push_back(scan);
+
+    for(SizeT step = 1; step <= options.steps; ++step) {
+        process.Step(step);
+
+        StepResult result = StepResult("filter" + std::to_string(step), SyntheticProcess::GetPlantedValue(step));
+        result.plantedExpected = SyntheticProcess::GetPlantedCount(options.layout, step);
+        result.candidatesBefore = list.GetSize();
+        result.bytes = list.GetSize() * sizeof(Int32);
+
+        MemoryList<Int32> const previous = list;
+        list = MeasureStep(options, process, result, [&modder, &previous, step]() {
+            return modder.FilterList<Int32, MemoryComparison::Equals>(previous, SyntheticProcess::GetPlantedValue(step));
+        });
+        results.push_back(result);
+    }
+
+    Float64 const seconds = std::chrono::duration<Float64>(std::chrono::steady_clock::now() - start).count();
+
+    Boolean correct = true;
+    UInt64 syscalls = 0;
+    SizeT peakRss = 0;
+    for(StepResult const& result : results) {
+        correct = correct && (result.plantedFound == result.plantedExpected);
+        syscalls += result.syscalls * options.repeat;
+        peakRss = max(peakRss, result.peakRss);
+    }
+
+    String json = String();
+    json += "{\n";
+    json += "  \"benchmark\": \"MemoryModderBenchmark\",\n";
+    json += "  \"version\": " + std::to_string(ResultVersion) + ",\n";
+    json += "  \"config\": {\n";
+    json += "    \"memoryBytes\": " + std::to_string(options.layout.memorySize) + ",\n";
+    json += "    \"regions\": " + std::to_string(options.layout.regionCount) + ",\n";
+    json += "    \"fragmentation\": " + FormatNumber(options.layout.fragmentation) + ",\n";
+    json += "    \"planted\": " + std::to_string(options.layout.plantedCount) + ",\n";
+    json += "    \"steps\": " + std::to_string(options.steps) + ",\n";
+    json += "    \"repeat\": " + std::to_string(options.repeat) + ",\n";
+    json += "    \"aligned\": " + String(options.aligned ? "true" : "false") + ",\n";
+    json += "    \"seed\": " + std::to_string(options.layout.seed) + ",\n";
+    json += "    \"type\": \"" + String(GetTypeName<Int32>()) + "\"\n";
+    json += "  },\n";
+    json += "  \"system\": {\n";
+    json += "    \"hardwareThreads\": " + std::to_string(std::thread::hardware_concurrency()) + ",\n";
+    json += "    \"workers\": " + std::to_string(modder.GetWorkerCount()) + ",\n";
+    json += "    \"pageSize\": " + std::to_string(sysconf(_SC_PAGESIZE)) + "\n";
+    json += "  },\n";
+    json += "  \"target\": {\n";
+    json += "    \"processId\": " + std::to_string(process.GetProcessId()) + ",\n";
+    json += "    \"mappings\": " + std::to_string(process.GetMappingCount()) + ",\n";
+    json += "    \"areaBytes\": " + std::to_string(process.GetAreaSize()) + "\n";
+    json += "  },\n";
+    json += "  \"steps\": [\n";
+    for(SizeT i = 0; i < results.size(); ++i) {
+        json += FormatStep(results[i]) + (((i + 1) < results.size()) ? ",\n" : "\n");
+    }
+    json += "  ],\n";
+    json += "  \"total\": {\n";
+    json += "    \"seconds\": " + FormatNumber(seconds) + ",\n";
+    json += "    \"syscalls\": " + std::to_string(syscalls) + ",\n";
+    json += "    \"peakRssBytes\": " + std::to_string(peakRss) + ",\n";
+    json += "    \"correct\": " + String(correct ? "true" : "false") + "\n";
+    json += "  }\n";
+    json += "}\n";
+
+    if(options.output == "-") {
+        fwrite(json.data(), 1, json.size(), stdout);
+    }
+    else {
+        std::ofstream file = std::ofstream(options.output, std::ios_base::binary | std::ios_base::trunc);
+        file.write(json.data(), static_cast<std::streamsize>(json.size()));
+        file.close();
+        if(!file) {
+            throw (Int8)1;
+        }
+    }
+
+    return correct;
+}
+
+/// <returns>0 if every step found what it should, 1 if the benchmark failed to run, 2 if a step found the wrong addresses.</returns>
+int main(int argc, char** argv) {
+    if((argc > 1) && (String(argv[1]) == ChildArgument)) {
+        return SyntheticProcess::RunChild(argc, argv);
+    }
+
+    BenchmarkOptions options = BenchmarkOptions();
+    try {
+        options = ParseOptions(argc, argv);
+    }
+    catch(Int8) {
+        WriteUsage();
+        return 1;
+    }
+
+    try {
+        if(!RunBenchmark(options)) {
+            fprintf(stderr, "A step did not find the planted values it should have.\n");
+            return 2;
+        }
+    }
+    catch(Int8 e) {
+        if(e == 2) {
+            fprintf(stderr, "The synthetic process stopped running.\n");
+        }
+        else {
+            fprintf(stderr, "Failed to start or read the synthetic process, or to write the results.\n");
+        }
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,295 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "Types.hpp"
+#include "Platform.hpp"
+
+/// <summary>The memory of a synthetic target process, see SyntheticProcess.</summary>
+struct SyntheticLayout {
+public:
+    /// <summary>Readable bytes in total, split evenly over the regions.</summary>
+    SizeT memorySize = 256 * 0x100000;
+    SizeT regionCount = 64;
+    /// <summary>From 0, every region is one mapping, to 1, every page of a region is a mapping of its own with a hole after it.</summary>
+    Float64 fragmentation = 0.0;
+    /// <summary>Number of aligned Int32 slots holding PlantedValue, never two next to each other.</summary>
+    SizeT plantedCount = 1000;
+    UInt64 seed = 1;
+};
+
+/// <summary>
+/// <para>A child process with memory laid out as a SyntheticLayout, filled with values a search never finds apart from the planted ones.</para>
+/// <para>Every byte of the fill is below 0x40 and every byte of a planted value is 0x40 or above, so even unaligned searches only find the planted values.</para>
+/// <para>Step s keeps the value of the first plantedCount &gt;&gt; s planted slots at GetPlantedValue(s) and clears the others.</para>
+/// </summary>
+struct SyntheticProcess {
+public:
+    static constexpr Int32 PlantedValue = 0x7F7F7F7F;
+    /// <summary>Steps past this would let the low byte of the planted value wrap below 0x40.</summary>
+    static constexpr SizeT MaxSteps = 0x40;
+
+    static inline Int32 GetPlantedValue(SizeT const step) noexcept {
+        return PlantedValue + static_cast<Int32>(step);
+    }
+
+    /// <returns>The number of planted slots that hold GetPlantedValue(step) after step.</returns>
+    static inline SizeT GetPlantedCount(SyntheticLayout const& layout, SizeT const step) noexcept {
+        return (step < 64) ? (layout.plantedCount >> step) : 0;
+    }
+
+    /// <summary>
+    /// <para>Starts executable with childArgument and the layout, so the child only holds its own memory and not a copy of the parent.</para>
+    /// <para>Possible exceptions:</para>
+    /// <para>(Int8)1: The process cannot be started or did not lay out its memory.</para>
+    /// </summary>
+    SyntheticProcess(SyntheticLayout const& layout, String const& executable, String const& childArgument) {
+        int toChild[2];
+        int toParent[2];
+        if(pipe(toChild) != 0) {
+            throw (Int8)1;
+        }
+        if(pipe(toParent) != 0) {
+            close(toChild[0]);
+            close(toChild[1]);
+            throw (Int8)1;
+        }
+
+        std::vector<String> arguments = std::vector<String>();
+        arguments.push_back(executable);
+        arguments.push_back(childArgument);
+        arguments.push_back(std::to_string(layout.memorySize));
+        arguments.push_back(std::to_string(layout.regionCount));
+        arguments.push_back(std::to_string(layout.fragmentation));
+        arguments.push_back(std::to_string(layout.plantedCount));
+        arguments.push_back(std::to_string(layout.seed));
+
+        _processId = fork();
+        if(_processId == 0) {
+            // The child talks through its standard input and output
+            dup2(toChild[0], STDIN_FILENO);
+            dup2(toParent[1], STDOUT_FILENO);
+            close(toChild[0]);
+            close(toChild[1]);
+            close(toParent[0]);
+            close(toParent[1]);
+
+            std::vector<char*> argv = std::vector<char*>();
+            for(String& argument : arguments) {
+                argv.push_back(argument.data());
+            }
+            argv.push_back(nullptr);
+            execv(executable.c_str(), argv.data());
+            _exit(1);
+        }
+
+        close(toChild[0]);
+        close(toParent[1]);
+        _input = toChild[1];
+        _output = toParent[0];
+
+        if((_processId < 0) || !ReadValue(_areaStart) || !ReadValue(_areaSize) || !ReadValue(_mappingCount)) {
+            Stop();
+            throw (Int8)1;
+        }
+    }
+
+    SyntheticProcess(SyntheticProcess const&) = delete;
+    SyntheticProcess& operator=(SyntheticProcess const&) = delete;
+
+    ~SyntheticProcess() {
+        Stop();
+    }
+
+    inline SizeT GetProcessId() const noexcept {
+        return static_cast<SizeT>(_processId);
+    }
+
+    /// <returns>The address of the reserved range holding every region and hole.</returns>
+    inline SizeT GetAreaStart() const noexcept {
+        return _areaStart;
+    }
+
+    inline SizeT GetAreaSize() const noexcept {
+        return _areaSize;
+    }
+
+    /// <returns>The number of readable mappings, fewer than asked for if the mapping limit of the system is lower.</returns>
+    inline SizeT GetMappingCount() const noexcept {
+        return _mappingCount;
+    }
+
+    /// <summary>
+    /// <para>Changes the planted values for step and waits until the child did.</para>
+    /// <para>Possible exceptions:</para>
+    /// <para>(Int8)2: The process has stopped running.</para>
+    /// </summary>
+    void Step(SizeT const step) {
+        UInt64 const command = static_cast<UInt64>(step);
+        UInt64 reply = 0;
+        if((write(_input, &command, sizeof(command)) != sizeof(command)) || !ReadValue(reply) || (reply != command)) {
+            throw (Int8)2;
+        }
+    }
+
+    /// <summary>
+    /// <para>Lays out the memory of the child process from the arguments after childArgument, reports where it is and answers steps until its input closes.</para>
+    /// </summary>
+    /// <returns>The exit code of the child.</returns>
+    static int RunChild(int const argumentCount, char** arguments) {
+        if(argumentCount < 7) {
+            return 1;
+        }
+
+        SyntheticLayout layout = SyntheticLayout();
+        layout.memorySize = static_cast<SizeT>(strtoull(arguments[2], nullptr, 10));
+        layout.regionCount = max(static_cast<SizeT>(strtoull(arguments[3], nullptr, 10)), static_cast<SizeT>(1));
+        layout.fragmentation = strtod(arguments[4], nullptr);
+        layout.plantedCount = static_cast<SizeT>(strtoull(arguments[5], nullptr, 10));
+        layout.seed = static_cast<UInt64>(strtoull(arguments[6], nullptr, 10));
+
+        SizeT const pageSize = static_cast<SizeT>(sysconf(_SC_PAGESIZE));
+        SizeT const regionPages = max(layout.memorySize / pageSize / layout.regionCount, static_cast<SizeT>(1));
+
+        // Every readable run and every hole is a mapping of its own, and the system only allows so many
+        SizeT holes = static_cast<SizeT>(min(max(layout.fragmentation, 0.0), 1.0) * static_cast<Float64>(regionPages - 1));
+        SizeT const maxRuns = max(GetMaxMappingCount() / 2 / layout.regionCount, static_cast<SizeT>(1));
+        holes = min(holes, maxRuns - 1);
+
+        // Regions keep a hole between each other, so they never merge into one mapping
+        SizeT const areaPages = layout.regionCount * (regionPages + holes + 1);
+        UInt8* area = static_cast<UInt8*>(mmap(nullptr, areaPages * pageSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0));
+        if(area == MAP_FAILED) {
+            return 1;
+        }
+
+        std::vector<std::pair<UInt8*, SizeT>> runs = std::vector<std::pair<UInt8*, SizeT>>();
+        UInt64 random = layout.seed;
+        UInt8* position = area;
+        for(SizeT region = 0; region < layout.regionCount; ++region) {
+            for(SizeT run = 0, page = 0; run <= holes; ++run) {
+                // Holes are spread evenly over the region
+                SizeT const runEnd = ((run + 1) * regionPages) / (holes + 1);
+                SizeT const runSize = (runEnd - page) * pageSize;
+                page = runEnd;
+
+                if((runSize != 0) && (mprotect(position, runSize, PROT_READ | PROT_WRITE) == 0)) {
+                    for(SizeT i = 0; i < (runSize / sizeof(UInt64)); ++i) {
+                        reinterpret_cast<UInt64*>(position)[i] = Next(random) & 0x3F3F3F3F3F3F3F3F;
+                    }
+                    runs.push_back(std::pair<UInt8*, SizeT>(position, runSize));
+                }
+                position += runSize + pageSize;
+            }
+        }
+
+        // Every planted slot is in its own share of all slots, one slot short of the next share
+        SizeT slotCount = 0;
+        for(std::pair<UInt8*, SizeT> const& run : runs) {
+            slotCount += run.second / sizeof(Int32);
+        }
+        SizeT const share = (layout.plantedCount != 0) ? (slotCount / layout.plantedCount) : 0;
+        if((layout.plantedCount != 0) && (share < 2)) {
+            return 1;
+        }
+
+        std::vector<Int32*> planted = std::vector<Int32*>();
+        for(SizeT i = 0, run = 0, runSlot = 0; i < layout.plantedCount; ++i) {
+            SizeT slot = (i * share) + static_cast<SizeT>(Next(random) % (share - 1));
+            for(; slot >= (runSlot + (runs[run].second / sizeof(Int32))); ++run) {
+                runSlot += runs[run].second / sizeof(Int32);
+            }
+            Int32* value = reinterpret_cast<Int32*>(runs[run].first) + (slot - runSlot);
+            *value = PlantedValue;
+            planted.push_back(value);
+        }
+
+        UInt64 const areaStart = reinterpret_cast<UInt64>(area);
+        UInt64 const areaSize = static_cast<UInt64>(areaPages * pageSize);
+        UInt64 const mappingCount = static_cast<UInt64>(runs.size());
+        if(!WriteValue(areaStart) || !WriteValue(areaSize) || !WriteValue(mappingCount)) {
+            return 1;
+        }
+
+        UInt64 step = 0;
+        while(read(STDIN_FILENO, &step, sizeof(step)) == sizeof(step)) {
+            SizeT const keep = GetPlantedCount(layout, static_cast<SizeT>(step));
+            for(SizeT i = 0; i < planted.size(); ++i) {
+                *planted[i] = (i < keep) ? GetPlantedValue(static_cast<SizeT>(step)) : 0;
+            }
+
+            if(!WriteValue(step)) {
+                return 1;
+            }
+        }
+
+        return 0;
+    }
+
+private:
+    /// <summary>Closes the input of the child, which makes it exit, and waits for it.</summary>
+    void Stop() {
+        if(_input >= 0) {
+            close(_input);
+            _input = -1;
+        }
+        if(_output >= 0) {
+            close(_output);
+            _output = -1;
+        }
+        if(_processId > 0) {
+            int status = 0;
+            waitpid(_processId, &status, 0);
+            _processId = -1;
+        }
+    }
+
+    template<typename V>
+    inline Boolean ReadValue(V& value) const {
+        return read(_output, &value, sizeof(V)) == static_cast<ssize_t>(sizeof(V));
+    }
+
+    template<typename V>
+    static inline Boolean WriteValue(V const value) {
+        return write(STDOUT_FILENO, &value, sizeof(V)) == static_cast<ssize_t>(sizeof(V));
+    }
+
+    /// <summary>splitmix64, so a seed gives the same layout everywhere.</summary>
+    static inline UInt64 Next(UInt64& state) noexcept {
+        UInt64 value = (state += 0x9E3779B97F4A7C15);
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EB;
+        return value ^ (value >> 31);
+    }
+
+    /// <returns>The most mappings the system allows a process, with room left for the mappings of the process itself.</returns>
+    static SizeT GetMaxMappingCount() {
+        SizeT count = 65530;
+        FILE* file = fopen("/proc/sys/vm/max_map_count", "r");
+        if(file != nullptr) {
+            unsigned long long value = 0;
+            if(fscanf(file, "%llu", &value) == 1) {
+                count = static_cast<SizeT>(value);
+            }
+            fclose(file);
+        }
+        return (count > 0x1000) ? (count - 0x1000) : (count / 2);
+    }
+
+    pid_t _processId = -1;
+    int _input = -1;
+    int _output = -1;
+
+    SizeT _areaStart = 0;
+    SizeT _areaSize = 0;
+    SizeT _mappingCount = 0;
+};